@@ -1,107 +1,444 @@
 #include "directed_graph.h"
-#include <queue>
+#include "../batch_reachability.h"
+#include "../bidirectional_bfs.h"
+#include "../delta_stepping.h"
+#include "../dijkstra.h"
+#include "../dfs_engine.h"
+#include "../parallel_bfs.h"
+#include <algorithm>
 
 namespace directed_graph {
 
-DirectedGraph::DirectedGraph(const std::vector<Node>& vertices) {
+DirectedGraph::DirectedGraph(const std::vector<Node>& vertices) : negative_weights_(0), frozen_(false), reachability_indexed_(false) {
     V_ = E_ = 0;
     for (const Node& vertex : vertices) {
         AddVertex(vertex);
     }
 }
 
-DirectedGraph::DirectedGraph(const std::vector<Edge>& edges) {
+DirectedGraph::DirectedGraph(const std::vector<Edge>& edges) : negative_weights_(0), frozen_(false), reachability_indexed_(false) {
     V_ = E_ = 0;
     for (const auto& edge : edges) {
         AddEdge(edge);
     }
 }
 
+DirectedGraph::DirectedGraph(const DirectedGraph& base, const std::vector<Node>& vertices, const std::vector<Edge>& edges)
+    : index_(base.index_), edge_list_(base.edge_list_), edge_weights_(base.edge_weights_),
+      negative_weights_(base.negative_weights_), frozen_(false), reachability_indexed_(false), snapshot_(base.snapshot_) {
+    V_ = base.V_;
+    E_ = base.E_;
+    if (snapshot_ != nullptr) {
+        forward_ = base.forward_;
+        reverse_ = base.reverse_;
+        frozen_ = true;
+    }
+    for (const auto& vertex : vertices) {
+        AddVertex(vertex);
+    }
+    for (const auto& edge : edges) {
+        AddEdge(edge);
+    }
+}
+
 bool DirectedGraph::AddVertex(const Node& node) {
-    if (!vertices_.insert({node.Id(), node}).second) {
+    if (RefuseMutation()) return false;
+    const uint32_t vertex_count = index_.size();
+    index_.Intern(node.Id());
+    if (index_.size() == vertex_count) {
         std::cout << "Node with id " << node.Id() << " already exists" << std::endl;
         return false;
     }
     V_++;
+    frozen_ = false;
+    reachability_indexed_ = false;
     return true;
 }
 
-void DirectedGraph::AddEdge(const Edge& edge) {
-    if (vertices_.find(edge.from()) == vertices_.end()) {
-        vertices_[edge.from()] = Node(edge.from());
-        V_++;
+bool DirectedGraph::AddEdge(const Edge& edge) {
+    if (RefuseMutation()) return false;
+    const uint32_t from = index_.Intern(edge.from());
+    const uint32_t to = index_.Intern(edge.to());
+    V_ = index_.size();
+    edge_list_.push_back({from, to});
+    edge_weights_.push_back(edge.weight());
+    negative_weights_ += edge.weight() < 0;
+    E_++;
+    frozen_ = false;
+    reachability_indexed_ = false;
+    return true;
+}
+
+bool DirectedGraph::LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats) {
+    if (RefuseMutation()) return false;
+    const size_t edge_count = edge_list_.size();
+    if (!::LoadEdgeList(path, chunk_bytes, pool, &index_, &edge_list_, &edge_weights_, stats)) return false;
+    for (size_t i = edge_count; i < edge_list_.size(); i++) {
+        negative_weights_ += edge_weights_[i] < 0;
     }
-    if (vertices_.find(edge.to()) == vertices_.end()) {
-        vertices_[edge.to()] = Node(edge.to());
-        V_++;
+    V_ = index_.size();
+    E_ = edge_list_.size();
+    frozen_ = false;
+    reachability_indexed_ = false;
+    EnsureFrozen();
+    return true;
+}
+
+bool DirectedGraph::LoadEdgeList(const std::string& path, int num_threads) {
+    ThreadPool pool(num_threads);
+    return LoadEdgeList(path, kEdgeListChunkBytes, &pool, nullptr);
+}
+
+void DirectedGraph::Freeze() {
+    EnsureFrozen();
+}
+
+bool DirectedGraph::Reorder(VertexOrder order) {
+    if (RefuseMutation()) return false;
+    EnsureFrozen();
+    std::vector<uint32_t> new_order;
+    OrderVertices(order, forward_, &reverse_, &new_order);
+    RenumberVertices(new_order, &index_, &edge_list_);
+    frozen_ = false;
+    reachability_indexed_ = false;
+    // The marks of the last traversal are stamped under the old ids.
+    context_.Reset(V_);
+    target_context_.Reset(V_);
+    return true;
+}
+
+void DirectedGraph::EnsureFrozen() const {
+    if (frozen_.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(freeze_mutex_);
+    if (frozen_.load(std::memory_order_relaxed)) return;
+    forward_.Build(index_.size(), edge_list_, &edge_weights_, AdjacencyDirection::kOut);
+    reverse_.Build(index_.size(), edge_list_, AdjacencyDirection::kIn);
+    frozen_.store(true, std::memory_order_release);
+}
+
+bool DirectedGraph::RefuseMutation() const {
+    if (snapshot_ == nullptr) return false;
+    std::cout << "Graph loaded with LoadMapped is read-only" << std::endl;
+    return true;
+}
+
+bool DirectedGraph::Save(const std::string& path) {
+    EnsureFrozen();
+    return WriteSnapshot(path, index_, forward_, &reverse_, E_, negative_weights_);
+}
+
+bool DirectedGraph::LoadMapped(const std::string& path) {
+    if (V_ > 0) {
+        std::cout << "LoadMapped needs an empty graph" << std::endl;
+        return false;
     }
-    adjacency_map_[edge.from()].push_back(edge.to());
-    edges_[edge.from()].insert({edge.to(), edge});
-    E_++;
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    SnapshotHeader header;
+    if (!MapSnapshot(path, true, file.get(), &header, &index_, &forward_, &reverse_)) return false;
+    snapshot_ = file;
+    V_ = header.num_vertices;
+    E_ = header.num_edges;
+    negative_weights_ = header.negative_weights;
+    frozen_ = true;
+    return true;
+}
+
+int DirectedGraph::InDegree(const std::string& node_id) const {
+    const uint32_t node = index_.Find(node_id);
+    if (node == kNoVertex) return 0;
+    EnsureFrozen();
+    return reverse_.Degree(node);
 }
 
-void DirectedGraph::DFSUtil(const std::string& node_id) {
-    if (visited_.find(node_id) != visited_.end()) return;
-    visited_.insert(node_id);
-    for (const auto& neighbor_id : adjacency_map_[node_id]) {
-      if (visited_.find(neighbor_id) != visited_.end()) continue;
-      path_to_[neighbor_id] = node_id;
-      DFSUtil(neighbor_id);
+std::vector<std::string> DirectedGraph::InNeighbors(const std::string& node_id) const {
+    std::vector<std::string> neighbors;
+    const uint32_t node = index_.Find(node_id);
+    if (node == kNoVertex) return neighbors;
+    EnsureFrozen();
+    for (const uint32_t* neighbor = reverse_.begin(node); neighbor != reverse_.end(node); neighbor++) {
+        neighbors.push_back(index_.Id(*neighbor));
     }
+    return neighbors;
+}
+
+uint32_t DirectedGraph::StartTraversal(const std::string& node_id, TraversalContext* context) const {
+    EnsureFrozen();
+    context->Reset(V_);
+    return index_.Find(node_id);
 }
 
 void DirectedGraph::DFS(const std::string& node_id) {
-    visited_.clear();
-    path_to_.clear();
-    path_to_[node_id] = node_id;
-    DFSUtil(node_id);
+    DFS(node_id, &context_);
+}
+
+void DirectedGraph::DFS(const std::string& node_id, TraversalContext* context) const {
+    const uint32_t node = StartTraversal(node_id, context);
+    if (node == kNoVertex) return;
+    DepthFirstSearch(forward_, node, context, dfs::Continue(), dfs::Continue(), dfs::Continue());
+}
+
+void DirectedGraph::DFS(const std::string& node_id, PathTree* tree) {
+    DFS(node_id, &context_, tree);
+}
+
+void DirectedGraph::DFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const {
+    const uint32_t node = StartTraversal(node_id, context);
+    if (node == kNoVertex) {
+        tree->Clear();
+        return;
+    }
+    tree->Reset(V_, node);
+    const auto reach = [&](uint32_t visited_node, uint32_t parent) {
+        if (visited_node != parent) {
+            tree->Reach(visited_node, tree->distance(parent) + 1, parent);
+        }
+        return true;
+    };
+    DepthFirstSearch(forward_, node, context, reach, dfs::Continue(), dfs::Continue());
 }
 
 void DirectedGraph::BFS(const std::string& node_id) {
-    visited_.clear();
-    path_to_.clear();
-
-    std::queue<std::string> nodes_queue;
-    nodes_queue.push(node_id);
-    visited_.insert(node_id);
-    path_to_[node_id] = node_id;
-
-    while (!nodes_queue.empty()) {
-        const std::string curr_node_id = nodes_queue.front();
-        nodes_queue.pop();
-        for (const std::string& neighbor_id : adjacency_map_[curr_node_id]) {
-            if (visited_.find(neighbor_id) != visited_.end()) continue;
-            visited_.insert(neighbor_id);
-            path_to_[neighbor_id] = curr_node_id;
-            nodes_queue.push(neighbor_id);
+    BFS(node_id, &context_);
+}
+
+void DirectedGraph::BFS(const std::string& node_id, TraversalContext* context) const {
+    const uint32_t node = StartTraversal(node_id, context);
+    if (node == kNoVertex) return;
+
+    std::vector<uint32_t>& nodes_queue = *context->buffer();
+    nodes_queue.push_back(node);
+    context->Visit(node, node);
+
+    for (size_t head = 0; head < nodes_queue.size(); head++) {
+        const uint32_t curr_node = nodes_queue[head];
+        for (const uint32_t* neighbor = forward_.begin(curr_node); neighbor != forward_.end(curr_node); neighbor++) {
+            if (context->visited(*neighbor)) continue;
+            context->Visit(*neighbor, curr_node);
+            nodes_queue.push_back(*neighbor);
         }
     }
 }
 
+void DirectedGraph::BFS(const std::string& node_id, PathTree* tree) {
+    BFS(node_id, &context_, tree);
+}
+
+void DirectedGraph::BFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const {
+    BFS(node_id, context);
+    const uint32_t node = index_.Find(node_id);
+    if (node == kNoVertex) {
+        tree->Clear();
+        return;
+    }
+    // The queue of the BFS lists every reached node after its parent.
+    tree->Reset(V_, node);
+    const std::vector<uint32_t>& nodes_queue = *context->buffer();
+    for (size_t i = 1; i < nodes_queue.size(); i++) {
+        const uint32_t parent = context->parent(nodes_queue[i]);
+        tree->Reach(nodes_queue[i], tree->distance(parent) + 1, parent);
+    }
+}
+
+void DirectedGraph::ParallelBFS(const std::string& node_id, int num_threads) {
+    ThreadPool pool(num_threads);
+    ParallelBFS(node_id, &pool, &context_);
+}
+
+void DirectedGraph::ParallelBFS(const std::string& node_id, ThreadPool* pool, TraversalContext* context) const {
+    const uint32_t node = StartTraversal(node_id, context);
+    if (node == kNoVertex) return;
+    ParallelBreadthFirstSearch(forward_, node, pool, context);
+}
+
 bool DirectedGraph::DoesPathExist(const std::string& node_to) {
-    return visited_.find(node_to) != visited_.end();
+    return DoesPathExist(node_to, context_);
+}
+
+bool DirectedGraph::DoesPathExist(const std::string& node_to, const TraversalContext& context) const {
+    return context.visited(index_.Find(node_to));
 }
 
 bool DirectedGraph::DoesPathExist(const std::string& node_from, const std::string& node_to) {
-    DFS(node_to);
-    return DoesPathExist(node_from);
+    return DoesPathExist(node_from, node_to, &context_);
+}
+
+bool DirectedGraph::DoesPathExist(const std::string& node_from, const std::string& node_to, TraversalContext* context) const {
+    if (reachability_indexed_) {
+        const uint32_t from = index_.Find(node_from);
+        const uint32_t to = index_.Find(node_to);
+        return from != kNoVertex && to != kNoVertex && reachability_.Reaches(from, to, context);
+    }
+    const uint32_t from = StartTraversal(node_from, context);
+    const uint32_t to = index_.Find(node_to);
+    if (from == kNoVertex || to == kNoVertex) return false;
+
+    std::vector<uint32_t>& nodes_stack = *context->buffer();
+    nodes_stack.push_back(from);
+    context->Visit(from, from);
+
+    while (!nodes_stack.empty() && !context->visited(to)) {
+        const uint32_t curr_node = nodes_stack.back();
+        nodes_stack.pop_back();
+        for (const uint32_t* neighbor = forward_.begin(curr_node); neighbor != forward_.end(curr_node); neighbor++) {
+            if (context->visited(*neighbor)) continue;
+            context->Visit(*neighbor, curr_node);
+            nodes_stack.push_back(*neighbor);
+        }
+    }
+    return context->visited(to);
+}
+
+std::vector<bool> DirectedGraph::DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries) {
+    return DoesPathExist(queries, &context_);
+}
+
+std::vector<bool> DirectedGraph::DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries,
+                                               TraversalContext* context) const {
+    EnsureFrozen();
+    std::vector<std::pair<uint32_t, uint32_t>> dense_queries;
+    dense_queries.reserve(queries.size());
+    for (const auto& query : queries) {
+        dense_queries.push_back({index_.Find(query.first), index_.Find(query.second)});
+    }
+    std::vector<bool> answers;
+    BatchReachability(forward_, dense_queries, context, &answers);
+    return answers;
+}
+
+void DirectedGraph::BuildReachabilityIndex(int num_labelings) {
+    EnsureFrozen();
+    reachability_.Build(forward_, num_labelings, &context_);
+    reachability_indexed_ = true;
 }
 
 std::vector<std::string> DirectedGraph::GetPath(const std::string& node_to) {
+    return GetPath(node_to, context_);
+}
+
+std::vector<std::string> DirectedGraph::GetPath(const std::string& node_to, const TraversalContext& context) const {
     std::vector<std::string> path;
-    if (!DoesPathExist(node_to)) return path;
-    std::string iter_node = node_to;
-    while (iter_node != path_to_[iter_node]) {
-        path.insert(path.begin(), iter_node);
-        iter_node = path_to_[iter_node];
+    if (!DoesPathExist(node_to, context)) return path;
+    uint32_t iter_node = index_.Find(node_to);
+    while (iter_node != context.parent(iter_node)) {
+        path.push_back(index_.Id(iter_node));
+        iter_node = context.parent(iter_node);
     }
-    path.insert(path.begin(), iter_node);
+    path.push_back(index_.Id(iter_node));
+    std::reverse(path.begin(), path.end());
     return path;
 }
 
 std::vector<std::string> DirectedGraph::GetPath(const std::string& node_from, const std::string& node_to) {
-    DFS(node_from);
-    return GetPath(node_to);
+    return GetPath(node_from, node_to, &context_);
+}
+
+std::vector<std::string> DirectedGraph::GetPath(const std::string& node_from, const std::string& node_to, TraversalContext* context) const {
+    DFS(node_from, context);
+    return GetPath(node_to, *context);
+}
+
+std::vector<std::string> DirectedGraph::ShortestPath(const std::string& node_from, const std::string& node_to) {
+    return ShortestPath(node_from, node_to, &context_, &target_context_);
+}
+
+std::vector<std::string> DirectedGraph::ShortestPath(const std::string& node_from, const std::string& node_to,
+                                                     TraversalContext* source_context, TraversalContext* target_context) const {
+    std::vector<std::string> path;
+    const uint32_t from = StartTraversal(node_from, source_context);
+    const uint32_t to = index_.Find(node_to);
+    std::vector<uint32_t> dense_path;
+    if (from == kNoVertex || to == kNoVertex ||
+        !BidirectionalBFS(forward_, reverse_, from, to, source_context, target_context, &dense_path)) {
+        return path;
+    }
+    path.reserve(dense_path.size());
+    for (const uint32_t node : dense_path) {
+        path.push_back(index_.Id(node));
+    }
+    return path;
+}
+
+bool DirectedGraph::WeightedShortestPaths(const std::string& node_from, PathTree* tree) const {
+    const uint32_t from = index_.Find(node_from);
+    if (from == kNoVertex) return false;
+    if (negative_weights_ > 0) {
+        std::cout << "Weighted shortest paths need non-negative edge weights" << std::endl;
+        return false;
+    }
+    EnsureFrozen();
+    IndexedHeap heap;
+    Dijkstra(forward_, from, kNoVertex, &heap, tree);
+    return true;
+}
+
+bool DirectedGraph::ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, int num_threads, PathTree* tree) const {
+    ThreadPool pool(num_threads);
+    return ParallelWeightedShortestPaths(node_from, delta, &pool, tree);
+}
+
+bool DirectedGraph::ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, ThreadPool* pool, PathTree* tree) const {
+    const uint32_t from = index_.Find(node_from);
+    if (from == kNoVertex) return false;
+    if (negative_weights_ > 0) {
+        std::cout << "Weighted shortest paths need non-negative edge weights" << std::endl;
+        return false;
+    }
+    EnsureFrozen();
+    DeltaStepping(forward_, from, delta, pool, tree);
+    return true;
+}
+
+std::vector<std::string> DirectedGraph::GetPath(const std::string& node_to, const PathTree& tree) const {
+    std::vector<std::string> path;
+    std::vector<uint32_t> dense_path;
+    if (tree.PathTo(index_.Find(node_to), &dense_path)) {
+        path.reserve(dense_path.size());
+        for (const uint32_t node : dense_path) {
+            path.push_back(index_.Id(node));
+        }
+    }
+    return path;
+}
+
+int64_t DirectedGraph::Distance(const std::string& node_to, const PathTree& tree) const {
+    const uint32_t to = index_.Find(node_to);
+    return tree.reached(to) ? tree.distance(to) : -1;
+}
+
+std::vector<std::vector<std::string>> DirectedGraph::GetPaths(const std::vector<std::string>& nodes_to, const PathTree& tree) const {
+    std::vector<uint32_t> targets;
+    targets.reserve(nodes_to.size());
+    for (const auto& node_to : nodes_to) {
+        targets.push_back(index_.Find(node_to));
+    }
+    std::vector<uint32_t> nodes;
+    std::vector<size_t> offsets;
+    tree.PathsTo(targets, &nodes, &offsets);
+    std::vector<std::vector<std::string>> paths(nodes_to.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        paths[i].reserve(offsets[i + 1] - offsets[i]);
+        for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+            paths[i].push_back(index_.Id(nodes[j]));
+        }
+    }
+    return paths;
+}
+
+std::vector<std::string> DirectedGraph::WeightedShortestPath(const std::string& node_from, const std::string& node_to, int64_t* distance) const {
+    const uint32_t from = index_.Find(node_from);
+    const uint32_t to = index_.Find(node_to);
+    PathTree tree;
+    if (from != kNoVertex && to != kNoVertex && negative_weights_ == 0) {
+        EnsureFrozen();
+        IndexedHeap heap;
+        Dijkstra(forward_, from, to, &heap, &tree);
+    } else if (negative_weights_ > 0) {
+        std::cout << "Weighted shortest paths need non-negative edge weights" << std::endl;
+    }
+    if (distance != nullptr) {
+        *distance = Distance(node_to, tree);
+    }
+    return GetPath(node_to, tree);
 }
 
 void DirectedGraph::PrintPath(const std::vector<std::string>& path_nodes) const {
@@ -121,12 +458,18 @@ void DirectedGraph::PrintPath(const std::vector<std::string>& path_nodes) const
 }
 
 void DirectedGraph::PrintAllEdges() const {
-    for (const auto& vertex : edges_) {
-        const std::unordered_map<std::string, Edge>& adjoining_nodes_map = vertex.second;
-        for (const auto& node_edge_map : adjoining_nodes_map) {
-            const Edge& edge = node_edge_map.second;
-            edge.PrintEdge();
+    // A mapped graph only has its adjacency.
+    if (snapshot_ != nullptr) {
+        for (uint32_t node = 0; node < forward_.V(); node++) {
+            const int* weight = forward_.weight_begin(node);
+            for (const uint32_t* neighbor = forward_.begin(node); neighbor != forward_.end(node); neighbor++, weight++) {
+                std::cout << index_.Id(node) << " -> " << index_.Id(*neighbor) << " : (" << *weight << ")" << std::endl;
+            }
         }
+        return;
+    }
+    for (size_t i = 0; i < edge_list_.size(); i++) {
+        std::cout << index_.Id(edge_list_[i].first) << " -> " << index_.Id(edge_list_[i].second) << " : (" << edge_weights_[i] << ")" << std::endl;
     }
 }
 
@@ -3,33 +3,84 @@
 
 #include "../node.h"
 #include "../edge.h"
+#include "../vertex_index.h"
+#include "../compressed_adjacency.h"
+#include "../edge_list_loader.h"
+#include "../graph_snapshot.h"
+#include "../indexed_heap.h"
+#include "../path_tree.h"
+#include "../traversal_context.h"
+#include "../reachability_index.h"
+#include "../thread_pool.h"
+#include "../vertex_order.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <stack>
-#include <unordered_set>
 #include <unordered_map>
 
 namespace directed_graph {
 
+// Directed graph over string vertex ids. Queries that take a TraversalContext, PathTree or ThreadPool keep all their
+// state there and are const, so any number of threads can query one graph at once, each with its own context, as long
+// as no thread modifies it meanwhile. The overloads without a context share state kept in the graph and are not for
+// concurrent use.
 class DirectedGraph {
   private:
-    std::unordered_map<std::string, std::string> path_to_;
-
-    // Utility method for implementation of DFS.
-    void DFSUtil(const std::string& node_id);
-
     // Utility method for implementation of BFS.
     void BFSUtil(const std::string& node_id);
 
   protected:
     int V_, E_;
-    std::unordered_map<std::string, Node> vertices_;
-    std::unordered_map<std::string, std::vector<std::string>> adjacency_map_;
-    std::unordered_map<std::string, std::unordered_map<std::string, Edge>> edges_;
-    std::unordered_set<std::string> visited_;
+
+    // Dense integer id of every vertex.
+    VertexIndex index_;
+
+    // Tail and head of every added arc as dense ids, in insertion order, and the weight of each: the only copy of the
+    // edges, 12 bytes per arc. Each entry is one arc, read forwards to build forward_ and backwards to build reverse_.
+    std::vector<std::pair<uint32_t, uint32_t>> edge_list_;
+    std::vector<int> edge_weights_;
+
+    // Count of added edges with a negative weight, which rule out Dijkstra's algorithm.
+    int negative_weights_;
+
+    // Out-edge and in-edge adjacency built from edge_list_ by Freeze(); only valid while frozen_ is set. Built on first
+    // use by const queries, under freeze_mutex_.
+    mutable CompressedAdjacency forward_;
+    mutable CompressedAdjacency reverse_;
+    mutable std::atomic<bool> frozen_;
+    mutable std::mutex freeze_mutex_;
+
+    // Traversal state used by the methods that are not given a context.
+    TraversalContext context_;
+
+    // State of the search from the target in ShortestPath when it is not given contexts.
+    TraversalContext target_context_;
+
+    // Reachability labels built by BuildReachabilityIndex(); only valid while reachability_indexed_ is set, which
+    // every mutation clears.
+    ReachabilityIndex reachability_;
+    bool reachability_indexed_;
+
+    // Snapshot file that index_, forward_ and reverse_ read from after LoadMapped(); null otherwise.
+    std::shared_ptr<const MappedFile> snapshot_;
+
+    // Returns true, printing a message, if the graph was loaded with LoadMapped() and so cannot be modified.
+    bool RefuseMutation() const;
+
+    // Build the adjacency unless it is built already. Safe to call from any number of threads at once: the first one
+    // builds it and the others wait for it.
+    void EnsureFrozen() const;
+
+    // Freeze the graph and start a new traversal in context. Returns the dense id of node_id, or kNoVertex if it is not in the graph.
+    uint32_t StartTraversal(const std::string& node_id, TraversalContext* context) const;
 
   public:
+    // Edges only lead from their first endpoint to their second.
+    static const bool kDirected = true;
+
     // Create an empty graph.
-    DirectedGraph() { V_ = E_ = 0; }
+    DirectedGraph() : negative_weights_(0), frozen_(false), reachability_indexed_(false) { V_ = E_ = 0; }
 
     // Create an empty graph with the given set of vertices.
     DirectedGraph(const std::vector<Node>& vertices);
@@ -37,35 +88,149 @@ class DirectedGraph {
     // Create a graph with the given set of edges.
     DirectedGraph(const std::vector<Edge>& edges);
 
+    // Create a graph with the vertices and edges of base followed by the given vertices and edges, leaving base as it
+    // is. Copies the edge list of base and builds a new adjacency on first use. A base loaded with LoadMapped is
+    // shared instead, and the new graph is read-only like it.
+    DirectedGraph(const DirectedGraph& base, const std::vector<Node>& vertices, const std::vector<Edge>& edges);
+
+    virtual ~DirectedGraph() {}
+
     // Add vertex to graph.
-    bool AddVertex(const Node& n);
+    virtual bool AddVertex(const Node& n);
 
-    // Add edge to graph.
-    void AddEdge(const Edge& edge);
+    // Add edge to graph. Returns false if the edge was rejected.
+    virtual bool AddEdge(const Edge& edge);
 
     // Get count of vertices.
-    int V() { return V_; }
+    int V() const { return V_; }
 
     // Get count of edges.
-    int E() { return E_; }
+    int E() const { return E_; }
+
+    // Dense ids of the vertices, and the out-edge and in-edge adjacency over them, for code that searches the graph in
+    // place, such as the versions of versioned_graph.h. Builds the adjacency if needed.
+    const VertexIndex& vertex_index() const { return index_; }
+    const CompressedAdjacency& out_adjacency() const { EnsureFrozen(); return forward_; }
+    const CompressedAdjacency& in_adjacency() const { EnsureFrozen(); return reverse_; }
+
+    // Add the edges of the text edge list at path ("u v [w]" lines for u -> v; see edge_list_loader.h), read chunk_bytes
+    // at a time and parsed on the workers of pool, then build the adjacency in bulk. Returns false if the file cannot be
+    // read. If stats is not null the work done is stored in it.
+    virtual bool LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats);
+    bool LoadEdgeList(const std::string& path, int num_threads);
+
+    // Build the out-edge and in-edge adjacency used by all traversals. Traversals freeze the graph
+    // themselves after a mutation, so calling this is only needed to pay the cost up front.
+    void Freeze();
+
+    // Renumber the dense ids in the given order (see vertex_order.h), so that traversals find the vertices they visit
+    // together close together in memory. String ids, edges and the answers of queries stay the same; only the order
+    // in which traversals meet neighbors may change. Clears the traversal state of DFS and BFS, so DoesPathExist(node_to)
+    // and GetPath(node_to) need a new traversal. Returns false if the graph was loaded with LoadMapped.
+    virtual bool Reorder(VertexOrder order);
+
+    // Write the frozen graph (ids, out-edge and in-edge adjacency and weights) to path in the snapshot format of
+    // graph_snapshot.h. Returns false if the file cannot be written.
+    bool Save(const std::string& path);
+
+    // Load the snapshot written by Save() at path into this empty graph by mapping the file read-only: ids and
+    // adjacency are read in place from the page cache, shared by every process mapping the file, so loading costs
+    // no parsing or copying however large the graph. The graph cannot be modified afterwards. Returns false if the
+    // graph is not empty or the file is not a snapshot of a directed graph.
+    virtual bool LoadMapped(const std::string& path);
+
+    // Get count of edges ending at the input node.
+    int InDegree(const std::string& node_id) const;
+
+    // Get the nodes with an edge ending at the input node.
+    std::vector<std::string> InNeighbors(const std::string& node_id) const;
 
     // DFS implementaion.
     void DFS(const std::string& node_id);
+    void DFS(const std::string& node_id, TraversalContext* context) const;
+
+    // DFS from node_id filling tree with the parent and depth in the DFS tree of every reachable node, like the BFS
+    // overload.
+    void DFS(const std::string& node_id, PathTree* tree);
+    void DFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const;
 
     // BFS implementation.
     void BFS(const std::string& node_id);
+    void BFS(const std::string& node_id, TraversalContext* context) const;
+
+    // BFS from node_id filling tree with the parent and depth (fewest edges from node_id) of every reachable node, so
+    // that one traversal serves any number of GetPath and GetPaths calls for node_id, even after other traversals
+    // ran. Leaves tree empty if node_id is not in the graph. Overwrites the traversal state of DFS and BFS.
+    void BFS(const std::string& node_id, PathTree* tree);
+    void BFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const;
+
+    // Level-synchronous BFS expanding each level on num_threads threads, or one per hardware thread if num_threads is not positive.
+    // Leaves a BFS tree for GetPath and DoesPathExist like BFS does.
+    void ParallelBFS(const std::string& node_id, int num_threads);
+    void ParallelBFS(const std::string& node_id, ThreadPool* pool, TraversalContext* context) const;
 
     // If DFS or BFS is run already for a node, then the result for whether or not a path exists to the input node is returned.
     bool DoesPathExist(const std::string& node_to);
+    bool DoesPathExist(const std::string& node_to, const TraversalContext& context) const;
 
-    // The result for whether or not a path exists from node_from to node_to is returned.
+    // The result for whether or not a path exists from node_from to node_to is returned. The search stops as soon as node_to is reached.
+    // Answered from the reachability index instead when there is one.
     bool DoesPathExist(const std::string& node_from, const std::string& node_to);
+    bool DoesPathExist(const std::string& node_from, const std::string& node_to, TraversalContext* context) const;
+
+    // Answers whether a path exists for every (node_from, node_to) pair of queries, in order. Up to 64 distinct
+    // node_from share one bit-parallel pass over the strongly connected components, so a large batch costs about
+    // 1/64 of answering its pairs one search at a time. Overwrites the traversal state of DFS and BFS.
+    std::vector<bool> DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries);
+    std::vector<bool> DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries, TraversalContext* context) const;
+
+    // Build reachability labels (see ReachabilityIndex) with num_labelings intervals per strongly connected component,
+    // so that DoesPathExist(node_from, node_to) answers most negative queries in O(1) and positive ones with a search
+    // pruned by the labels. Meant for graphs queried far more often than modified: adding a vertex or edge drops it.
+    void BuildReachabilityIndex(int num_labelings);
+
+    // Whether DoesPathExist(node_from, node_to) is answered from the reachability index.
+    bool HasReachabilityIndex() const { return reachability_indexed_; }
+
+    // Reachability index built by BuildReachabilityIndex(), for its size and query counters.
+    const ReachabilityIndex& reachability_index() const { return reachability_; }
 
     // If DFS or BFS is run already for a node, then the path from input node is returned. A message for non-existent path is returned in case there is no path.
     std::vector<std::string> GetPath(const std::string& node_to);
+    std::vector<std::string> GetPath(const std::string& node_to, const TraversalContext& context) const;
 
     // The path from node_from to node_to is returned. A message for non-existent path is returned in case there is no path.
     std::vector<std::string> GetPath(const std::string& node_from, const std::string& node_to);
+    std::vector<std::string> GetPath(const std::string& node_from, const std::string& node_to, TraversalContext* context) const;
+
+    // Shortest path (fewest edges) from node_from to node_to found by a bidirectional BFS, which stops as soon as the
+    // searches from both ends meet (the one from node_to walking in-edges) and so explores far less of a large graph than a search from node_from alone.
+    // Empty if there is no path. The two contexts are left holding the partial searches from either end.
+    std::vector<std::string> ShortestPath(const std::string& node_from, const std::string& node_to);
+    std::vector<std::string> ShortestPath(const std::string& node_from, const std::string& node_to, TraversalContext* source_context,
+                                          TraversalContext* target_context) const;
+
+    // Dijkstra's algorithm from node_from over the edge weights, filling tree with the distance and parent of every
+    // reachable vertex. Returns false, leaving tree untouched, if node_from is not in the graph or an edge weight is negative.
+    bool WeightedShortestPaths(const std::string& node_from, PathTree* tree) const;
+
+    // Delta-stepping on num_threads threads (or one per hardware thread if num_threads is not positive) from node_from over
+    // the edge weights, filling tree with the same distances as WeightedShortestPaths. delta is the bucket width; if it
+    // is not positive one is picked from the weights and the average degree. Returns false like WeightedShortestPaths.
+    bool ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, int num_threads, PathTree* tree) const;
+    bool ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, ThreadPool* pool, PathTree* tree) const;
+
+    // Path from the source of tree to node_to, or empty if node_to is not reached; and its weight, or -1.
+    std::vector<std::string> GetPath(const std::string& node_to, const PathTree& tree) const;
+    int64_t Distance(const std::string& node_to, const PathTree& tree) const;
+
+    // Paths from the source of tree to every node of nodes_to, in order, each empty if the node is not reached.
+    std::vector<std::vector<std::string>> GetPaths(const std::vector<std::string>& nodes_to, const PathTree& tree) const;
+
+    // Path of least total weight from node_from to node_to, found by Dijkstra's algorithm stopping once node_to is
+    // settled. Empty if there is no path or an edge weight is negative. If distance is not null the weight of the
+    // path, or -1, is stored in it.
+    std::vector<std::string> WeightedShortestPath(const std::string& node_from, const std::string& node_to, int64_t* distance) const;
 
     // Print the input path.
     void PrintPath(const std::vector<std::string>& path_nodes) const;
@@ -0,0 +1,343 @@
+#include "directed_graph.h"
+#include "strongly_connected_components.h"
+#include "topological_sort.h"
+#include "../benchmark_utils.h"
+#include "../versioned_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+namespace directed_graph {
+
+  /**
+   * Time sequential BFS and parallel BFS for increasing thread counts from the same source.
+   */
+  void BenchmarkBFS(DirectedGraph& dg, const std::string& source, int max_threads) {
+    TraversalContext context;
+    dg.Freeze();
+    dg.BFS(source, &context);
+
+    benchmark::Timer timer;
+    dg.BFS(source, &context);
+    benchmark::Report("BFS", timer.Seconds(), dg.E());
+
+    for (int num_threads = 1; ; num_threads = std::min(2 * num_threads, max_threads)) {
+      ThreadPool pool(num_threads);
+      benchmark::Timer parallel_timer;
+      dg.ParallelBFS(source, &pool, &context);
+      benchmark::Report("ParallelBFS threads=" + std::to_string(num_threads), parallel_timer.Seconds(), dg.E());
+      if (num_threads == max_threads) break;
+    }
+  }
+
+  /**
+   * Time strongly connected components with Tarjan's algorithm and with the parallel forward-backward algorithm for
+   * increasing thread counts, then the condensation, and report the count of components and the size of the largest.
+   */
+  void BenchmarkStrongComponents(const StronglyConnectedComponents& dg, int max_threads) {
+    TraversalContext context;
+    std::vector<uint32_t> labels;
+    dg.TarjanComponents(&context, &labels);
+
+    benchmark::Timer timer;
+    const uint32_t count = dg.TarjanComponents(&context, &labels);
+    benchmark::Report("Tarjan SCC", timer.Seconds(), dg.E());
+    std::vector<uint32_t> sizes(count);
+    for (const uint32_t label : labels) sizes[label]++;
+    std::cout << "components: " << count << ", largest: " << *std::max_element(sizes.begin(), sizes.end()) << std::endl;
+
+    for (int num_threads = 1; ; num_threads = std::min(2 * num_threads, max_threads)) {
+      ThreadPool pool(num_threads);
+      benchmark::Timer parallel_timer;
+      dg.ParallelComponents(&pool, &labels);
+      benchmark::Report("Forward-backward SCC threads=" + std::to_string(num_threads), parallel_timer.Seconds(), dg.E());
+      if (num_threads == max_threads) break;
+    }
+
+    benchmark::Timer condensation_timer;
+    std::unique_ptr<DirectedGraph> condensation = dg.Condensation(labels);
+    benchmark::Report("condensation", condensation_timer.Seconds(), dg.E());
+    std::cout << "condensation: " << condensation->V() << " vertices, " << condensation->E() << " edges" << std::endl;
+  }
+
+  /**
+   * Time single-source Dijkstra, Delta-stepping for a few bucket widths and increasing thread counts, and num_queries
+   * point-to-point weighted shortest paths between random pairs.
+   */
+  void BenchmarkDijkstra(DirectedGraph& dg, const std::string& source, int num_vertices, int num_queries, int max_threads) {
+    PathTree tree;
+    benchmark::Timer timer;
+    dg.WeightedShortestPaths(source, &tree);
+    const double dijkstra_seconds = timer.Seconds();
+    benchmark::Report("WeightedShortestPaths", dijkstra_seconds, dg.E());
+
+    PathTree parallel_tree;
+    for (const int64_t delta : {0, 25, 100}) {
+      for (int num_threads = 1; ; num_threads = std::min(2 * num_threads, max_threads)) {
+        ThreadPool pool(num_threads);
+        benchmark::Timer parallel_timer;
+        dg.ParallelWeightedShortestPaths(source, delta, &pool, &parallel_tree);
+        const double seconds = parallel_timer.Seconds();
+        benchmark::Report("DeltaStepping delta=" + std::to_string(delta) + " threads=" + std::to_string(num_threads), seconds, dg.E());
+        std::cout << "    speedup over Dijkstra: " << dijkstra_seconds / seconds << std::endl;
+        if (num_threads == max_threads) break;
+      }
+    }
+
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+    benchmark::Timer point_timer;
+    for (int i = 0; i < num_queries; i++) {
+      dg.WeightedShortestPath(std::to_string(vertex(generator)), std::to_string(vertex(generator)), nullptr);
+    }
+    benchmark::Report("WeightedShortestPath pairs=" + std::to_string(num_queries), point_timer.Seconds(),
+                      static_cast<double>(num_queries) * dg.E());
+  }
+
+  /**
+   * Time num_queries random reachability pairs answered one search at a time and as one batch. Rates count every
+   * pair as a pass over all edges.
+   */
+  void BenchmarkBatchReachability(DirectedGraph& dg, int num_vertices, int num_queries) {
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (int i = 0; i < num_queries; i++) {
+      queries.push_back({std::to_string(vertex(generator)), std::to_string(vertex(generator))});
+    }
+    const double pass_edges = static_cast<double>(num_queries) * dg.E();
+
+    benchmark::Timer timer;
+    int reachable = 0;
+    for (const auto& query : queries) {
+      reachable += dg.DoesPathExist(query.first, query.second);
+    }
+    benchmark::Report("DoesPathExist pairs=" + std::to_string(num_queries), timer.Seconds(), pass_edges);
+
+    benchmark::Timer batch_timer;
+    const std::vector<bool> answers = dg.DoesPathExist(queries);
+    benchmark::Report("DoesPathExist batch=" + std::to_string(num_queries), batch_timer.Seconds(), pass_edges);
+    std::cout << reachable << " of " << num_queries << " pairs reachable, batch agrees: "
+              << (std::count(answers.begin(), answers.end(), true) == reachable ? "yes" : "no") << std::endl;
+  }
+
+  /**
+   * Time building the reachability index for 1 to 5 labelings, with its memory, and num_queries random pairs answered
+   * by plain searches and from the index.
+   */
+  void BenchmarkReachabilityIndex(DirectedGraph& dg, int num_vertices, int num_queries) {
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (int i = 0; i < num_queries; i++) {
+      queries.push_back({std::to_string(vertex(generator)), std::to_string(vertex(generator))});
+    }
+
+    benchmark::Timer timer;
+    for (const auto& query : queries) {
+      dg.DoesPathExist(query.first, query.second);
+    }
+    const double search_seconds = timer.Seconds();
+    std::cout << "DoesPathExist searches: " << num_queries / search_seconds << " queries/s" << std::endl;
+
+    for (int num_labelings = 1; num_labelings <= 5; num_labelings += 2) {
+      benchmark::Timer build_timer;
+      dg.BuildReachabilityIndex(num_labelings);
+      benchmark::Report("BuildReachabilityIndex labelings=" + std::to_string(num_labelings), build_timer.Seconds(), dg.E());
+      benchmark::Timer query_timer;
+      for (const auto& query : queries) {
+        dg.DoesPathExist(query.first, query.second);
+      }
+      const double query_seconds = query_timer.Seconds();
+      const ReachabilityIndex& index = dg.reachability_index();
+      std::cout << "  " << index.MemoryBytes() << " bytes (" << static_cast<double>(index.MemoryBytes()) / dg.V()
+                << " per vertex), " << num_queries / query_seconds << " queries/s, " << index.searches() << " of "
+                << index.queries() << " queries searched" << std::endl;
+    }
+  }
+
+  /**
+   * Time num_queries random pairs answered by the const queries of dg from increasing thread counts, each worker with
+   * its own contexts: shortest paths by bidirectional BFS, then reachability (from the index if dg has one). Rates are
+   * queries per second, with the speedup over one thread.
+   */
+  void BenchmarkQueryThroughput(const DirectedGraph& dg, int num_vertices, int num_queries, int max_threads) {
+    std::mt19937 generator(13);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (int i = 0; i < num_queries; i++) {
+      queries.push_back({std::to_string(vertex(generator)), std::to_string(vertex(generator))});
+    }
+
+    for (const bool shortest_paths : {true, false}) {
+      const std::string name = shortest_paths ? "ShortestPath" : "DoesPathExist";
+      double one_thread_seconds = 0;
+      for (int num_threads = 1; ; num_threads = std::min(2 * num_threads, max_threads)) {
+        ThreadPool pool(num_threads);
+        std::vector<TraversalContext> source_contexts(pool.size()), target_contexts(pool.size());
+        std::vector<size_t> answered(pool.size(), 0);
+        benchmark::Timer timer;
+        pool.ParallelFor(queries.size(), 16, [&](size_t begin, size_t end, int worker) {
+          for (size_t i = begin; i < end; i++) {
+            if (shortest_paths) {
+              answered[worker] += !dg.ShortestPath(queries[i].first, queries[i].second, &source_contexts[worker],
+                                                   &target_contexts[worker]).empty();
+            } else {
+              answered[worker] += dg.DoesPathExist(queries[i].first, queries[i].second, &source_contexts[worker]);
+            }
+          }
+        });
+        const double seconds = timer.Seconds();
+        if (num_threads == 1) one_thread_seconds = seconds;
+        std::cout << std::left << std::setw(40) << name + " threads=" + std::to_string(num_threads) << std::right
+                  << std::setw(12) << num_queries / seconds << " queries/s, speedup " << one_thread_seconds / seconds
+                  << ", " << std::accumulate(answered.begin(), answered.end(), size_t(0)) << " reachable" << std::endl;
+        if (num_threads == max_threads) break;
+      }
+    }
+  }
+
+  /**
+   * Print the median, 99th and 99.9th percentiles and largest of latencies, in microseconds.
+   */
+  void ReportLatencies(const std::string& name, std::vector<double>* latencies) {
+    std::sort(latencies->begin(), latencies->end());
+    const auto percentile = [&](double p) { return 1e6 * (*latencies)[static_cast<size_t>(p * (latencies->size() - 1))]; };
+    std::cout << std::left << std::setw(40) << name << std::right << std::setprecision(1) << " p50 " << std::setw(8)
+              << percentile(0.5) << " us, p99 " << std::setw(8) << percentile(0.99) << " us, p99.9 " << std::setw(8)
+              << percentile(0.999) << " us, max " << std::setw(8) << percentile(1.0) << " us" << std::endl;
+  }
+
+  /**
+   * Time the latency of shortest path queries between random pairs, on a reader thread, while a writer thread adds
+   * num_batches batches of batch_edges random edges: with no writer, with a versioned graph whose readers query pinned
+   * versions while batches go into its overlay and are compacted in the background, and with one graph that readers
+   * and the writer take turns on under a mutex.
+   */
+  void BenchmarkIngestLatency(int num_vertices, int num_edges, int num_batches, int batch_edges) {
+    const std::vector<Edge> edges = benchmark::RandomEdges(num_vertices, num_edges, 1);
+    std::vector<std::vector<Edge>> batches;
+    for (int batch = 0; batch < num_batches; batch++) {
+      batches.push_back(benchmark::RandomEdges(num_vertices, batch_edges, 100 + batch));
+    }
+    std::mt19937 generator(17);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+
+    VersionedGraph<DirectedGraph> versioned(edges);
+    DirectedGraph locked_graph(edges);
+    locked_graph.Freeze();
+    std::mutex graph_mutex;
+    for (const std::string mode : {"idle", "versioned", "locked"}) {
+      std::atomic<bool> ingesting(mode != "idle");
+      benchmark::Timer ingest_timer;
+      std::thread writer([&]() {
+        for (size_t batch = 0; mode != "idle" && batch < batches.size(); batch++) {
+          if (mode == "versioned") {
+            for (const Edge& edge : batches[batch]) versioned.AddEdge(edge);
+            versioned.Publish();
+          } else {
+            std::lock_guard<std::mutex> lock(graph_mutex);
+            for (const Edge& edge : batches[batch]) locked_graph.AddEdge(edge);
+            locked_graph.Freeze();
+          }
+        }
+        ingesting = false;
+      });
+
+      TraversalContext source_context, target_context;
+      std::vector<double> latencies;
+      for (int i = 0; i < 200 || ingesting; i++) {
+        const std::string from = std::to_string(vertex(generator)), to = std::to_string(vertex(generator));
+        benchmark::Timer query_timer;
+        if (mode == "locked") {
+          std::lock_guard<std::mutex> lock(graph_mutex);
+          locked_graph.ShortestPath(from, to, &source_context, &target_context);
+        } else {
+          versioned.Pin()->ShortestPath(from, to, &source_context, &target_context);
+        }
+        latencies.push_back(query_timer.Seconds());
+      }
+      writer.join();
+      const double ingest_seconds = ingest_timer.Seconds();
+      if (mode == "versioned") {
+        // Finish the compaction in flight, so that it does not share the CPU with the next run.
+        versioned.Compact();
+      }
+      ReportLatencies("ShortestPath during ingest: " + mode, &latencies);
+      if (mode != "idle") {
+        std::cout << "    " << num_batches << " batches of " << batch_edges << " edges in " << ingest_seconds << " s";
+        if (mode == "versioned") std::cout << ", " << versioned.compactions() << " compactions";
+        std::cout << std::endl;
+      }
+    }
+  }
+
+  /**
+   * Time BFS from source, the cycle check and the topological sort on the graph of edges as built, then after
+   * renumbering its vertices in each order, along with the time each renumbering takes.
+   */
+  void BenchmarkVertexOrders(const std::vector<Edge>& edges, const std::string& source) {
+    const std::vector<std::pair<std::string, VertexOrder>> orders = {
+        {"degree", VertexOrder::kDegree}, {"RCM", VertexOrder::kReverseCuthillMcKee},
+        {"BFS order", VertexOrder::kBreadthFirst}, {"Gorder", VertexOrder::kGorder}};
+    for (int i = -1; i < static_cast<int>(orders.size()); i++) {
+      const std::string name = i < 0 ? "insertion order" : orders[i].first;
+      TopologicalSort dg(edges);
+      dg.Freeze();
+      if (i >= 0) {
+        benchmark::Timer reorder_timer;
+        dg.Reorder(orders[i].second);
+        dg.Freeze();
+        benchmark::Report("reorder " + name, reorder_timer.Seconds(), dg.E());
+      }
+      TraversalContext context;
+      dg.BFS(source, &context);
+      benchmark::Timer bfs_timer;
+      dg.BFS(source, &context);
+      benchmark::Report("BFS " + name, bfs_timer.Seconds(), dg.E());
+      benchmark::Timer cycle_timer;
+      dg.IsCyclic(&context);
+      benchmark::Report("IsCyclic " + name, cycle_timer.Seconds(), dg.E());
+      benchmark::Timer sort_timer;
+      dg.TopologicallySorted(&context);
+      benchmark::Report("TopologicallySorted " + name, sort_timer.Seconds(), dg.E());
+    }
+  }
+
+}  // namespace directed_graph
+
+int main(int argc, char** argv) {
+  const int num_vertices = argc > 1 ? std::atoi(argv[1]) : 200000;
+  const int num_edges = argc > 2 ? std::atoi(argv[2]) : 8 * num_vertices;
+  const int max_threads = argc > 3 ? std::atoi(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+  std::cout << "Directed random graph: " << num_vertices << " vertices, " << num_edges << " edges" << std::endl;
+
+  benchmark::Timer timer;
+  // Unless the graph is very sparse, most of its vertices form one giant strongly connected component.
+  directed_graph::StronglyConnectedComponents dg(benchmark::RandomEdges(num_vertices, num_edges, 1));
+  benchmark::Report("construction", timer.Seconds(), num_edges);
+
+  directed_graph::BenchmarkBFS(dg, "0", max_threads);
+  directed_graph::BenchmarkStrongComponents(dg, max_threads);
+  directed_graph::BenchmarkDijkstra(dg, "0", num_vertices, 20, max_threads);
+  directed_graph::BenchmarkBatchReachability(dg, num_vertices, 512);
+  directed_graph::BenchmarkQueryThroughput(dg, num_vertices, 2000, max_threads);
+  directed_graph::BenchmarkIngestLatency(num_vertices, num_edges, 20, num_edges / 100);
+
+  // The same edges, each pointed from the lower to the higher id, give a DAG.
+  std::vector<Edge> dag_edges;
+  for (const Edge& edge : benchmark::RandomEdges(num_vertices, num_edges, 1)) {
+    if (std::stoi(edge.from()) < std::stoi(edge.to())) dag_edges.push_back(edge);
+    else if (edge.from() != edge.to()) dag_edges.push_back(Edge(edge.to(), edge.from(), edge.weight()));
+  }
+  std::cout << "Directed acyclic random graph: " << dag_edges.size() << " edges" << std::endl;
+  directed_graph::StronglyConnectedComponents dag(dag_edges);
+  directed_graph::BenchmarkStrongComponents(dag, max_threads);
+  directed_graph::BenchmarkReachabilityIndex(dag, num_vertices, 2000);
+  directed_graph::BenchmarkQueryThroughput(dag, num_vertices, 20000, max_threads);
+  directed_graph::BenchmarkVertexOrders(dag_edges, "0");
+}
@@ -1,5 +1,13 @@
 #include "directed_graph.h"
 #include "../test_utils.h"
+#include "../versioned_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <thread>
 
 namespace directed_graph {
 
@@ -81,6 +89,543 @@ namespace directed_graph {
     test_suite.TestResults();
   }
 
+  /**
+   * Test in-edge queries, including after edges are added to a frozen graph.
+   */
+  void TestInNeighbors(testing::Testing& test_suite) {
+    test_suite.init("in-edge queries on directed graph");
+    Node a("A"), b("B"), c("C"), d("D");
+    Edge e1(a.Id(), c.Id(), 1), e2(b.Id(), c.Id(), 1), e3(c.Id(), d.Id(), 1), e4(d.Id(), c.Id(), 1);
+    DirectedGraph dg({e1, e2, e3});
+    dg.Freeze();
+    test_suite.test(dg.InDegree(a.Id()) == 0);
+    test_suite.test(dg.InDegree(c.Id()) == 2);
+    test_suite.test(testing::ComparePaths(dg.InNeighbors(c.Id()), {"A", "B"}));
+    dg.AddEdge(e4);
+    test_suite.test(testing::ComparePaths(dg.InNeighbors(c.Id()), {"A", "B", "D"}));
+    test_suite.test(dg.InNeighbors("Z").empty());
+    test_suite.TestResults();
+  }
+
+  /**
+   * Test path queries follow edge direction and reuse caller owned contexts.
+   */
+  void TestPathExistsWithContext(testing::Testing& test_suite) {
+    test_suite.init("directed path queries reusing a caller owned context");
+    Node a("A"), b("B"), c("C"), d("D");
+    Edge e1(a.Id(), b.Id(), 1), e2(b.Id(), c.Id(), 1), e3(d.Id(), c.Id(), 1);
+    DirectedGraph dg({e1, e2, e3});
+    TraversalContext context;
+    for (int i = 0; i < 3; i++) {
+      test_suite.test(dg.DoesPathExist(a.Id(), c.Id(), &context));
+      test_suite.test(!dg.DoesPathExist(c.Id(), a.Id(), &context));
+      test_suite.test(!dg.DoesPathExist(a.Id(), d.Id(), &context));
+    }
+    test_suite.test(dg.DoesPathExist(a.Id(), c.Id()));
+    test_suite.test(!dg.DoesPathExist(c.Id(), a.Id()));
+    const std::vector<std::string> path = dg.GetPath(a.Id(), c.Id(), &context);
+    test_suite.test(testing::ComparePaths(path, {"A", "B", "C"}));
+    dg.PrintPath(path);
+    test_suite.TestResults();
+  }
+
+  /**
+   * Test parallel BFS leaves a BFS tree with the same reachability and path lengths as sequential BFS.
+   */
+  void TestParallelBFS(testing::Testing& test_suite) {
+    test_suite.init("parallel BFS against sequential BFS");
+    // Node i has edges to 2i + 1, 2i + 2 and back to i / 3, so some nodes are reached on several edges per level.
+    const int kNodes = 500;
+    std::vector<Edge> edges;
+    for (int node = 0; node < kNodes; node++) {
+      if (2 * node + 1 < kNodes) edges.push_back(Edge(std::to_string(node), std::to_string(2 * node + 1), 1));
+      if (2 * node + 2 < kNodes) edges.push_back(Edge(std::to_string(node), std::to_string(2 * node + 2), 1));
+      edges.push_back(Edge(std::to_string(node), std::to_string(node / 3), 1));
+    }
+    DirectedGraph dg(edges);
+    TraversalContext sequential, parallel;
+    ThreadPool pool(4);
+    dg.BFS("1", &sequential);
+    dg.ParallelBFS("1", &pool, &parallel);
+    for (int node = 0; node < kNodes; node++) {
+      const std::string node_id = std::to_string(node);
+      test_suite.test(dg.DoesPathExist(node_id, parallel) == dg.DoesPathExist(node_id, sequential));
+      test_suite.test(dg.GetPath(node_id, parallel).size() == dg.GetPath(node_id, sequential).size());
+    }
+    dg.PrintPath(dg.GetPath("498", parallel));
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test batch reachability against one search per pair, with more than 64 distinct sources so it takes several batches.
+  */
+  void TestBatchPathExists(testing::Testing& test_suite) {
+    test_suite.init("batch reachability against one search per pair");
+    const int kNodes = 300;
+    DirectedGraph dg(testing::RandomEdges(kNodes, 420, 2024));
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (const Edge& query : testing::RandomEdges(kNodes, 3000, 2025)) {
+      queries.push_back({query.from(), query.to()});
+    }
+    queries.push_back({"7", "7"});
+    queries.push_back({"7", "missing"});
+    queries.push_back({"missing", "7"});
+    const std::vector<bool> answers = dg.DoesPathExist(queries);
+    test_suite.test(answers.size() == queries.size());
+    int reachable = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+      test_suite.test(answers[i] == dg.DoesPathExist(queries[i].first, queries[i].second));
+      reachable += answers[i];
+    }
+    test_suite.test(answers[queries.size() - 3] && !answers[queries.size() - 2] && !answers.back());
+    test_suite.test(dg.DoesPathExist(std::vector<std::pair<std::string, std::string>>()).empty());
+    std::cout << reachable << " of " << queries.size() << " pairs reachable" << std::endl;
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test the reachability index against plain searches, on a DAG and on a graph with cycles.
+  */
+  void TestReachabilityIndex(testing::Testing& test_suite) {
+    test_suite.init("reachability index against searches");
+    const int kNodes = 400;
+    for (int acyclic = 1; acyclic >= 0; acyclic--) {
+      std::vector<Edge> edges;
+      for (const Edge& edge : testing::RandomEdges(kNodes, 700, 99 + acyclic)) {
+        // Edges from the lower id to the higher one leave no cycle.
+        const bool reversed = acyclic && std::stoi(edge.from()) > std::stoi(edge.to());
+        edges.push_back(reversed ? Edge(edge.to(), edge.from(), 1) : Edge(edge.from(), edge.to(), 1));
+      }
+      DirectedGraph dg(edges);
+      std::vector<std::pair<std::string, std::string>> queries;
+      std::vector<bool> expected;
+      for (const Edge& query : testing::RandomEdges(kNodes, 4000, 199 + acyclic)) {
+        queries.push_back({query.from(), query.to()});
+        expected.push_back(dg.DoesPathExist(query.from(), query.to()));
+      }
+      dg.BuildReachabilityIndex(3);
+      test_suite.test(dg.HasReachabilityIndex());
+      bool all_equal = true;
+      for (size_t i = 0; i < queries.size(); i++) {
+        all_equal = all_equal && dg.DoesPathExist(queries[i].first, queries[i].second) == expected[i];
+      }
+      test_suite.test(all_equal);
+      test_suite.test(!dg.DoesPathExist("0", "missing"));
+      const ReachabilityIndex& index = dg.reachability_index();
+      test_suite.test(index.searches() < index.queries());
+      std::cout << (acyclic ? "DAG: " : "Cyclic: ") << index.components() << " components, " << index.searches()
+                << " of " << index.queries() << " queries searched, " << index.MemoryBytes() << " bytes" << std::endl;
+      dg.AddEdge(Edge("missing", "0", 1));
+      test_suite.test(!dg.HasReachabilityIndex() && dg.DoesPathExist("missing", "0"));
+    }
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test bidirectional shortest paths against BFS paths, and that they follow edge directions.
+  */
+  void TestShortestPath(testing::Testing& test_suite) {
+    test_suite.init("bidirectional BFS shortest paths");
+    const int kNodes = 300;
+    DirectedGraph dg(testing::RandomEdges(kNodes, 600, 5));
+    TraversalContext bfs_context;
+    bool all_shortest = true;
+    for (int from = 0; from < kNodes; from += 13) {
+      dg.BFS(std::to_string(from), &bfs_context);
+      for (int to = 0; to < kNodes; to += 7) {
+        const std::vector<std::string> path = dg.ShortestPath(std::to_string(from), std::to_string(to));
+        all_shortest = all_shortest && path.size() == dg.GetPath(std::to_string(to), bfs_context).size();
+        for (size_t i = 0; i + 1 < path.size(); i++) {
+          const std::vector<std::string> in_neighbors = dg.InNeighbors(path[i + 1]);
+          all_shortest = all_shortest && std::find(in_neighbors.begin(), in_neighbors.end(), path[i]) != in_neighbors.end();
+        }
+      }
+    }
+    test_suite.test(all_shortest);
+    DirectedGraph chain({Edge("A", "B", 1), Edge("B", "C", 1)});
+    test_suite.test(testing::ComparePaths(chain.ShortestPath("A", "C"), {"A", "B", "C"}));
+    test_suite.test(chain.ShortestPath("C", "A").empty());
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test weighted shortest paths follow edge directions, and match Bellman-Ford relaxation on a random graph.
+  */
+  void TestWeightedShortestPaths(testing::Testing& test_suite) {
+    test_suite.init("weighted shortest paths with Dijkstra");
+    DirectedGraph dg({Edge("A", "B", 4), Edge("A", "C", 1), Edge("C", "B", 2), Edge("B", "D", 5), Edge("D", "A", 1)});
+    PathTree tree;
+    test_suite.test(dg.WeightedShortestPaths("B", &tree));
+    test_suite.test(dg.Distance("C", tree) == 7 && dg.Distance("B", tree) == 0);
+    test_suite.test(testing::ComparePaths(dg.GetPath("C", tree), {"B", "D", "A", "C"}));
+    int64_t distance = 0;
+    test_suite.test(testing::ComparePaths(dg.WeightedShortestPath("A", "D", &distance), {"A", "C", "B", "D"}));
+    test_suite.test(distance == 8);
+
+    const int kNodes = 200;
+    std::vector<Edge> edges = testing::RandomEdges(kNodes, 800, 23, 19, 0);
+    edges.push_back(Edge("0", "1", 50));
+    DirectedGraph random_dg(edges);
+    std::vector<int64_t> expected(kNodes, -1);
+    expected[0] = 0;
+    for (bool relaxed = true; relaxed; ) {
+      relaxed = false;
+      for (const Edge& edge : edges) {
+        const int a = std::stoi(edge.from()), b = std::stoi(edge.to());
+        if (expected[a] >= 0 && (expected[b] < 0 || expected[a] + edge.weight() < expected[b])) {
+          expected[b] = expected[a] + edge.weight();
+          relaxed = true;
+        }
+      }
+    }
+    bool all_equal = random_dg.WeightedShortestPaths("0", &tree);
+    for (int node = 0; node < kNodes; node++) {
+      all_equal = all_equal && random_dg.Distance(std::to_string(node), tree) == expected[node];
+      const std::vector<std::string> path = random_dg.GetPath(std::to_string(node), tree);
+      all_equal = all_equal && path.empty() == (expected[node] < 0);
+    }
+    test_suite.test(all_equal);
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test Delta-stepping gives the distances of Dijkstra for several bucket widths, including zero weight edges and
+  * weights far larger than the bucket width, and a parent tree whose paths have those distances.
+  */
+  void TestParallelWeightedShortestPaths(testing::Testing& test_suite) {
+    test_suite.init("delta-stepping against Dijkstra");
+    const int kNodes = 2000;
+    DirectedGraph dg(testing::RandomEdges(kNodes, 10000, 31, 59, 0));
+    PathTree expected, tree;
+    dg.WeightedShortestPaths("0", &expected);
+    ThreadPool pool(4);
+    for (const int64_t delta : {1, 7, 30, 1000, 0}) {
+      bool all_equal = dg.ParallelWeightedShortestPaths("0", delta, &pool, &tree);
+      for (int node = 0; node < kNodes; node++) {
+        const std::string node_id = std::to_string(node);
+        all_equal = all_equal && dg.Distance(node_id, tree) == dg.Distance(node_id, expected);
+        const std::vector<std::string> path = dg.GetPath(node_id, tree);
+        // Distances never decrease along a shortest path, and each step is an edge of the graph.
+        for (size_t i = 0; i + 1 < path.size(); i++) {
+          const std::vector<std::string> in_neighbors = dg.InNeighbors(path[i + 1]);
+          all_equal = all_equal && dg.Distance(path[i], tree) <= dg.Distance(path[i + 1], tree) &&
+                      std::find(in_neighbors.begin(), in_neighbors.end(), path[i]) != in_neighbors.end();
+        }
+        all_equal = all_equal && path.empty() == (dg.Distance(node_id, expected) < 0);
+      }
+      test_suite.test(all_equal);
+    }
+    test_suite.test(!dg.ParallelWeightedShortestPaths("missing", 5, 2, &tree));
+
+    // Weights up to 1e9 with delta = 1: far more buckets than a worker keeps, and distances past 2^32 buckets along
+    // the chain 0 -> c1 -> ... -> c9.
+    const int kHeavy = 1000000000;
+    std::vector<Edge> heavy_edges = testing::RandomEdges(300, 1500, 47, kHeavy, 1);
+    for (int i = 0; i < 9; i++) {
+      heavy_edges.push_back(Edge(i == 0 ? "0" : "c" + std::to_string(i), "c" + std::to_string(i + 1), kHeavy));
+    }
+    DirectedGraph heavy(heavy_edges);
+    heavy.WeightedShortestPaths("0", &expected);
+    for (const int64_t delta : {1, 1000, 0}) {
+      bool all_equal = heavy.ParallelWeightedShortestPaths("0", delta, &pool, &tree);
+      for (int node = 0; node < 300; node++) {
+        all_equal = all_equal && heavy.Distance(std::to_string(node), tree) == heavy.Distance(std::to_string(node), expected);
+      }
+      test_suite.test(all_equal && heavy.Distance("c9", tree) == 9LL * kHeavy);
+    }
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test a graph saved to a snapshot and mapped back answers queries over out-edges and in-edges like the original.
+  */
+  void TestSnapshot(testing::Testing& test_suite) {
+    test_suite.init("save and load a mapped snapshot");
+    const std::string kPath = "directed_graph_test_snapshot.bin";
+    const int kNodes = 400;
+    DirectedGraph dg(testing::RandomEdges(kNodes, 1200, 41, 24, 0));
+    test_suite.test(dg.Save(kPath));
+
+    DirectedGraph mapped;
+    test_suite.test(mapped.LoadMapped(kPath));
+    test_suite.test(mapped.V() == dg.V() && mapped.E() == dg.E());
+    PathTree expected, tree;
+    dg.WeightedShortestPaths("0", &expected);
+    bool all_equal = mapped.WeightedShortestPaths("0", &tree);
+    mapped.BuildReachabilityIndex(2);
+    for (int node = 0; node < kNodes; node++) {
+      const std::string node_id = std::to_string(node);
+      all_equal = all_equal && mapped.Distance(node_id, tree) == dg.Distance(node_id, expected);
+      all_equal = all_equal && mapped.InNeighbors(node_id) == dg.InNeighbors(node_id);
+      all_equal = all_equal && mapped.ShortestPath("5", node_id).size() == dg.ShortestPath("5", node_id).size();
+      all_equal = all_equal && mapped.DoesPathExist(node_id, "7") == dg.DoesPathExist(node_id, "7");
+    }
+    test_suite.test(all_equal);
+    test_suite.test(!mapped.AddEdge(Edge("0", "1", 1)) && !mapped.AddVertex(Node("new")) && mapped.E() == dg.E());
+
+    // Only an empty graph can be loaded, and from an existing file.
+    test_suite.test(!dg.LoadMapped(kPath));
+    std::remove(kPath.c_str());
+    test_suite.test(!DirectedGraph().LoadMapped(kPath));
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test an edge list loaded in chunks keeps the direction and order of its edges.
+  */
+  void TestLoadEdgeList(testing::Testing& test_suite) {
+    test_suite.init("load a text edge list");
+    const std::string kPath = "directed_graph_test_edges.txt";
+    const int kNodes = 1000;
+    const std::vector<Edge> edges = testing::RandomEdges(kNodes, 5000, 5, 49, 0);
+    {
+      std::ofstream out(kPath);
+      out << "c DIMACS style header\np sp " << kNodes << " " << edges.size() << "\nc graph.gr\nc note 5\n";
+      for (const Edge& edge : edges) {
+        out << edge.from() << " " << edge.to() << " " << edge.weight() << "\n";
+      }
+    }
+    DirectedGraph expected(edges), dg;
+    ThreadPool pool(4);
+    EdgeListStats stats;
+    test_suite.test(dg.LoadEdgeList(kPath, 1000, &pool, &stats));
+    test_suite.test(dg.V() == expected.V() && dg.E() == expected.E() && stats.skipped_lines == 0 && stats.dimacs);
+    bool all_equal = true;
+    for (int node = 0; node < kNodes; node++) {
+      const std::string node_id = std::to_string(node);
+      all_equal = all_equal && dg.InNeighbors(node_id) == expected.InNeighbors(node_id);
+    }
+    test_suite.test(all_equal);
+    test_suite.test(dg.WeightedShortestPath("0", "999", nullptr) == expected.WeightedShortestPath("0", "999", nullptr));
+    std::remove(kPath.c_str());
+    test_suite.TestResults();
+  }
+
+  /**
+  * Test one BFS path tree answers paths to many targets like separate shortest path searches.
+  */
+  void TestTraversalPathTrees(testing::Testing& test_suite) {
+    test_suite.init("path trees of BFS and DFS");
+    DirectedGraph dg({Edge("A", "B", 1), Edge("B", "C", 1), Edge("C", "D", 1), Edge("A", "C", 1), Edge("E", "A", 1)});
+    PathTree bfs_tree, dfs_tree;
+    dg.BFS("A", &bfs_tree);
+    dg.DFS("A", &dfs_tree);
+    dg.BFS("E");
+    const std::vector<std::vector<std::string>> paths = dg.GetPaths({"D", "E", "A", "C"}, bfs_tree);
+    test_suite.test(paths.size() == 4);
+    test_suite.test(testing::ComparePaths(paths[0], {"A", "C", "D"}) && paths[1].empty());
+    test_suite.test(testing::ComparePaths(paths[2], {"A"}) && testing::ComparePaths(paths[3], {"A", "C"}));
+    test_suite.test(dg.Distance("D", bfs_tree) == 2 && dg.Distance("E", bfs_tree) == -1);
+    test_suite.test(testing::ComparePaths(dg.GetPath("D", dfs_tree), {"A", "B", "C", "D"}) && dg.Distance("D", dfs_tree) == 3);
+    test_suite.TestResults();
+  }
+
+  /**
+   * Test that const queries from several threads, each with its own contexts, give the sequential answers, both by
+   * search and from the reachability index.
+   */
+  void TestConcurrentQueries(testing::Testing& test_suite) {
+    test_suite.init("concurrent const queries with per-thread contexts");
+    const int kNodes = 300, kThreads = 4;
+    const std::vector<Edge> edges = testing::RandomEdges(kNodes, 450, 83);
+    DirectedGraph expected_dg(edges), dg(edges);
+    std::vector<std::vector<bool>> expected(kNodes, std::vector<bool>(kNodes));
+    std::vector<size_t> expected_lengths(kNodes);
+    for (int from = 0; from < kNodes; from++) {
+      expected_dg.BFS(std::to_string(from));
+      for (int to = 0; to < kNodes; to++) {
+        expected[from][to] = expected_dg.DoesPathExist(std::to_string(to));
+      }
+      expected_lengths[from] = expected_dg.ShortestPath("0", std::to_string(from)).size();
+    }
+
+    bool all_valid = true;
+    for (const bool indexed : {false, true}) {
+      if (indexed) dg.BuildReachabilityIndex(2);
+      std::vector<int> valid(kThreads, 1);
+      std::vector<std::thread> threads;
+      for (int t = 0; t < kThreads; t++) {
+        threads.push_back(std::thread([&, t]() {
+          TraversalContext source_context, target_context;
+          const DirectedGraph& queried = dg;
+          for (int from = t; from < kNodes; from += kThreads) {
+            for (int to = 0; to < kNodes; to += 7) {
+              valid[t] = valid[t] && queried.DoesPathExist(std::to_string(from), std::to_string(to), &source_context) == expected[from][to];
+            }
+            valid[t] = valid[t] && queried.ShortestPath("0", std::to_string(from), &source_context, &target_context).size() == expected_lengths[from];
+          }
+        }));
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      all_valid = all_valid && std::count(valid.begin(), valid.end(), 1) == kThreads;
+    }
+    test_suite.test(all_valid);
+    // Every query between two vertices of the graph was counted once, whichever thread made it.
+    uint64_t indexed_queries = 0;
+    for (int from = 0; from < kNodes; from++) {
+      for (int to = 0; to < kNodes; to += 7) {
+        indexed_queries += expected[from][from] && expected[to][to];
+      }
+    }
+    test_suite.test(dg.reachability_index().queries() == indexed_queries);
+    test_suite.TestResults();
+  }
+
+  /**
+   * Test that readers of a versioned graph see every published version whole while a writer publishes new ones, that
+   * a pinned version does not change, also when the overlay is compacted or a large batch rebuilds the base, and that
+   * it is freed once nothing pins it.
+   */
+  void TestVersionedGraph(testing::Testing& test_suite) {
+    test_suite.init("versioned graph with concurrent readers");
+    typedef VersionedGraph<DirectedGraph>::Version Version;
+    const int kBatches = 30, kBatchEdges = 20;
+    VersionedGraph<DirectedGraph> versioned({Edge("0", "1", 1)});
+    uint64_t first_version = 1;
+    std::shared_ptr<const Version> first = versioned.Pin(&first_version);
+
+    // Batch b extends the chain 0 -> 1 -> ... by kBatchEdges edges, so version n has exactly n * kBatchEdges + 1 edges
+    // and reaches vertex n * kBatchEdges + 1 from 0.
+    std::thread writer([&]() {
+      for (int batch = 0; batch < kBatches; batch++) {
+        for (int i = 1; i <= kBatchEdges; i++) {
+          const int from = batch * kBatchEdges + i;
+          versioned.AddEdge(Edge(std::to_string(from), std::to_string(from + 1), 1));
+        }
+        versioned.Publish();
+        if (batch == kBatches / 2) {
+          versioned.Compact();
+        }
+      }
+    });
+    std::vector<int> consistent(2, 1);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; r++) {
+      readers.push_back(std::thread([&, r]() {
+        TraversalContext context, target_context;
+        uint64_t version = 0;
+        while (version < kBatches) {
+          const std::shared_ptr<const Version> pinned = versioned.Pin(&version);
+          const int last = static_cast<int>(version) * kBatchEdges + 1;
+          consistent[r] = consistent[r] && pinned->E() == last && pinned->V() == last + 1 &&
+                          pinned->DoesPathExist("0", std::to_string(last), &context) &&
+                          !pinned->DoesPathExist("0", std::to_string(last + 1), &context) &&
+                          static_cast<int>(pinned->ShortestPath("0", std::to_string(last), &context, &target_context).size()) == last + 1;
+        }
+      }));
+    }
+    writer.join();
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    test_suite.test(consistent[0] && consistent[1] && versioned.version() == kBatches && versioned.compactions() == 1);
+    test_suite.test(first_version == 0 && first->E() == 1 && versioned.Publish() == kBatches);
+
+    // Compacting keeps the version number and the graph, and leaves pinned versions as they were.
+    const int last = kBatches * kBatchEdges + 1;
+    const std::shared_ptr<const Version> before = versioned.Pin();
+    versioned.Compact();
+    const std::shared_ptr<const Version> after = versioned.Pin();
+    TraversalContext context;
+    test_suite.test(before->base().E() < last && after->base().E() == last && after->number() == kBatches &&
+                    before->E() == last && after->E() == last && before->DoesPathExist("0", std::to_string(last), &context) &&
+                    after->DoesPathExist("0", std::to_string(last), &context) &&
+                    after->Neighbors(std::to_string(last - 1)) == std::vector<std::string>{std::to_string(last)} &&
+                    !after->HasVertex(std::to_string(last + 1)));
+
+    // A batch larger than the overlay has room for is folded into a new base by Publish() itself.
+    const int kLargeBatch = 5000;
+    for (int i = 0; i < kLargeBatch; i++) {
+      versioned.AddEdge(Edge(std::to_string(last + i), std::to_string(last + i + 1), 1));
+    }
+    versioned.AddVertex(Node("isolated"));
+    test_suite.test(versioned.pending() == kLargeBatch + 1 && versioned.Publish() == kBatches + 1 &&
+                    versioned.Pin()->base().E() == last + kLargeBatch && versioned.Pin()->HasVertex("isolated") &&
+                    versioned.Pin()->DoesPathExist("0", std::to_string(last + kLargeBatch), &context) &&
+                    after->E() == last && !after->HasVertex("isolated"));
+
+    // A small batch goes into the overlay, on the base the previous version shares.
+    const std::shared_ptr<const Version> rebased = versioned.Pin();
+    versioned.AddEdge(Edge("isolated", "0", 1));
+    test_suite.test(versioned.Publish() == kBatches + 2 && &versioned.Pin()->base() == &rebased->base() &&
+                    versioned.Pin()->DoesPathExist("isolated", std::to_string(last), &context) &&
+                    !rebased->DoesPathExist("isolated", "0", &context));
+
+    std::weak_ptr<const Version> released = first;
+    first.reset();
+    test_suite.test(released.expired() && versioned.Pin()->E() == last + kLargeBatch + 1);
+    test_suite.TestResults();
+  }
+
+  /**
+   * Test that readers querying a versioned graph during ingest, while its overlay is folded into new bases, see each
+   * version whole and get the answers of a graph rebuilt from the same edges. Latencies are reported by
+   * directed_graph_benchmark instead.
+   */
+  void TestVersionedGraphUnderIngest(testing::Testing& test_suite) {
+    test_suite.init("versioned graph queries during ingest");
+    const int kNodes = 5000, kEdges = 20000, kBatches = 60, kBatchEdges = 300, kQueries = 20;
+    const std::vector<Edge> edges = testing::RandomEdges(kNodes, kEdges, 3);
+    VersionedGraph<DirectedGraph> versioned(edges);
+    const std::vector<Edge> queries = testing::RandomEdges(kNodes, kQueries, 4);
+    std::vector<std::vector<Edge>> batches;
+    for (int batch = 0; batch < kBatches; batch++) {
+      batches.push_back(testing::RandomEdges(kNodes, kBatchEdges, 100 + batch));
+    }
+
+    // The batches fill the room of the overlay several times over, so it is folded into new bases during ingest.
+    std::atomic<bool> ingesting(true);
+    std::thread writer([&]() {
+      for (int batch = 0; batch < kBatches; batch++) {
+        for (const Edge& edge : batches[batch]) {
+          versioned.AddEdge(edge);
+        }
+        versioned.Publish();
+      }
+      ingesting = false;
+    });
+    // Shortest path lengths of the queries, by the version they were answered on; a path of length 0 means none.
+    std::vector<std::vector<size_t>> answers(kBatches + 1);
+    bool whole = true;
+    TraversalContext source_context, target_context;
+    while (ingesting) {
+      uint64_t version = 0;
+      const std::shared_ptr<const VersionedGraph<DirectedGraph>::Version> pinned = versioned.Pin(&version);
+      whole = whole && pinned->E() == kEdges + static_cast<int>(version) * kBatchEdges;
+      if (answers[version].empty()) {
+        for (const Edge& query : queries) {
+          const size_t length = pinned->ShortestPath(query.from(), query.to(), &source_context, &target_context).size();
+          whole = whole && pinned->DoesPathExist(query.from(), query.to(), &source_context) == (length > 0);
+          answers[version].push_back(length);
+        }
+      }
+    }
+    writer.join();
+    test_suite.test(whole && versioned.version() == kBatches);
+
+    // Every version a reader saw, and the last one, answer like a graph of its edges built from scratch.
+    const std::shared_ptr<const VersionedGraph<DirectedGraph>::Version> last = versioned.Pin();
+    answers[kBatches].clear();
+    for (const Edge& query : queries) {
+      answers[kBatches].push_back(last->ShortestPath(query.from(), query.to(), &source_context, &target_context).size());
+    }
+    bool same = true;
+    for (int version = 0; version <= kBatches; version++) {
+      if (answers[version].empty()) continue;
+      DirectedGraph expected_graph(edges);
+      for (int batch = 0; batch < version; batch++) {
+        for (const Edge& edge : batches[batch]) expected_graph.AddEdge(edge);
+      }
+      for (int q = 0; q < kQueries; q++) {
+        same = same && expected_graph.ShortestPath(queries[q].from(), queries[q].to()).size() == answers[version][q];
+      }
+    }
+    test_suite.test(same && last->E() == kEdges + kBatches * kBatchEdges);
+    test_suite.TestResults();
+  }
+
 }  // namespace directed_graph
 
 int main () {
@@ -91,6 +636,20 @@ int main () {
   directed_graph::TestGraphCreationWithEdges(test_suite);
   directed_graph::TestPathCreationForNodesWithDFS(test_suite);
   directed_graph::TestPathCreationForNodesWithBFS(test_suite);
+  directed_graph::TestInNeighbors(test_suite);
+  directed_graph::TestPathExistsWithContext(test_suite);
+  directed_graph::TestParallelBFS(test_suite);
+  directed_graph::TestBatchPathExists(test_suite);
+  directed_graph::TestReachabilityIndex(test_suite);
+  directed_graph::TestShortestPath(test_suite);
+  directed_graph::TestWeightedShortestPaths(test_suite);
+  directed_graph::TestParallelWeightedShortestPaths(test_suite);
+  directed_graph::TestSnapshot(test_suite);
+  directed_graph::TestLoadEdgeList(test_suite);
+  directed_graph::TestTraversalPathTrees(test_suite);
+  directed_graph::TestConcurrentQueries(test_suite);
+  directed_graph::TestVersionedGraph(test_suite);
+  directed_graph::TestVersionedGraphUnderIngest(test_suite);
 
   test_suite.PrintStats();
 }
@@ -0,0 +1,88 @@
+#include "strongly_connected_components.h"
+#include "../parallel_strong_components.h"
+#include "../strong_components.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace directed_graph {
+
+	uint32_t StronglyConnectedComponents::TarjanComponents(TraversalContext* context, std::vector<uint32_t>* labels) const {
+		EnsureFrozen();
+		return ::TarjanComponents(forward_, context, labels);
+	}
+
+	uint32_t StronglyConnectedComponents::ParallelComponents(ThreadPool* pool, std::vector<uint32_t>* labels) const {
+		EnsureFrozen();
+		return ParallelStrongComponents(forward_, reverse_, pool, labels);
+	}
+
+	std::unordered_map<std::string, int> StronglyConnectedComponents::GetStronglyConnectedComponents() {
+		return GetStronglyConnectedComponents(&context_);
+	}
+
+	std::unordered_map<std::string, int> StronglyConnectedComponents::GetStronglyConnectedComponents(TraversalContext* context) const {
+		std::vector<uint32_t> labels;
+		TarjanComponents(context, &labels);
+		return ComponentMarkers(labels);
+	}
+
+	std::unordered_map<std::string, int> StronglyConnectedComponents::ParallelStronglyConnectedComponents(int num_threads) const {
+		ThreadPool pool(num_threads);
+		std::vector<uint32_t> labels;
+		ParallelComponents(&pool, &labels);
+		return ComponentMarkers(labels);
+	}
+
+	std::unordered_map<std::string, int> StronglyConnectedComponents::ComponentMarkers(const std::vector<uint32_t>& labels) const {
+		std::unordered_map<std::string, int> marker;
+		marker.reserve(labels.size());
+		for (uint32_t node = 0; node < labels.size(); node++) {
+			marker.insert({index_.Id(node), static_cast<int>(labels[node])});
+		}
+		return marker;
+	}
+
+	std::unique_ptr<DirectedGraph> StronglyConnectedComponents::Condensation(const std::vector<uint32_t>& labels) const {
+		EnsureFrozen();
+		if (labels.size() != index_.size()) {
+			std::cout << "Labels cover " << labels.size() << " of " << index_.size() << " nodes" << std::endl;
+			return nullptr;
+		}
+		const uint32_t count = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end()) + 1;
+		// Every edge between two components as (from, to, weight); sorted, the least weight of a pair comes first.
+		std::vector<std::tuple<uint32_t, uint32_t, int>> component_edges;
+		for (uint32_t node = 0; node < index_.size(); node++) {
+			const int* weight = forward_.weight_begin(node);
+			for (const uint32_t* neighbor = forward_.begin(node); neighbor != forward_.end(node); neighbor++, weight++) {
+				if (labels[node] != labels[*neighbor]) {
+					component_edges.emplace_back(labels[node], labels[*neighbor], *weight);
+				}
+			}
+		}
+		std::sort(component_edges.begin(), component_edges.end());
+
+		std::vector<Node> components;
+		components.reserve(count);
+		for (uint32_t component = 0; component < count; component++) {
+			components.push_back(Node(std::to_string(component)));
+		}
+		std::unique_ptr<DirectedGraph> condensation(new DirectedGraph(components));
+		for (size_t i = 0; i < component_edges.size(); i++) {
+			if (i > 0 && std::get<0>(component_edges[i]) == std::get<0>(component_edges[i - 1]) &&
+			    std::get<1>(component_edges[i]) == std::get<1>(component_edges[i - 1])) {
+				continue;
+			}
+			condensation->AddEdge(Edge(components[std::get<0>(component_edges[i])].Id(),
+			                           components[std::get<1>(component_edges[i])].Id(), std::get<2>(component_edges[i])));
+		}
+		return condensation;
+	}
+
+	void StronglyConnectedComponents::PrintComponents(const std::unordered_map<std::string, int>& marker) const {
+		for (const auto& node : marker) {
+			std::cout << node.first << ": " << node.second << std::endl;
+		}
+	}
+
+}  // namespace directed_graph
@@ -0,0 +1,47 @@
+#ifndef STRONGLY_CONNECTED_COMPONENTS_H_
+#define STRONGLY_CONNECTED_COMPONENTS_H_
+
+#include "directed_graph.h"
+
+namespace directed_graph {
+	class StronglyConnectedComponents : public DirectedGraph {
+	public:
+		StronglyConnectedComponents() : DirectedGraph() {}
+
+		StronglyConnectedComponents(const std::vector<Node>& vertices) : DirectedGraph(vertices) {}
+
+		StronglyConnectedComponents(const std::vector<Edge>& edges) : DirectedGraph(edges) {}
+
+		// Labels every node with its strongly connected component using Tarjan's algorithm on an explicit stack, so
+		// deep graphs do not overflow the call stack. labels is indexed by dense id and holds component ids
+		// 0..count-1, in reverse topological order of the condensation (every edge between two components goes from
+		// a higher id to a lower one); returns count. Runs on one thread in O(V + E).
+		uint32_t TarjanComponents(TraversalContext* context, std::vector<uint32_t>* labels) const;
+
+		// Same labels up to renumbering with the parallel forward-backward and coloring algorithm of
+		// parallel_strong_components.h, for large graphs with a giant component. The ids follow no order.
+		uint32_t ParallelComponents(ThreadPool* pool, std::vector<uint32_t>* labels) const;
+
+		// Finds strongly connected components with TarjanComponents and returns the id->component map.
+		std::unordered_map<std::string, int> GetStronglyConnectedComponents();
+		std::unordered_map<std::string, int> GetStronglyConnectedComponents(TraversalContext* context) const;
+
+		// Same map computed with ParallelComponents on num_threads threads (one per hardware thread if not positive).
+		std::unordered_map<std::string, int> ParallelStronglyConnectedComponents(int num_threads) const;
+
+		// Converts labels indexed by dense id into the id->component map.
+		std::unordered_map<std::string, int> ComponentMarkers(const std::vector<uint32_t>& labels) const;
+
+		// Condensation of the graph: a DAG with one node per component, named by its id in labels, and one edge
+		// between two components for every pair joined by an edge, weighted with the least weight among those edges.
+		// labels must come from TarjanComponents or ParallelComponents after the last change to the graph; returns
+		// null, printing a message, if it does not cover every node.
+		std::unique_ptr<DirectedGraph> Condensation(const std::vector<uint32_t>& labels) const;
+
+		// Prints every node with its component.
+		void PrintComponents(const std::unordered_map<std::string, int>& marker) const;
+	};
+
+}  // namespace directed_graph
+
+#endif /* STRONGLY_CONNECTED_COMPONENTS_H_ */
@@ -0,0 +1,159 @@
+#include "strongly_connected_components.h"
+#include "../test_utils.h"
+
+#include <random>
+
+namespace directed_graph {
+
+// The tinyDG.txt digraph of Algorithms, 4th edition: components {0, 2, 3, 4, 5}, {1}, {6, 8}, {7} and {9, 10, 11, 12}.
+std::vector<Edge> TinyDigraph() {
+	const int kEdges[][3] = {{4, 2, 1}, {2, 3, 1}, {3, 2, 1}, {6, 0, 2}, {0, 1, 1}, {2, 0, 1}, {11, 12, 1}, {12, 9, 1},
+	                         {9, 10, 1}, {9, 11, 1}, {7, 9, 1}, {10, 12, 1}, {11, 4, 3}, {4, 3, 1}, {3, 5, 1}, {6, 8, 1},
+	                         {8, 6, 1}, {5, 4, 1}, {0, 5, 1}, {6, 4, 5}, {6, 9, 1}, {7, 6, 1}};
+	std::vector<Edge> edges;
+	for (const auto& edge : kEdges) {
+		edges.push_back(Edge(std::to_string(edge[0]), std::to_string(edge[1]), edge[2]));
+	}
+	return edges;
+}
+
+// Whether the two labelings partition the nodes the same way.
+bool SamePartition(const std::vector<uint32_t>& labels, const std::vector<uint32_t>& other_labels, uint32_t count) {
+	if (labels.size() != other_labels.size()) {
+		return false;
+	}
+	std::vector<uint32_t> to_other(count, kNoVertex), from_other(count, kNoVertex);
+	for (size_t node = 0; node < labels.size(); node++) {
+		if (labels[node] >= count || other_labels[node] >= count) {
+			return false;
+		}
+		if (to_other[labels[node]] == kNoVertex && from_other[other_labels[node]] == kNoVertex) {
+			to_other[labels[node]] = other_labels[node];
+			from_other[other_labels[node]] = labels[node];
+		}
+		if (to_other[labels[node]] != other_labels[node] || from_other[other_labels[node]] != labels[node]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestTarjanComponents(testing::Testing& test_suite) {
+	test_suite.init("test strongly connected components with Tarjan's algorithm");
+	StronglyConnectedComponents dg(TinyDigraph());
+	dg.AddVertex(Node("13"));
+	auto scc = dg.GetStronglyConnectedComponents();
+	test_suite.test(scc.size() == 14);
+	test_suite.test(scc["0"] == scc["2"] && scc["0"] == scc["3"] && scc["0"] == scc["4"] && scc["0"] == scc["5"]);
+	test_suite.test(scc["6"] == scc["8"] && scc["6"] != scc["7"]);
+	test_suite.test(scc["9"] == scc["10"] && scc["9"] == scc["11"] && scc["9"] == scc["12"]);
+	test_suite.test(scc["1"] != scc["0"] && scc["9"] != scc["0"] && scc["6"] != scc["9"] && scc["13"] != scc["1"]);
+	// Reverse topological order: components reached from others get lower ids.
+	test_suite.test(scc["1"] < scc["0"] && scc["0"] < scc["9"] && scc["9"] < scc["6"] && scc["6"] < scc["7"]);
+	TraversalContext context;
+	std::vector<uint32_t> labels;
+	test_suite.test(dg.TarjanComponents(&context, &labels) == 6);
+	test_suite.test(dg.ComponentMarkers(labels) == scc);
+	dg.PrintComponents(scc);
+	test_suite.TestResults();
+}
+
+void TestParallelComponentsAgainstTarjan(testing::Testing& test_suite) {
+	test_suite.init("test parallel strongly connected components against Tarjan's algorithm");
+	std::mt19937 generator(8675309);
+	ThreadPool pool(4);
+	TraversalContext context;
+	// From mostly trivial components to one giant component, with self loops and repeated edges left in.
+	const int kNodes = 3000;
+	for (const int edges_per_node : {0, 1, 2, 4}) {
+		std::uniform_int_distribution<int> node(0, kNodes - 1);
+		std::vector<Edge> edges;
+		for (int i = 0; i < kNodes * edges_per_node; i++) {
+			edges.push_back(Edge(std::to_string(node(generator)), std::to_string(node(generator)), 1));
+		}
+		// A few cycles of known length, so that some mid-sized components survive even the densest graph.
+		for (int cycle = 0; cycle < 5; cycle++) {
+			for (int i = 0; i <= cycle; i++) {
+				edges.push_back(Edge("c" + std::to_string(cycle) + "_" + std::to_string(i),
+				                     "c" + std::to_string(cycle) + "_" + std::to_string((i + 1) % (cycle + 1)), 1));
+			}
+		}
+		std::vector<Node> vertices;
+		for (int i = 0; i < kNodes; i++) {
+			vertices.push_back(Node(std::to_string(i)));
+		}
+		StronglyConnectedComponents dg(vertices);
+		for (const Edge& edge : edges) {
+			dg.AddEdge(edge);
+		}
+		std::vector<uint32_t> tarjan_labels, parallel_labels;
+		const uint32_t tarjan_count = dg.TarjanComponents(&context, &tarjan_labels);
+		const uint32_t parallel_count = dg.ParallelComponents(&pool, &parallel_labels);
+		test_suite.test(tarjan_count == parallel_count);
+		test_suite.test(SamePartition(tarjan_labels, parallel_labels, tarjan_count));
+		std::cout << edges_per_node << " edges per node: " << tarjan_count << " components" << std::endl;
+	}
+
+	// A long cycle with tails on both sides, deep enough to overflow a recursive Tarjan.
+	const int kCycle = 200000;
+	std::vector<Edge> edges;
+	for (int i = 0; i < kCycle; i++) {
+		edges.push_back(Edge(std::to_string(i), std::to_string((i + 1) % kCycle), 1));
+		edges.push_back(Edge("in" + std::to_string(i), i == 0 ? "0" : "in" + std::to_string(i - 1), 1));
+		edges.push_back(Edge(i == 0 ? "0" : "out" + std::to_string(i - 1), "out" + std::to_string(i), 1));
+	}
+	StronglyConnectedComponents chain(edges);
+	std::vector<uint32_t> tarjan_labels, parallel_labels;
+	const uint32_t tarjan_count = chain.TarjanComponents(&context, &tarjan_labels);
+	test_suite.test(tarjan_count == 2 * kCycle + 1);
+	test_suite.test(chain.ParallelComponents(&pool, &parallel_labels) == tarjan_count);
+	test_suite.test(SamePartition(tarjan_labels, parallel_labels, tarjan_count));
+	auto small_scc = StronglyConnectedComponents({Edge("A", "B", 1), Edge("B", "A", 1), Edge("B", "C", 1)}).ParallelStronglyConnectedComponents(2);
+	test_suite.test(small_scc.size() == 3 && small_scc["A"] == small_scc["B"] && small_scc["A"] != small_scc["C"]);
+	test_suite.TestResults();
+}
+
+void TestCondensation(testing::Testing& test_suite) {
+	test_suite.init("test condensation of the strongly connected components");
+	StronglyConnectedComponents dg(TinyDigraph());
+	std::vector<uint32_t> labels;
+	TraversalContext context;
+	const uint32_t count = dg.TarjanComponents(&context, &labels);
+	std::unique_ptr<DirectedGraph> condensation = dg.Condensation(labels);
+	test_suite.test(condensation != nullptr);
+	test_suite.test(condensation->V() == static_cast<int>(count) && condensation->V() == 5);
+	test_suite.test(condensation->E() == 6);
+	auto scc = dg.ComponentMarkers(labels);
+	// Tarjan's ids are a reverse topological order, so every edge of the condensation goes to a lower id.
+	for (uint32_t component = 0; component < count; component++) {
+		for (const std::string& from : condensation->InNeighbors(std::to_string(component))) {
+			test_suite.test(std::stoi(from) > static_cast<int>(component));
+		}
+	}
+	// Components {6, 8} and {0, 2, 3, 4, 5} are joined by 6 -> 0 and 6 -> 4 with weights 2 and 5.
+	int64_t distance = 0;
+	condensation->WeightedShortestPath(std::to_string(scc["6"]), std::to_string(scc["0"]), &distance);
+	test_suite.test(distance == 2);
+	test_suite.test(condensation->InDegree(std::to_string(scc["1"])) == 1);
+
+	ThreadPool pool(2);
+	dg.ParallelComponents(&pool, &labels);
+	condensation = dg.Condensation(labels);
+	test_suite.test(condensation->V() == 5 && condensation->E() == 6);
+	labels.pop_back();
+	test_suite.test(dg.Condensation(labels) == nullptr);
+	test_suite.TestResults();
+}
+
+}  // namespace directed_graph
+
+
+int main () {
+  testing::Testing test_suite("TEST SUITE FOR STRONGLY CONNECTED COMPONENTS");
+
+  directed_graph::TestTarjanComponents(test_suite);
+  directed_graph::TestParallelComponentsAgainstTarjan(test_suite);
+  directed_graph::TestCondensation(test_suite);
+
+  test_suite.PrintStats();
+}
@@ -1,84 +1,259 @@
 #include "topological_sort.h"
+#include "../dfs_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
 
 namespace directed_graph {
 
-	bool TopologicalSort::IsCyclic(const std::string& node_id) {
-		visited_.insert(node_id);
-		processing_nodes_.insert(node_id);
-		for (const auto& neighbor_id : adjacency_map_[node_id]) {
-			if (processing_nodes_.find(neighbor_id) != processing_nodes_.end()) {
-				return true;
-			}
-			if (visited_.find(neighbor_id) != visited_.end()) {
+	bool TopologicalSort::IsCyclic() {
+		return IsCyclic(&context_);
+	}
+
+	bool TopologicalSort::IsCyclic(TraversalContext* context) const {
+		if (incremental_order_) {
+			return false;
+		}
+		EnsureFrozen();
+		context->Reset(V_);
+		// A back edge reaches a node on the current DFS path, closing a cycle; it stops the search.
+		const auto no_back_edge = [&](uint32_t, uint32_t to) { return context->done(to); };
+		for (uint32_t node = 0; node < index_.size(); node++) {
+			if (context->visited(node)) {
 				continue;
 			}
-			if (IsCyclic(neighbor_id)) {
+			if (!DepthFirstSearch(forward_, node, context, dfs::Continue(), no_back_edge, dfs::Continue())) {
 				return true;
 			}
 		}
-		processing_nodes_.erase(node_id);
 		return false;
 	}
 
-	bool TopologicalSort::IsCyclic() {
-		visited_.clear();
-		processing_nodes_.clear();
-		for (const auto& node : vertices_) {
-			const std::string& node_id = node.first;
-			if (visited_.find(node_id) != visited_.end()) {
+	std::vector<std::string> TopologicalSort::TopologicallySorted() {
+		return TopologicallySorted(&context_);
+	}
+
+	std::vector<std::string> TopologicalSort::TopologicallySorted(TraversalContext* context) const {
+		if (incremental_order_) {
+			std::vector<std::string> order;
+			order.reserve(order_.size());
+			for (const uint32_t node : order_) {
+				order.push_back(index_.Id(node));
+			}
+			return order;
+		}
+		EnsureFrozen();
+		context->Reset(V_);
+		// Stop at the first back edge: there is no order once a cycle is found.
+		const auto no_back_edge = [&](uint32_t, uint32_t to) { return context->done(to); };
+		std::vector<std::string> order;
+		order.reserve(V_);
+		for (uint32_t node = 0; node < index_.size(); node++) {
+			if (context->visited(node)) {
 				continue;
 			}
-			if (IsCyclic(node_id)) {
-				return true;
+			// Walking the in-edges, a node finishes after everything it depends on.
+			const auto append = [&](uint32_t finished) { order.push_back(index_.Id(finished)); return true; };
+			if (!DepthFirstSearch(reverse_, node, context, dfs::Continue(), no_back_edge, append)) {
+				return {};
 			}
 		}
-		return false;
+		return order;
 	}
 
-	void TopologicalSort::CreateReverseAdjacencyMap() {
-		reverse_adjacency_map_.clear();
-		for (const auto& vertex_edges : adjacency_map_) {
-			const auto& node_id = vertex_edges.first;
-			for (const auto& neighbor_id : vertex_edges.second) {
-				reverse_adjacency_map_[neighbor_id].push_back(node_id);
+	std::vector<std::vector<std::string>> TopologicalSort::TopologicalLevels(ThreadPool* pool) const {
+		EnsureFrozen();
+		const size_t kGrain = 256;
+		const uint32_t num_vertices = index_.size();
+		std::unique_ptr<std::atomic<uint32_t>[]> in_degree(new std::atomic<uint32_t>[num_vertices]);
+		std::vector<std::vector<uint32_t>> worker_nodes(pool->size());
+
+		// order holds the levels one after the other; level i is order[level_begin[i], level_begin[i + 1]).
+		std::vector<uint32_t> order;
+		order.reserve(num_vertices);
+		std::vector<size_t> level_begin(1, 0);
+		pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int worker) {
+			for (size_t node = begin; node < end; node++) {
+				in_degree[node].store(reverse_.Degree(node), std::memory_order_relaxed);
+				if (reverse_.Degree(node) == 0) {
+					worker_nodes[worker].push_back(node);
+				}
 			}
+		});
+		ParallelConcatenate(pool, &worker_nodes, &order);
+		while (order.size() > level_begin.back()) {
+			const size_t begin_level = level_begin.back();
+			level_begin.push_back(order.size());
+			pool->ParallelFor(order.size() - begin_level, kGrain, [&](size_t begin, size_t end, int worker) {
+				for (size_t i = begin_level + begin; i < begin_level + end; i++) {
+					const uint32_t node = order[i];
+					for (const uint32_t* neighbor = forward_.begin(node); neighbor != forward_.end(node); neighbor++) {
+						// The worker that removes the last dependency of a node schedules it.
+						if (in_degree[*neighbor].fetch_sub(1, std::memory_order_relaxed) == 1) {
+							worker_nodes[worker].push_back(*neighbor);
+						}
+					}
+				}
+			});
+			ParallelConcatenate(pool, &worker_nodes, &order);
+		}
+		if (order.size() != num_vertices) {
+			return {};
 		}
-	}
 
-	bool TopologicalSort::TopologicallySorted(const std::string& node_id, std::vector<std::string>* order) {
-		visited_.insert(node_id);
-		processing_nodes_.insert(node_id);
-		for (const auto& neighbor_id : reverse_adjacency_map_[node_id]) {
-			if (processing_nodes_.find(neighbor_id) != processing_nodes_.end()) {
-				return false;
+		std::vector<std::vector<std::string>> levels(level_begin.size() - 1);
+		for (size_t level = 0; level < levels.size(); level++) {
+			levels[level].reserve(level_begin[level + 1] - level_begin[level]);
+			for (size_t i = level_begin[level]; i < level_begin[level + 1]; i++) {
+				levels[level].push_back(index_.Id(order[i]));
 			}
-			if (visited_.find(neighbor_id) != visited_.end()) {
-				continue;
-			}
-			if (!TopologicallySorted(neighbor_id, order)) {
-				return false;
+		}
+		return levels;
+	}
+
+	std::vector<std::vector<std::string>> TopologicalSort::TopologicalLevels(int num_threads) const {
+		ThreadPool pool(num_threads);
+		return TopologicalLevels(&pool);
+	}
+
+	bool TopologicalSort::EnableIncrementalOrder() {
+		if (incremental_order_) {
+			return true;
+		}
+		const std::vector<std::string> order = TopologicallySorted(&order_context_);
+		if (order.size() != index_.size()) {
+			std::cout << "Graph has a cycle, no topological order to keep" << std::endl;
+			return false;
+		}
+		order_.clear();
+		position_.assign(index_.size(), 0);
+		for (const auto& node_id : order) {
+			position_[index_.Find(node_id)] = order_.size();
+			order_.push_back(index_.Find(node_id));
+		}
+		out_edges_.assign(index_.size(), {});
+		in_edges_.assign(index_.size(), {});
+		for (const auto& edge : edge_list_) {
+			out_edges_[edge.first].push_back(edge.second);
+			in_edges_[edge.second].push_back(edge.first);
+		}
+		incremental_order_ = true;
+		return true;
+	}
+
+	void TopologicalSort::ExtendOrder() {
+		for (uint32_t node = order_.size(); node < index_.size(); node++) {
+			position_.push_back(order_.size());
+			order_.push_back(node);
+			out_edges_.emplace_back();
+			in_edges_.emplace_back();
+		}
+	}
+
+	bool TopologicalSort::AddVertex(const Node& n) {
+		if (!DirectedGraph::AddVertex(n)) {
+			return false;
+		}
+		if (incremental_order_) {
+			ExtendOrder();
+		}
+		return true;
+	}
+
+	bool TopologicalSort::CollectAffected(uint32_t node, bool forward, uint32_t lower_position, uint32_t upper_position, uint32_t stop_node, std::vector<uint32_t>* affected) {
+		order_context_.Reset(index_.size());
+		std::vector<uint32_t>& nodes_stack = *order_context_.buffer();
+		order_context_.Visit(node);
+		nodes_stack.push_back(node);
+		while (!nodes_stack.empty()) {
+			const uint32_t curr_node = nodes_stack.back();
+			nodes_stack.pop_back();
+			affected->push_back(curr_node);
+			for (const uint32_t neighbor : forward ? out_edges_[curr_node] : in_edges_[curr_node]) {
+				if (neighbor == stop_node) {
+					return false;
+				}
+				if (order_context_.visited(neighbor) || position_[neighbor] <= lower_position || position_[neighbor] >= upper_position) {
+					continue;
+				}
+				order_context_.Visit(neighbor);
+				nodes_stack.push_back(neighbor);
 			}
 		}
-		processing_nodes_.erase(node_id);
-		order->push_back(node_id);
 		return true;
 	}
 
-	std::vector<std::string> TopologicalSort::TopologicallySorted() {
-		visited_.clear();
-		processing_nodes_.clear();
-		std::vector<std::string> order;
-		CreateReverseAdjacencyMap();
-		for (const auto& vertex : vertices_) {
-			const auto& node_id = vertex.first;
-			if (visited_.find(node_id) != visited_.end()) {
-				continue;
+	bool TopologicalSort::AddEdge(const Edge& edge) {
+		if (!incremental_order_ || snapshot_ != nullptr) {
+			return DirectedGraph::AddEdge(edge);
+		}
+		if (edge.from() == edge.to()) {
+			std::cout << "Edge " << edge.from() << " -> " << edge.to() << " would create a cycle" << std::endl;
+			return false;
+		}
+		// New endpoints go to the end of the order; an edge from a new node can close no cycle.
+		const uint32_t from = index_.Intern(edge.from());
+		const uint32_t to = index_.Intern(edge.to());
+		V_ = index_.size();
+		ExtendOrder();
+		if (position_[from] > position_[to]) {
+			// The edge goes backwards in the order. Nodes reachable from to that come before from must move after
+			// the nodes that reach from and come after to; all other nodes keep their positions.
+			const uint32_t lower_position = position_[to], upper_position = position_[from];
+			std::vector<uint32_t> forward_nodes, backward_nodes;
+			if (!CollectAffected(to, true, lower_position, upper_position, from, &forward_nodes)) {
+				std::cout << "Edge " << edge.from() << " -> " << edge.to() << " would create a cycle" << std::endl;
+				return false;
 			}
-			if (!TopologicallySorted(node_id, &order)) {
-				return {};
+			CollectAffected(from, false, lower_position, upper_position, to, &backward_nodes);
+			auto by_position = [this](uint32_t a, uint32_t b) { return position_[a] < position_[b]; };
+			std::sort(forward_nodes.begin(), forward_nodes.end(), by_position);
+			std::sort(backward_nodes.begin(), backward_nodes.end(), by_position);
+			std::vector<uint32_t> positions;
+			for (const uint32_t node : backward_nodes) positions.push_back(position_[node]);
+			for (const uint32_t node : forward_nodes) positions.push_back(position_[node]);
+			std::sort(positions.begin(), positions.end());
+			backward_nodes.insert(backward_nodes.end(), forward_nodes.begin(), forward_nodes.end());
+			for (size_t i = 0; i < backward_nodes.size(); i++) {
+				order_[positions[i]] = backward_nodes[i];
+				position_[backward_nodes[i]] = positions[i];
 			}
 		}
-		return order;
+		DirectedGraph::AddEdge(edge);
+		out_edges_[edge_list_.back().first].push_back(edge_list_.back().second);
+		in_edges_[edge_list_.back().second].push_back(edge_list_.back().first);
+		return true;
+	}
+
+	bool TopologicalSort::LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats) {
+		if (!DirectedGraph::LoadEdgeList(path, chunk_bytes, pool, stats)) {
+			return false;
+		}
+		if (incremental_order_) {
+			incremental_order_ = false;
+			EnableIncrementalOrder();
+		}
+		return true;
+	}
+
+	bool TopologicalSort::Reorder(VertexOrder order) {
+		if (!DirectedGraph::Reorder(order)) {
+			return false;
+		}
+		if (incremental_order_) {
+			incremental_order_ = false;
+			EnableIncrementalOrder();
+		}
+		return true;
+	}
+
+	int TopologicalSort::Position(const std::string& node_id) const {
+		const uint32_t node = index_.Find(node_id);
+		if (!incremental_order_ || node == kNoVertex) {
+			return -1;
+		}
+		return position_[node];
 	}
 
 	void TopologicalSort::PrintOrder(const std::vector<std::string>& path_nodes) const {
@@ -6,30 +6,73 @@
 namespace directed_graph{
 	class TopologicalSort : public DirectedGraph {
 	private:
-		std::unordered_set<std::string> processing_nodes_;
-		std::unordered_map<std::string, std::vector<std::string>> reverse_adjacency_map_;
+		// Whether AddVertex and AddEdge keep order_ and position_ up to date.
+		bool incremental_order_;
 
-		// Util method for checking if a cycle exists in the graph.
-		bool IsCyclic(const std::string& node_id);
+		// Topological order of the dense ids, and the position of each dense id in it, while incremental_order_ is set.
+		std::vector<uint32_t> order_;
+		std::vector<uint32_t> position_;
 
-		// Revert all the edges in the graph.
-		void CreateReverseAdjacencyMap();
+		// Out-edges and in-edges of each dense id, appended to as edges are added while incremental_order_ is set.
+		std::vector<std::vector<uint32_t>> out_edges_;
+		std::vector<std::vector<uint32_t>> in_edges_;
 
-		// Util method for obtaining topologically sorted list of dependencies.
-		bool TopologicallySorted(const std::string& node_id, std::vector<std::string>* order);
+		// Marks of the searches that keep the incremental order, apart from context_ so that adding an edge leaves
+		// the last DFS or BFS of the caller as it was.
+		TraversalContext order_context_;
+
+		// Append the nodes interned since the last call to the end of the order.
+		void ExtendOrder();
+
+		// Util method for the incremental order: collects in affected the nodes reachable from node along edges
+		// (out-edges if forward, else in-edges) whose positions are strictly between the bounds. Returns false if the
+		// search reaches stop_node.
+		bool CollectAffected(uint32_t node, bool forward, uint32_t lower_position, uint32_t upper_position, uint32_t stop_node, std::vector<uint32_t>* affected);
 
 	public:
-		TopologicalSort() : DirectedGraph() {}
+		TopologicalSort() : DirectedGraph(), incremental_order_(false) {}
+
+		TopologicalSort(const std::vector<Node>& vertices) : DirectedGraph(vertices), incremental_order_(false) {}
+
+		TopologicalSort(const std::vector<Edge>& edges) : DirectedGraph(edges), incremental_order_(false) {}
+
+		// Start keeping a topological order up to date on every AddVertex and AddEdge (Pearce-Kelly): an edge that
+		// agrees with the current order costs O(1), otherwise only the nodes positioned between its endpoints that
+		// are reachable from them are reordered. Returns false, and stays off, if the graph already has a cycle.
+		bool EnableIncrementalOrder();
 
-		TopologicalSort(const std::vector<Node> vertices) : DirectedGraph(vertices) {}
+		// Add vertex to graph, at the end of the order when the incremental order is kept.
+		bool AddVertex(const Node& n) override;
 
-		TopologicalSort(const std::vector<Edge> edges) : DirectedGraph(edges) {}
+		// Add edge to graph. When the incremental order is kept, an edge that would close a cycle is rejected
+		// and false is returned; keeping the order leaves the traversal state of DFS and BFS as it was.
+		bool AddEdge(const Edge& edge) override;
 
-		// Check if a cycle exists in the graph.
+		// Load an edge list like DirectedGraph::LoadEdgeList. A kept incremental order is recomputed from scratch, and
+		// dropped if the loaded edges close a cycle.
+		bool LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats) override;
+		using DirectedGraph::LoadEdgeList;
+
+		// Renumber the nodes like DirectedGraph::Reorder. A kept incremental order is recomputed from scratch.
+		bool Reorder(VertexOrder order) override;
+
+		// Position of the input node in the incrementally kept order, or -1 if the node is not in the graph or the
+		// incremental order is not kept.
+		int Position(const std::string& node_id) const;
+
+		// Check if a cycle exists in the graph. O(1) when the incremental order is kept.
 		bool IsCyclic();
+		bool IsCyclic(TraversalContext* context) const;
 
-		// Give topologically sorted list of dependencies.
+		// Give topologically sorted list of dependencies. Read off the incrementally kept order when there is one.
 		std::vector<std::string> TopologicallySorted();
+		std::vector<std::string> TopologicallySorted(TraversalContext* context) const;
+
+		// Give topologically sorted dependencies grouped into levels (wavefronts) with Kahn's algorithm: every node is in
+		// the level after its latest dependency, so the nodes of a level can run at the same time. Each level is
+		// expanded across the workers of pool with atomic in-degree decrements. Empty if the graph has a cycle.
+		std::vector<std::vector<std::string>> TopologicalLevels(ThreadPool* pool) const;
+		std::vector<std::vector<std::string>> TopologicalLevels(int num_threads) const;
 
 		// Print the order obtained in input of path of nodes.
 		void PrintOrder(const std::vector<std::string>& path_nodes) const;
@@ -1,6 +1,9 @@
 #include "topological_sort.h"
 #include "../test_utils.h"
 
+#include <cstdio>
+#include <fstream>
+
 namespace directed_graph {
 
 void TestCycleInGraph(testing::Testing& test_suite) {
@@ -42,6 +45,210 @@ void TestTopologicalSorting(testing::Testing& test_suite) {
 	test_suite.TestResults();
 }
 
+void TestRepeatedTopologicalSorting(testing::Testing& test_suite) {
+	test_suite.init("test repeated topological sorting while adding edges");
+	Node a("A"), b("B"), c("C");
+	Edge e1(a.Id(), b.Id(), 1), e2(b.Id(), c.Id(), 1), e3(c.Id(), a.Id(), 1);
+	TopologicalSort dg({e1, e2});
+	test_suite.test(testing::ComparePaths(dg.TopologicallySorted(), {"A", "B", "C"}));
+	test_suite.test(testing::ComparePaths(dg.TopologicallySorted(), {"A", "B", "C"}));
+	dg.AddEdge(e3);
+	test_suite.test(dg.IsCyclic());
+	test_suite.test(dg.TopologicallySorted().empty());
+	test_suite.TestResults();
+}
+
+void TestTopologicalLevels(testing::Testing& test_suite) {
+	test_suite.init("test topological levels in graph");
+	Node a("A"), b("B"), c("C"), d("D"), e("E"), f("F"), g("G");
+	Edge e1(a.Id(), b.Id(), 1), e2(a.Id(), c.Id(), 1), e3(b.Id(), d.Id(), 1), e4(c.Id(), d.Id(), 1), e5(d.Id(), f.Id(), 1), e6(e.Id(), f.Id(), 1), e7(f.Id(), g.Id(), 1), e8(a.Id(), g.Id(), 1);
+	TopologicalSort dg({e1, e2, e3, e4, e5, e6, e7, e8});
+	const std::vector<std::vector<std::string>> levels = dg.TopologicalLevels(4);
+	test_suite.test(levels.size() == 5);
+	std::unordered_map<std::string, int> node_levels;
+	for (size_t level = 0; level < levels.size(); level++) {
+		for (const auto& node_id : levels[level]) {
+			node_levels[node_id] = level;
+		}
+		dg.PrintOrder(levels[level]);
+	}
+	test_suite.test(node_levels.size() == 7);
+	test_suite.test(node_levels["A"] == 0 && node_levels["E"] == 0);
+	test_suite.test(node_levels["B"] == 1 && node_levels["C"] == 1);
+	test_suite.test(node_levels["D"] == 2);
+	test_suite.test(node_levels["F"] == 3);
+	test_suite.test(node_levels["G"] == 4);
+
+	// A long layered graph, where every node of a layer depends on two nodes of the layer before.
+	std::vector<Edge> edges;
+	const int kLayers = 50, kWidth = 40;
+	for (int layer = 1; layer < kLayers; layer++) {
+		for (int i = 0; i < kWidth; i++) {
+			const std::string node_id = std::to_string(layer * kWidth + i);
+			edges.push_back(Edge(std::to_string((layer - 1) * kWidth + i), node_id, 1));
+			edges.push_back(Edge(std::to_string((layer - 1) * kWidth + (i * 7 + 3) % kWidth), node_id, 1));
+		}
+	}
+	TopologicalSort layered(edges);
+	const std::vector<std::vector<std::string>> layered_levels = layered.TopologicalLevels(4);
+	test_suite.test(layered_levels.size() == kLayers);
+	for (size_t layer = 0; layer < layered_levels.size(); layer++) {
+		test_suite.test(layered_levels[layer].size() == kWidth);
+		for (const auto& node_id : layered_levels[layer]) {
+			test_suite.test(static_cast<size_t>(std::stoi(node_id) / kWidth) == layer);
+		}
+	}
+	layered.AddEdge(Edge("0", std::to_string(kLayers * kWidth - 1), 1));
+	test_suite.test(layered.TopologicalLevels(4).size() == kLayers);
+	layered.AddEdge(Edge(std::to_string(kLayers * kWidth - 1), "0", 1));
+	test_suite.test(layered.TopologicalLevels(4).empty());
+	test_suite.TestResults();
+}
+
+void TestIncrementalTopologicalOrder(testing::Testing& test_suite) {
+	test_suite.init("test incremental topological order while adding edges");
+	Node a("A"), b("B"), c("C"), d("D"), e("E");
+	TopologicalSort cyclic({Edge(a.Id(), b.Id(), 1), Edge(b.Id(), a.Id(), 1)});
+	test_suite.test(!cyclic.EnableIncrementalOrder());
+
+	TopologicalSort dg({Edge(a.Id(), b.Id(), 1), Edge(c.Id(), d.Id(), 1)});
+	test_suite.test(dg.EnableIncrementalOrder());
+	test_suite.test(dg.AddEdge(Edge(d.Id(), a.Id(), 1)));
+	test_suite.test(dg.Position(c.Id()) < dg.Position(d.Id()));
+	test_suite.test(dg.Position(d.Id()) < dg.Position(a.Id()));
+	test_suite.test(dg.Position(a.Id()) < dg.Position(b.Id()));
+	test_suite.test(!dg.AddEdge(Edge(b.Id(), c.Id(), 1)));
+	test_suite.test(!dg.AddEdge(Edge(e.Id(), e.Id(), 1)));
+	test_suite.test(dg.E() == 3);
+	test_suite.test(dg.AddEdge(Edge(e.Id(), c.Id(), 1)));
+	test_suite.test(dg.Position(e.Id()) < dg.Position(c.Id()));
+	test_suite.test(!dg.IsCyclic());
+	dg.PrintOrder(dg.TopologicallySorted());
+
+	// Random inserts into a graph of 200 nodes, rejecting the ones that close a cycle; the kept order must respect
+	// every accepted edge, and a rejected edge must really close a cycle.
+	TopologicalSort random_dg;
+	const int kNodes = 200;
+	for (int node = 0; node < kNodes; node++) {
+		random_dg.AddVertex(Node(std::to_string(node)));
+	}
+	random_dg.EnableIncrementalOrder();
+	std::vector<std::pair<std::string, std::string>> accepted;
+	for (const Edge& edge : testing::RandomEdges(kNodes, 600, 12345)) {
+		if (random_dg.AddEdge(edge)) {
+			accepted.push_back({edge.from(), edge.to()});
+		} else {
+			test_suite.test(edge.from() == edge.to() || random_dg.DoesPathExist(edge.to(), edge.from()));
+		}
+	}
+	for (const auto& edge : accepted) {
+		test_suite.test(random_dg.Position(edge.first) < random_dg.Position(edge.second));
+	}
+	TopologicalSort check_dg;
+	for (const auto& edge : accepted) {
+		check_dg.AddEdge(Edge(edge.first, edge.second, 1));
+	}
+	test_suite.test(!check_dg.IsCyclic());
+	test_suite.TestResults();
+}
+
+void TestIncrementalOrderKeepsTraversal(testing::Testing& test_suite) {
+	test_suite.init("test incremental order leaves the last traversal as it was");
+	TopologicalSort dg({Edge("A", "B", 1), Edge("C", "D", 1)});
+	dg.DFS("C");
+	const std::vector<std::string> path = dg.GetPath("D");
+	test_suite.test(dg.EnableIncrementalOrder() && dg.GetPath("D") == path);
+	// D -> A goes backwards in the order, so keeping it searches from both ends.
+	test_suite.test(dg.Position("A") < dg.Position("D") && dg.AddEdge(Edge("D", "A", 1)));
+	test_suite.test(dg.Position("D") < dg.Position("A"));
+	test_suite.test(path == std::vector<std::string>{"C", "D"} && dg.GetPath("D") == path);
+	test_suite.test(dg.DoesPathExist("C") && !dg.DoesPathExist("A") && !dg.DoesPathExist("B"));
+	test_suite.TestResults();
+}
+
+void TestDeepChainTopologicalSorting(testing::Testing& test_suite) {
+	test_suite.init("test cycle check and sorting on a chain of 300000 nodes");
+	const int kLength = 300000;
+	std::vector<Edge> edges;
+	for (int node = 0; node + 1 < kLength; node++) {
+		edges.push_back(Edge(std::to_string(node), std::to_string(node + 1), 1));
+	}
+	TopologicalSort dg(edges);
+	test_suite.test(!dg.IsCyclic());
+	const std::vector<std::string> order = dg.TopologicallySorted();
+	test_suite.test(order.size() == kLength);
+	test_suite.test(!order.empty() && order.front() == "0" && order.back() == std::to_string(kLength - 1));
+	dg.AddEdge(Edge(std::to_string(kLength - 1), "0", 1));
+	test_suite.test(dg.IsCyclic());
+	test_suite.test(dg.TopologicallySorted().empty());
+	test_suite.TestResults();
+}
+
+void TestLoadedTopologicalOrder(testing::Testing& test_suite) {
+	test_suite.init("test incremental order kept across loading edge lists");
+	const std::string kPath = "topological_sort_test_edges.txt";
+	{
+		std::ofstream out(kPath);
+		out << "shirt tie\ntie jacket\ntrousers shoes\nsocks shoes\n";
+	}
+	TopologicalSort dg({Edge("undershorts", "trousers", 1), Edge("trousers", "belt", 1)});
+	test_suite.test(dg.EnableIncrementalOrder());
+	test_suite.test(dg.LoadEdgeList(kPath, 2));
+	test_suite.test(dg.Position("shirt") >= 0 && dg.Position("shirt") < dg.Position("tie"));
+	test_suite.test(dg.Position("undershorts") < dg.Position("shoes") && dg.Position("socks") < dg.Position("shoes"));
+	{
+		std::ofstream out(kPath);
+		out << "jacket shirt\n";
+	}
+	test_suite.test(dg.LoadEdgeList(kPath, 2));
+	test_suite.test(dg.Position("shirt") == -1 && dg.IsCyclic());
+	std::remove(kPath.c_str());
+	test_suite.TestResults();
+}
+
+void TestReorderedTopologicalOrder(testing::Testing& test_suite) {
+	test_suite.init("test topological order after reordering the nodes");
+	std::vector<Edge> edges;
+	const int kLayers = 30, kWidth = 20;
+	for (int layer = 1; layer < kLayers; layer++) {
+		for (int i = 0; i < kWidth; i++) {
+			const std::string node_id = std::to_string(layer * kWidth + i);
+			edges.push_back(Edge(std::to_string((layer - 1) * kWidth + (i * 7 + 3) % kWidth), node_id, 1));
+		}
+	}
+	for (const VertexOrder order : {VertexOrder::kDegree, VertexOrder::kReverseCuthillMcKee, VertexOrder::kBreadthFirst, VertexOrder::kGorder}) {
+		TopologicalSort dg(edges);
+		// Reordering drops the traversal run before it, whose marks belong to the old ids.
+		dg.BFS("0");
+		test_suite.test(dg.Reorder(order));
+		bool none_visited = true;
+		for (int node = 0; node < kLayers * kWidth; node++) {
+			none_visited = none_visited && !dg.DoesPathExist(std::to_string(node));
+		}
+		test_suite.test(none_visited);
+		test_suite.test(!dg.IsCyclic());
+		const std::vector<std::string> sorted = dg.TopologicallySorted();
+		std::unordered_map<std::string, int> position;
+		for (size_t i = 0; i < sorted.size(); i++) {
+			position[sorted[i]] = i;
+		}
+		bool ordered = sorted.size() == kLayers * kWidth;
+		for (const Edge& edge : edges) {
+			ordered = ordered && position[edge.from()] < position[edge.to()];
+		}
+		test_suite.test(ordered);
+
+		// A kept incremental order survives the renumbering and keeps rejecting cycles; node kWidth + 11 depends on node 0.
+		TopologicalSort incremental(edges);
+		test_suite.test(incremental.EnableIncrementalOrder());
+		test_suite.test(incremental.Reorder(order));
+		test_suite.test(incremental.Position("0") < incremental.Position(std::to_string(kWidth + 11)));
+		test_suite.test(!incremental.AddEdge(Edge(std::to_string(kWidth + 11), "0", 1)));
+		test_suite.test(incremental.AddEdge(Edge("0", std::to_string(kLayers * kWidth - 1), 1)));
+	}
+	test_suite.TestResults();
+}
+
 }  // namespace directed_graph
 
 
@@ -50,6 +257,13 @@ int main () {
 
   directed_graph::TestCycleInGraph(test_suite);
   directed_graph::TestTopologicalSorting(test_suite);
+  directed_graph::TestRepeatedTopologicalSorting(test_suite);
+  directed_graph::TestTopologicalLevels(test_suite);
+  directed_graph::TestIncrementalTopologicalOrder(test_suite);
+  directed_graph::TestIncrementalOrderKeepsTraversal(test_suite);
+  directed_graph::TestDeepChainTopologicalSorting(test_suite);
+  directed_graph::TestLoadedTopologicalOrder(test_suite);
+  directed_graph::TestReorderedTopologicalOrder(test_suite);
 
   test_suite.PrintStats();
 }
\ No newline at end of file
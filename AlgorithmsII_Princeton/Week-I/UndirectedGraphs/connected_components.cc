@@ -1,28 +1,132 @@
 #include "connected_components.h"
+#include "../dfs_engine.h"
+#include "../parallel_components.h"
 
 namespace graph {
 
-void ConnectedComponents::DFSForConnectedComponents(const std::string& node_id, int marker_id, std::unordered_map<std::string, int> *marker) {
-	visited_.insert(node_id);
-	marker->insert({node_id, marker_id});
-	for (const auto& neighbor_id : adjacency_map_[node_id]) {
-		if (!visited(neighbor_id)) {
-			DFSForConnectedComponents(neighbor_id, marker_id, marker);
+ConnectedComponents::ConnectedComponents(const std::vector<Edge>& edges) : Graph(edges) {
+	components_.Resize(V_);
+	for (const auto& edge : edge_list_) {
+		components_.Union(edge.first, edge.second);
+	}
+}
+
+bool ConnectedComponents::AddVertex(const Node& n) {
+	if (!Graph::AddVertex(n)) {
+		return false;
+	}
+	components_.Resize(V_);
+	return true;
+}
+
+void ConnectedComponents::AddEdge(const Edge& edge) {
+	if (RefuseMutation()) {
+		return;
+	}
+	Graph::AddEdge(edge);
+	components_.Resize(V_);
+	components_.Union(edge_list_.back().first, edge_list_.back().second);
+}
+
+bool ConnectedComponents::LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats) {
+	const size_t edge_count = edge_list_.size();
+	if (!Graph::LoadEdgeList(path, chunk_bytes, pool, stats)) {
+		return false;
+	}
+	components_.Resize(V_);
+	for (size_t i = edge_count; i < edge_list_.size(); i++) {
+		components_.Union(edge_list_[i].first, edge_list_[i].second);
+	}
+	return true;
+}
+
+bool ConnectedComponents::LoadMapped(const std::string& path) {
+	if (!Graph::LoadMapped(path)) {
+		return false;
+	}
+	components_.Resize(V_);
+	for (uint32_t node = 0; node < index_.size(); node++) {
+		for (const uint32_t* neighbor = adjacency_.begin(node); neighbor != adjacency_.end(node); neighbor++) {
+			components_.Union(node, *neighbor);
 		}
 	}
+	return true;
+}
+
+bool ConnectedComponents::Reorder(VertexOrder order) {
+	if (!Graph::Reorder(order)) {
+		return false;
+	}
+	components_ = DisjointSet();
+	components_.Resize(V_);
+	for (const auto& edge : edge_list_) {
+		components_.Union(edge.first, edge.second);
+	}
+	return true;
+}
+
+bool ConnectedComponents::Connected(const std::string& node_1, const std::string& node_2) const {
+	const uint32_t node_id_1 = index_.Find(node_1);
+	const uint32_t node_id_2 = index_.Find(node_2);
+	if (node_id_1 == kNoVertex || node_id_2 == kNoVertex) {
+		return false;
+	}
+	return components_.Root(node_id_1) == components_.Root(node_id_2);
+}
+
+int ConnectedComponents::ComponentOf(const std::string& node_id) const {
+	const uint32_t node = index_.Find(node_id);
+	return node == kNoVertex ? -1 : static_cast<int>(components_.Root(node));
+}
+
+int ConnectedComponents::ComponentSize(const std::string& node_id) const {
+	const uint32_t node = index_.Find(node_id);
+	return node == kNoVertex ? 0 : static_cast<int>(components_.SetSize(node));
 }
 
 std::unordered_map<std::string, int> ConnectedComponents::GetConnectedComponents() {
-	visited_.clear();
-	std::unordered_map<std::string, int> marker;
+	return GetConnectedComponents(&context_);
+}
+
+std::unordered_map<std::string, int> ConnectedComponents::GetConnectedComponents(TraversalContext* context) const {
+	EnsureFrozen();
+	context->Reset(V_);
+	std::vector<int> node_marker(V_);
 	int marker_id = 0;
-	for (const auto& vertex : vertices_) {
-		const auto& node_id = vertex.first;
-		if (!visited(node_id)) {
-			DFSForConnectedComponents(node_id, marker_id, &marker);
+	for (uint32_t node = 0; node < index_.size(); node++) {
+		if (!context->visited(node)) {
+			DepthFirstSearch(adjacency_, node, context,
+			                 [&](uint32_t visited_node, uint32_t) { node_marker[visited_node] = marker_id; return true; },
+			                 dfs::Continue(), dfs::Continue());
 			marker_id++;
 		}
 	}
+	std::unordered_map<std::string, int> marker;
+	marker.reserve(V_);
+	for (uint32_t node = 0; node < index_.size(); node++) {
+		marker.insert({index_.Id(node), node_marker[node]});
+	}
+	return marker;
+}
+
+uint32_t ConnectedComponents::ParallelConnectedComponents(ThreadPool* pool, std::vector<uint32_t>* labels) const {
+	EnsureFrozen();
+	return AfforestComponents(adjacency_, pool, labels);
+}
+
+std::unordered_map<std::string, int> ConnectedComponents::ParallelConnectedComponents(int num_threads) const {
+	ThreadPool pool(num_threads);
+	std::vector<uint32_t> labels;
+	ParallelConnectedComponents(&pool, &labels);
+	return ComponentMarkers(labels);
+}
+
+std::unordered_map<std::string, int> ConnectedComponents::ComponentMarkers(const std::vector<uint32_t>& labels) const {
+	std::unordered_map<std::string, int> marker;
+	marker.reserve(labels.size());
+	for (uint32_t node = 0; node < labels.size(); node++) {
+		marker.insert({index_.Id(node), static_cast<int>(labels[node])});
+	}
 	return marker;
 }
 
@@ -2,6 +2,7 @@
 #define CONNECTED_COMPONENTS_H
 
 #include "graph.h"
+#include "../disjoint_set.h"
 
 namespace graph {
 
@@ -12,21 +13,59 @@ public:
 	ConnectedComponents() : Graph() {}
 
 	// Creates graph with input vertices and no edges.
-	ConnectedComponents(const std::vector<Node>& vertices) : Graph(vertices) {}
+	ConnectedComponents(const std::vector<Node>& vertices) : Graph(vertices) { components_.Resize(V_); }
 
 	// Creates graph with vertices and edges corresponding to input edges.
-	ConnectedComponents(const std::vector<Edge>& edges) : Graph(edges) {}
+	ConnectedComponents(const std::vector<Edge>& edges);
+
+	// Add vertex to graph as a component of its own.
+	bool AddVertex(const Node& n) override;
+
+	// Add edge to graph, merging the components of its endpoints.
+	void AddEdge(const Edge& edge) override;
+
+	// Load an edge list like Graph::LoadEdgeList, merging the components of the endpoints of every loaded edge.
+	bool LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats) override;
+	using Graph::LoadEdgeList;
+
+	// Load a snapshot like Graph::LoadMapped, then build the components from its adjacency.
+	bool LoadMapped(const std::string& path) override;
+
+	// Renumber the nodes like Graph::Reorder, then rebuild the components over the new dense ids.
+	bool Reorder(VertexOrder order) override;
+
+	// Whether node_1 and node_2 are in the same connected component. Answered from the union-find forest without traversal.
+	bool Connected(const std::string& node_1, const std::string& node_2) const;
+
+	// Id of the component containing the input node, or -1 if the node is not in the graph. Ids are only stable until the next edge is added.
+	int ComponentOf(const std::string& node_id) const;
+
+	// Get count of connected components.
+	int ComponentCount() const { return components_.count(); }
+
+	// Get count of nodes in the component containing the input node, or 0 if the node is not in the graph.
+	int ComponentSize(const std::string& node_id) const;
 
 	// Finds connected components in graph by assigning the same marker_id to elements of same component and returns the id->marker map.
 	std::unordered_map<std::string, int> GetConnectedComponents();
+	std::unordered_map<std::string, int> GetConnectedComponents(TraversalContext* context) const;
+
+	// Labels every node with its component using the parallel Afforest algorithm, without recursion. labels is indexed
+	// by dense id and holds component ids 0..count-1; returns count.
+	uint32_t ParallelConnectedComponents(ThreadPool* pool, std::vector<uint32_t>* labels) const;
+
+	// Same output as GetConnectedComponents, computed with ParallelConnectedComponents on num_threads threads (one per hardware thread if not positive).
+	std::unordered_map<std::string, int> ParallelConnectedComponents(int num_threads) const;
+
+	// Converts labels indexed by dense id into the id->marker map returned by GetConnectedComponents.
+	std::unordered_map<std::string, int> ComponentMarkers(const std::vector<uint32_t>& labels) const;
 
 	// Prints connected components by assigning each vertex their respective component.
 	void PrintConnectedComponents(const std::unordered_map<std::string, int>& marker) const;
 
 private:
-	// Utility method for assigning marker id to each node in the graph.
-	void DFSForConnectedComponents(const std::string& node_id, int marker_id, std::unordered_map<std::string, int> *marker);
-
+	// Components kept up to date by AddVertex and AddEdge, over dense ids.
+	DisjointSet components_;
 };
 
 }  // namespace graph
@@ -1,6 +1,8 @@
 #include "connected_components.h"
 #include "../test_utils.h"
 
+#include <cstdio>
+
 namespace graph {
 
 	void TestConnectedComponents(testing::Testing& test_suite) {
@@ -27,11 +29,117 @@ namespace graph {
 	    test_suite.TestResults();
 	}
 
+	void TestIncrementalConnectivity(testing::Testing& test_suite) {
+		test_suite.init("incremental connectivity queries while adding edges");
+		Node a("A"), b("B"), c("C"), d("D"), e("E"), f("F");
+		Edge e1(a.Id(), b.Id(), 1), e2(c.Id(), d.Id(), 1), e3(b.Id(), c.Id(), 1), e4(d.Id(), a.Id(), 1);
+		ConnectedComponents graph({e1, e2});
+		graph.AddVertex(e);
+		test_suite.test(graph.ComponentCount() == 3);
+		test_suite.test(graph.Connected(a.Id(), b.Id()));
+		test_suite.test(!graph.Connected(a.Id(), c.Id()));
+		test_suite.test(graph.ComponentSize(c.Id()) == 2);
+		graph.AddEdge(e3);
+		test_suite.test(graph.ComponentCount() == 2);
+		test_suite.test(graph.Connected(a.Id(), d.Id()));
+		test_suite.test(graph.ComponentOf(a.Id()) == graph.ComponentOf(d.Id()));
+		test_suite.test(graph.ComponentOf(a.Id()) != graph.ComponentOf(e.Id()));
+		test_suite.test(graph.ComponentSize(a.Id()) == 4);
+		graph.AddEdge(e4);
+		test_suite.test(graph.ComponentCount() == 2);
+		test_suite.test(graph.ComponentSize(e.Id()) == 1);
+		test_suite.test(!graph.Connected(a.Id(), f.Id()));
+		test_suite.test(graph.ComponentOf(f.Id()) == -1);
+		test_suite.test(graph.ComponentSize(f.Id()) == 0);
+		auto cc = graph.GetConnectedComponents();
+		test_suite.test((cc["A"] == cc["D"]) == graph.Connected(a.Id(), d.Id()));
+		test_suite.test((cc["A"] == cc["E"]) == graph.Connected(a.Id(), e.Id()));
+		test_suite.TestResults();
+	}
+
+	void TestParallelConnectedComponents(testing::Testing& test_suite) {
+		test_suite.init("parallel connected components against DFS connected components");
+		// Chains of increasing length (node i joins node i - 1 unless i is a triangular number), plus a few random chords.
+		std::vector<Edge> edges;
+		const int kNodes = 2000;
+		for (int node = 1, chain_start = 0, chain_length = 1; node < kNodes; node++) {
+			if (node - chain_start == chain_length) {
+				chain_start = node;
+				chain_length++;
+				continue;
+			}
+			edges.push_back(Edge(std::to_string(node - 1), std::to_string(node), 1));
+		}
+		for (int i = 0; i < 20; i++) {
+			edges.push_back(Edge(std::to_string(i * 97 % kNodes), std::to_string(i * 389 % kNodes), 1));
+		}
+		ConnectedComponents graph(edges);
+		auto cc = graph.GetConnectedComponents();
+		ThreadPool pool(4);
+		std::vector<uint32_t> labels;
+		const uint32_t count = graph.ParallelConnectedComponents(&pool, &labels);
+		auto parallel_cc = graph.ComponentMarkers(labels);
+		test_suite.test(parallel_cc.size() == cc.size());
+		test_suite.test(static_cast<int>(count) == graph.ComponentCount());
+		for (int node = 0; node < kNodes; node += 7) {
+			for (int other = 0; other < kNodes; other += 13) {
+				const std::string node_id = std::to_string(node), other_id = std::to_string(other);
+				test_suite.test((cc[node_id] == cc[other_id]) == (parallel_cc[node_id] == parallel_cc[other_id]));
+			}
+		}
+		for (const auto& node : parallel_cc) {
+			test_suite.test(node.second >= 0 && node.second < static_cast<int>(count));
+		}
+		auto small_cc = ConnectedComponents({Edge("A", "B", 1), Edge("C", "D", 1)}).ParallelConnectedComponents(2);
+		test_suite.test(small_cc["A"] == small_cc["B"] && small_cc["C"] == small_cc["D"] && small_cc["A"] != small_cc["C"]);
+		std::cout << "Components: " << count << std::endl;
+		test_suite.TestResults();
+	}
+
+	void TestMappedComponents(testing::Testing& test_suite) {
+		test_suite.init("connected components of a mapped snapshot");
+		ConnectedComponents graph({Edge("A", "B", 1), Edge("B", "C", 1), Edge("D", "E", 1)});
+		graph.AddVertex(Node("F"));
+		test_suite.test(graph.Save("cc_test_snapshot.bin"));
+		ConnectedComponents mapped;
+		test_suite.test(mapped.LoadMapped("cc_test_snapshot.bin"));
+		test_suite.test(mapped.ComponentCount() == 3);
+		test_suite.test(mapped.Connected("A", "C") && mapped.Connected("E", "D") && !mapped.Connected("C", "D"));
+		test_suite.test(mapped.ComponentSize("B") == 3 && mapped.ComponentSize("F") == 1);
+		auto cc = mapped.GetConnectedComponents();
+		test_suite.test(cc.size() == 6 && cc["A"] == cc["C"] && cc["A"] != cc["F"]);
+		mapped.AddEdge(Edge("C", "D", 1));
+		test_suite.test(!mapped.Connected("C", "D"));
+		std::remove("cc_test_snapshot.bin");
+		test_suite.TestResults();
+	}
+
+	void TestReorderedComponents(testing::Testing& test_suite) {
+		test_suite.init("connected components after reordering the nodes");
+		for (const VertexOrder order : {VertexOrder::kDegree, VertexOrder::kReverseCuthillMcKee, VertexOrder::kBreadthFirst, VertexOrder::kGorder}) {
+			ConnectedComponents graph({Edge("A", "B", 1), Edge("B", "C", 1), Edge("D", "E", 1), Edge("E", "F", 1), Edge("F", "D", 1)});
+			graph.AddVertex(Node("G"));
+			test_suite.test(graph.Reorder(order));
+			test_suite.test(graph.ComponentCount() == 3);
+			test_suite.test(graph.Connected("A", "C") && graph.Connected("D", "F") && !graph.Connected("C", "D"));
+			test_suite.test(graph.ComponentSize("B") == 3 && graph.ComponentSize("G") == 1);
+			graph.AddEdge(Edge("C", "G", 1));
+			test_suite.test(graph.Connected("A", "G") && graph.ComponentSize("A") == 4);
+			auto cc = graph.GetConnectedComponents();
+			test_suite.test(cc.size() == 7 && cc["A"] == cc["G"] && cc["D"] == cc["E"] && cc["A"] != cc["D"]);
+		}
+		test_suite.TestResults();
+	}
+
 }  // namespace graph
 
 int main() {
 	testing::Testing test_suite("CONNECTED COMPONENTS IN GRAPHS");
 	graph::TestConnectedComponents(test_suite);
+	graph::TestIncrementalConnectivity(test_suite);
+	graph::TestParallelConnectedComponents(test_suite);
+	graph::TestMappedComponents(test_suite);
+	graph::TestReorderedComponents(test_suite);
 
 	test_suite.PrintStats();
 }
\ No newline at end of file
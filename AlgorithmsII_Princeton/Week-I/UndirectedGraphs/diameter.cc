@@ -0,0 +1,38 @@
+#include "diameter.h"
+
+namespace graph {
+
+int Diameter::GetDiameter(ThreadPool* pool, DiameterStats* stats) const {
+	EnsureFrozen();
+	return static_cast<int>(IFUBDiameter(adjacency_, pool, stats));
+}
+
+int Diameter::GetDiameter(int num_threads) const {
+	ThreadPool pool(num_threads);
+	return GetDiameter(&pool, nullptr);
+}
+
+int Diameter::DiameterLowerBound(DiameterStats* stats) {
+	return DiameterLowerBound(&context_, stats);
+}
+
+int Diameter::DiameterLowerBound(TraversalContext* context, DiameterStats* stats) const {
+	EnsureFrozen();
+	return static_cast<int>(DoubleSweepDiameter(adjacency_, context, stats));
+}
+
+std::unordered_map<std::string, std::pair<int, int>> Diameter::EccentricityBounds(int max_passes, ThreadPool* pool, DiameterStats* stats) const {
+	EnsureFrozen();
+	std::vector<uint32_t> lower, upper;
+	::EccentricityBounds(adjacency_, max_passes, pool, &lower, &upper, stats);
+	std::unordered_map<std::string, std::pair<int, int>> bounds;
+	bounds.reserve(V_);
+	for (uint32_t node = 0; node < index_.size(); node++) {
+		// A node no pass reached has no upper bound yet.
+		const int node_upper = upper[node] == UINT32_MAX ? -1 : static_cast<int>(upper[node]);
+		bounds.insert({index_.Id(node), {static_cast<int>(lower[node]), node_upper}});
+	}
+	return bounds;
+}
+
+}  // namespace graph
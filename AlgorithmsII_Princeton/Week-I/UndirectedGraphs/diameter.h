@@ -0,0 +1,43 @@
+#ifndef DIAMETER_H_
+#define DIAMETER_H_
+
+#include "graph.h"
+#include "../eccentricity.h"
+
+namespace graph {
+
+// Diameter and eccentricities of a graph, in edges: the eccentricity of a node is its largest distance to a node of its
+// connected component, and the diameter the largest eccentricity. Edge weights are ignored.
+class Diameter : public Graph {
+
+public:
+	// Creates empty graph.
+	Diameter() : Graph() {}
+
+	// Creates graph with input vertices and no edges.
+	Diameter(const std::vector<Node>& vertices) : Graph(vertices) {}
+
+	// Creates graph with vertices and edges corresponding to input edges.
+	Diameter(const std::vector<Edge>& edges) : Graph(edges) {}
+
+	// Exact diameter with the iFUB algorithm (see eccentricity.h), which usually needs a handful of BFS passes instead of
+	// one per node. The passes of each step are spread across the workers of pool (one per hardware thread if
+	// num_threads is not positive). If stats is not null the count of BFS passes is stored in it. 0 for an empty graph.
+	int GetDiameter(ThreadPool* pool, DiameterStats* stats) const;
+	int GetDiameter(int num_threads) const;
+
+	// Lower bound on the diameter from a double sweep, 2 BFS passes per component, using context for them. Exact on
+	// trees and usually close otherwise. If stats is not null the count of passes and an upper bound are stored in it.
+	int DiameterLowerBound(DiameterStats* stats);
+	int DiameterLowerBound(TraversalContext* context, DiameterStats* stats) const;
+
+	// Lower and upper bound on the eccentricity of every node, keyed by id, after at most max_passes BFS passes spread
+	// across the workers of pool. Both bounds are equal for a node once its eccentricity is exact, which usually takes
+	// far fewer passes than nodes; the upper bound is -1 for a node no pass has reached yet. If stats is not null the
+	// count of passes and bounds on the diameter are stored in it.
+	std::unordered_map<std::string, std::pair<int, int>> EccentricityBounds(int max_passes, ThreadPool* pool, DiameterStats* stats) const;
+};
+
+}  // namespace graph
+
+#endif /* DIAMETER_H_ */
@@ -0,0 +1,94 @@
+#include "diameter.h"
+#include "../test_utils.h"
+
+#include <algorithm>
+
+namespace graph {
+
+	/**
+	 * Eccentricity of every node of the graph among nodes by a BFS from each, keyed by id.
+	 */
+	std::unordered_map<std::string, int> AllEccentricities(Diameter& graph, const std::vector<std::string>& nodes) {
+		std::unordered_map<std::string, int> eccentricity;
+		for (const auto& node : nodes) {
+			PathTree tree;
+			graph.BFS(node, &tree);
+			if (tree.V() == 0) {
+				continue;
+			}
+			int farthest = 0;
+			for (const auto& other : nodes) {
+				farthest = std::max<int>(farthest, graph.Distance(other, tree));
+			}
+			eccentricity[node] = farthest;
+		}
+		return eccentricity;
+	}
+
+	void TestPathAndCycleDiameter(testing::Testing& test_suite) {
+		test_suite.init("diameter of paths, cycles and empty graphs");
+		std::vector<Edge> path_edges, cycle_edges;
+		for (int i = 0; i < 10; i++) {
+			path_edges.push_back(Edge(std::to_string(i), std::to_string(i + 1), 1));
+			cycle_edges.push_back(Edge(std::to_string(i), std::to_string((i + 1) % 10), 1));
+		}
+		Diameter path(path_edges), cycle(cycle_edges), empty;
+		DiameterStats stats;
+		test_suite.test(path.GetDiameter(2) == 10 && path.DiameterLowerBound(&stats) == 10 && stats.bfs_passes == 2);
+		test_suite.test(cycle.GetDiameter(1) == 5);
+		test_suite.test(empty.GetDiameter(1) == 0 && empty.DiameterLowerBound(nullptr) == 0);
+		empty.AddVertex(Node("A"));
+		test_suite.test(empty.GetDiameter(1) == 0);
+		test_suite.TestResults();
+	}
+
+	void TestDiameterAgainstAllPairs(testing::Testing& test_suite) {
+		test_suite.init("iFUB diameter and eccentricity bounds against a BFS from every node");
+		const int kNodes = 150;
+		// Two sparse random components, the second one a long thin one, and one isolated node.
+		std::vector<Edge> edges = testing::RandomEdges(100, 170, 3);
+		for (int i = 100; i + 1 < kNodes - 1; i++) {
+			edges.push_back(Edge(std::to_string(i), std::to_string(i + 1 + (i % 7 == 0)), 1));
+		}
+		Diameter graph(edges);
+		graph.AddVertex(Node(std::to_string(kNodes)));
+		std::vector<std::string> nodes;
+		for (int node = 0; node <= kNodes; node++) {
+			nodes.push_back(std::to_string(node));
+		}
+		const std::unordered_map<std::string, int> eccentricity = AllEccentricities(graph, nodes);
+		int expected_diameter = 0;
+		for (const auto& node : eccentricity) {
+			expected_diameter = std::max(expected_diameter, node.second);
+		}
+
+		ThreadPool pool(3);
+		DiameterStats stats;
+		test_suite.test(graph.GetDiameter(&pool, &stats) == expected_diameter);
+		test_suite.test(stats.lower_bound == stats.upper_bound && stats.bfs_passes < static_cast<int>(eccentricity.size()));
+		test_suite.test(graph.DiameterLowerBound(&stats) <= expected_diameter && static_cast<int>(stats.upper_bound) >= expected_diameter);
+
+		// Few passes give valid bounds; enough passes give every eccentricity.
+		bool valid = true;
+		for (const auto& node : graph.EccentricityBounds(4, &pool, &stats)) {
+			valid = valid && node.second.first <= eccentricity.at(node.first) &&
+			        (node.second.second == -1 || node.second.second >= eccentricity.at(node.first));
+		}
+		test_suite.test(valid && stats.bfs_passes == 4);
+		bool exact = true;
+		for (const auto& node : graph.EccentricityBounds(kNodes, &pool, &stats)) {
+			exact = exact && node.second.first == eccentricity.at(node.first) && node.second.second == node.second.first;
+		}
+		test_suite.test(exact && static_cast<int>(stats.lower_bound) == expected_diameter && stats.upper_bound == stats.lower_bound);
+		test_suite.TestResults();
+	}
+
+}  // namespace graph
+
+int main() {
+	testing::Testing test_suite("DIAMETER OF GRAPHS");
+	graph::TestPathAndCycleDiameter(test_suite);
+	graph::TestDiameterAgainstAllPairs(test_suite);
+
+	test_suite.PrintStats();
+}
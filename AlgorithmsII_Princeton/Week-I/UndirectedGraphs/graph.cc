@@ -1,145 +1,565 @@
 #include "../node.h"
 #include "../edge.h"
 #include "graph.h"
+#include "../bidirectional_bfs.h"
+#include "../delta_stepping.h"
+#include "../dijkstra.h"
+#include "../dfs_engine.h"
+#include "../parallel_bfs.h"
 
-#include <stack>
-#include <queue>
+#include <algorithm>
 
 namespace graph {
 
-Graph::Graph(const std::vector<Node>& vertices) {
+Graph::Graph(const std::vector<Node>& vertices) : negative_weights_(0), frozen_(false) {
 	V_ = E_ = 0;
 	for (const auto& vertex : vertices) {
 		AddVertex(vertex);
 	}
 }
 
-Graph::Graph(const std::vector<Edge>& edges) {
+Graph::Graph(const std::vector<Edge>& edges) : negative_weights_(0), frozen_(false) {
 	V_ = E_ = 0;
 	for (const auto& edge : edges) {
 		AddEdge(edge);
 	}
 }
 
+Graph::Graph(const Graph& base, const std::vector<Node>& vertices, const std::vector<Edge>& edges)
+    : index_(base.index_), edge_list_(base.edge_list_), edge_weights_(base.edge_weights_),
+      negative_weights_(base.negative_weights_), frozen_(false), snapshot_(base.snapshot_) {
+	V_ = base.V_;
+	E_ = base.E_;
+	if (snapshot_ != nullptr) {
+		adjacency_ = base.adjacency_;
+		frozen_ = true;
+	}
+	for (const auto& vertex : vertices) {
+		AddVertex(vertex);
+	}
+	for (const auto& edge : edges) {
+		AddEdge(edge);
+	}
+}
+
 bool Graph::AddVertex(const Node& node) {
-    if (!vertices_.insert({node.Id(), node}).second) {
+    if (RefuseMutation()) {
+        return false;
+    }
+    const uint32_t vertex_count = index_.size();
+    index_.Intern(node.Id());
+    if (index_.size() == vertex_count) {
         std::cout << "Node with id " << node.Id() << " already exists" << std::endl;
         return false;
     }
     V_++;
+    frozen_ = false;
     return true;
 }
 
 void Graph::AddEdge(const Edge& edge) {
-    if (vertices_.find(edge.from()) == vertices_.end()) {
-        vertices_[edge.from()] = Node(edge.from());
-        V_++;
+    if (RefuseMutation()) {
+        return;
     }
-    if (vertices_.find(edge.to()) == vertices_.end()) {
-        vertices_[edge.to()] = Node(edge.to());
-        V_++;
-    }
-    adjacency_map_[edge.from()].push_back(edge.to());
-    adjacency_map_[edge.to()].push_back(edge.from());
-    edges_[edge.from()].insert({edge.to(), edge});
-    edges_[edge.to()].insert({edge.from(), edge});
+    const uint32_t from = index_.Intern(edge.from());
+    const uint32_t to = index_.Intern(edge.to());
+    V_ = index_.size();
+    edge_list_.push_back({from, to});
+    edge_weights_.push_back(edge.weight());
+    negative_weights_ += edge.weight() < 0;
     E_++;
+    frozen_ = false;
 }
 
-bool Graph::visited(const std::string& node_id) {
-	return visited_.find(node_id) != visited_.end();
+bool Graph::LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats) {
+	if (RefuseMutation()) {
+		return false;
+	}
+	const size_t edge_count = edge_list_.size();
+	if (!::LoadEdgeList(path, chunk_bytes, pool, &index_, &edge_list_, &edge_weights_, stats)) {
+		return false;
+	}
+	for (size_t i = edge_count; i < edge_list_.size(); i++) {
+		negative_weights_ += edge_weights_[i] < 0;
+	}
+	V_ = index_.size();
+	E_ = edge_list_.size();
+	frozen_ = false;
+	EnsureFrozen();
+	return true;
 }
 
-void Graph::DFSUtil(const std::string& node_id) {
-	visited_.insert(node_id);
-	for (const auto& neighbor_id : adjacency_map_[node_id]) {
-		if (!visited(neighbor_id)) {
-			path_to_[neighbor_id] = node_id;
-			DFSUtil(neighbor_id);
-		}
+bool Graph::LoadEdgeList(const std::string& path, int num_threads) {
+	ThreadPool pool(num_threads);
+	return LoadEdgeList(path, kEdgeListChunkBytes, &pool, nullptr);
+}
+
+void Graph::Freeze() {
+	EnsureFrozen();
+}
+
+bool Graph::Reorder(VertexOrder order) {
+	if (RefuseMutation()) {
+		return false;
+	}
+	EnsureFrozen();
+	std::vector<uint32_t> new_order;
+	OrderVertices(order, adjacency_, nullptr, &new_order);
+	RenumberVertices(new_order, &index_, &edge_list_);
+	frozen_ = false;
+	// The marks of the last traversal are stamped under the old ids.
+	context_.Reset(V_);
+	target_context_.Reset(V_);
+	return true;
+}
+
+void Graph::EnsureFrozen() const {
+	if (frozen_.load(std::memory_order_acquire)) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(freeze_mutex_);
+	if (frozen_.load(std::memory_order_relaxed)) {
+		return;
+	}
+	adjacency_.Build(index_.size(), edge_list_, &edge_weights_, AdjacencyDirection::kBoth);
+	frozen_.store(true, std::memory_order_release);
+}
+
+bool Graph::RefuseMutation() const {
+	if (snapshot_ == nullptr) {
+		return false;
+	}
+	std::cout << "Graph loaded with LoadMapped is read-only" << std::endl;
+	return true;
+}
+
+bool Graph::Save(const std::string& path) {
+	EnsureFrozen();
+	return WriteSnapshot(path, index_, adjacency_, nullptr, E_, negative_weights_);
+}
+
+bool Graph::LoadMapped(const std::string& path) {
+	if (V_ > 0) {
+		std::cout << "LoadMapped needs an empty graph" << std::endl;
+		return false;
+	}
+	std::shared_ptr<MappedFile> file(new MappedFile());
+	SnapshotHeader header;
+	if (!MapSnapshot(path, false, file.get(), &header, &index_, &adjacency_, nullptr)) {
+		return false;
 	}
+	snapshot_ = file;
+	V_ = header.num_vertices;
+	E_ = header.num_edges;
+	negative_weights_ = header.negative_weights;
+	frozen_ = true;
+	return true;
+}
+
+bool Graph::visited(const std::string& node_id) const {
+	return context_.visited(index_.Find(node_id));
+}
+
+uint32_t Graph::StartTraversal(const std::string& node_id, TraversalContext* context) const {
+	EnsureFrozen();
+	context->Reset(V_);
+	return index_.Find(node_id);
 }
 
 void Graph::DFS(const std::string& node_id) {
-	visited_.clear();
-	path_to_.clear();
-	path_to_[node_id] = node_id;
-	DFSUtil(node_id);
+	DFS(node_id, &context_);
+}
+
+void Graph::DFS(const std::string& node_id, TraversalContext* context) const {
+	const uint32_t node = StartTraversal(node_id, context);
+	if (node == kNoVertex) {
+		return;
+	}
+	DepthFirstSearch(adjacency_, node, context, dfs::Continue(), dfs::Continue(), dfs::Continue());
+}
+
+void Graph::DFS(const std::string& node_id, PathTree* tree) {
+	DFS(node_id, &context_, tree);
+}
+
+void Graph::DFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const {
+	const uint32_t node = StartTraversal(node_id, context);
+	if (node == kNoVertex) {
+		tree->Clear();
+		return;
+	}
+	tree->Reset(V_, node);
+	const auto reach = [&](uint32_t visited_node, uint32_t parent) {
+		if (visited_node != parent) {
+			tree->Reach(visited_node, tree->distance(parent) + 1, parent);
+		}
+		return true;
+	};
+	DepthFirstSearch(adjacency_, node, context, reach, dfs::Continue(), dfs::Continue());
 }
 
 void Graph::DFSIterative(const std::string& node_id) {
-	visited_.clear();
-	path_to_.clear();
-	std::stack<std::string> nodes_stack;
-	nodes_stack.push(node_id);
-	std::string prev = node_id;
+	DFSIterative(node_id, &context_);
+}
+
+void Graph::DFSIterative(const std::string& node_id, TraversalContext* context) const {
+	const uint32_t node = StartTraversal(node_id, context);
+	if (node == kNoVertex) {
+		return;
+	}
+	// A vertex pushed more than once keeps the parent of its latest push, which is also the copy popped first.
+	std::vector<uint32_t>& nodes_stack = *context->buffer();
+	context->set_parent(node, node);
+	nodes_stack.push_back(node);
 	while (!nodes_stack.empty()) {
-		const auto& curr_node_id = nodes_stack.top();
-		nodes_stack.pop();
-		if (visited(curr_node_id)) {
+		const uint32_t curr_node = nodes_stack.back();
+		nodes_stack.pop_back();
+		if (context->visited(curr_node)) {
 			continue;
 		}
-		path_to_[curr_node_id] = prev;;
-		visited_.insert(curr_node_id);
-		int remaining_neighbors = 0;
-		for (int i = adjacency_map_[curr_node_id].size() - 1; i >= 0; i--) {
-			const std::string& neighbor_id = adjacency_map_[curr_node_id][i];
-			if (!visited(neighbor_id)) {
-				nodes_stack.push(neighbor_id);
-				remaining_neighbors++;
+		context->Visit(curr_node);
+		for (const uint32_t* neighbor = adjacency_.end(curr_node); neighbor != adjacency_.begin(curr_node); ) {
+			neighbor--;
+			if (!context->visited(*neighbor)) {
+				context->set_parent(*neighbor, curr_node);
+				nodes_stack.push_back(*neighbor);
 			}
 		}
-		if (remaining_neighbors > 0) {
-			prev = curr_node_id;
-		}
 	}
 }
 
 void Graph::BFS(const std::string& node_id) {
-	path_to_.clear();
-	std::queue<std::string> nodes_queue;
-	path_to_[node_id] = node_id;
-	nodes_queue.push(node_id);
-	while (!nodes_queue.empty()) {
-		const auto& curr_node_id = nodes_queue.front();
-		nodes_queue.pop();
-		visited_.insert(curr_node_id);
-		for (const auto& neighbor_id : adjacency_map_[curr_node_id]) {
-			if (visited(neighbor_id)) {
-				continue;
+	BFS(node_id, &context_);
+}
+
+void Graph::BFS(const std::string& node_id, TraversalContext* context) const {
+	BFS(node_id, BFSMode::kTopDown, context, nullptr);
+}
+
+void Graph::BFS(const std::string& node_id, BFSMode mode, TraversalContext* context, BFSStats* stats) const {
+	// Switch to bottom-up once the frontier has more than 1/kBottomUpAlpha of the unexplored edges and back to top-down
+	// once it has fewer than 1/kTopDownBeta of the vertices (thresholds from Beamer et al., "Direction-Optimizing BFS").
+	const uint64_t kBottomUpAlpha = 14;
+	const uint64_t kTopDownBeta = 24;
+
+	BFSStats bfs_stats = {0, 0, 0};
+	const uint32_t node = StartTraversal(node_id, context);
+	if (node == kNoVertex) {
+		if (stats != nullptr) {
+			*stats = bfs_stats;
+		}
+		return;
+	}
+	// The queue keeps every visited vertex in BFS order; the current level is nodes_queue[level_begin, level_end).
+	std::vector<uint32_t>& nodes_queue = *context->buffer();
+	Bitmap& frontier = *context->bitmap();
+	frontier.Resize(V_);
+	context->Visit(node, node);
+	nodes_queue.push_back(node);
+	uint64_t unexplored_edges = adjacency_.E() - adjacency_.Degree(node);
+	bool bottom_up = false;
+	for (size_t level_begin = 0; level_begin < nodes_queue.size(); ) {
+		const size_t level_end = nodes_queue.size();
+		if (mode == BFSMode::kDirectionOptimizing) {
+			uint64_t frontier_edges = 0;
+			for (size_t i = level_begin; i < level_end; i++) {
+				frontier_edges += adjacency_.Degree(nodes_queue[i]);
+			}
+			if (!bottom_up) {
+				bottom_up = frontier_edges * kBottomUpAlpha > unexplored_edges;
+			} else {
+				bottom_up = (level_end - level_begin) * kTopDownBeta >= static_cast<uint64_t>(V_);
+			}
+		}
+		if (bottom_up) {
+			for (size_t i = level_begin; i < level_end; i++) {
+				frontier.Set(nodes_queue[i]);
+			}
+			for (uint32_t curr_node = 0; curr_node < index_.size(); curr_node++) {
+				if (context->visited(curr_node)) {
+					continue;
+				}
+				for (const uint32_t* neighbor = adjacency_.begin(curr_node); neighbor != adjacency_.end(curr_node); neighbor++) {
+					bfs_stats.edges_examined++;
+					if (frontier.Test(*neighbor)) {
+						context->Visit(curr_node, *neighbor);
+						nodes_queue.push_back(curr_node);
+						unexplored_edges -= adjacency_.Degree(curr_node);
+						break;
+					}
+				}
+			}
+			for (size_t i = level_begin; i < level_end; i++) {
+				frontier.Clear(nodes_queue[i]);
+			}
+			bfs_stats.bottom_up_levels++;
+		} else {
+			for (size_t i = level_begin; i < level_end; i++) {
+				const uint32_t curr_node = nodes_queue[i];
+				for (const uint32_t* neighbor = adjacency_.begin(curr_node); neighbor != adjacency_.end(curr_node); neighbor++) {
+					bfs_stats.edges_examined++;
+					if (context->visited(*neighbor)) {
+						continue;
+					}
+					context->Visit(*neighbor, curr_node);
+					nodes_queue.push_back(*neighbor);
+					unexplored_edges -= adjacency_.Degree(*neighbor);
+				}
 			}
-			path_to_[neighbor_id] = curr_node_id;
-			nodes_queue.push(neighbor_id);
 		}
+		bfs_stats.levels++;
+		level_begin = level_end;
+	}
+	if (stats != nullptr) {
+		*stats = bfs_stats;
 	}
 }
 
+void Graph::BFS(const std::string& node_id, PathTree* tree) {
+	BFS(node_id, &context_, tree);
+}
+
+void Graph::BFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const {
+	BFS(node_id, BFSMode::kDirectionOptimizing, context, nullptr);
+	const uint32_t node = index_.Find(node_id);
+	if (node == kNoVertex) {
+		tree->Clear();
+		return;
+	}
+	// The queue of the BFS lists every reached node after its parent.
+	tree->Reset(V_, node);
+	const std::vector<uint32_t>& nodes_queue = *context->buffer();
+	for (size_t i = 1; i < nodes_queue.size(); i++) {
+		const uint32_t parent = context->parent(nodes_queue[i]);
+		tree->Reach(nodes_queue[i], tree->distance(parent) + 1, parent);
+	}
+}
+
+void Graph::ParallelBFS(const std::string& node_id, int num_threads) {
+	ThreadPool pool(num_threads);
+	ParallelBFS(node_id, &pool, &context_);
+}
+
+void Graph::ParallelBFS(const std::string& node_id, ThreadPool* pool, TraversalContext* context) const {
+	const uint32_t node = StartTraversal(node_id, context);
+	if (node == kNoVertex) {
+		return;
+	}
+	ParallelBreadthFirstSearch(adjacency_, node, pool, context);
+}
+
 bool Graph::DoesPathExist(const std::string& node_to) {
-	return visited(node_to);
+	return DoesPathExist(node_to, context_);
+}
+
+bool Graph::DoesPathExist(const std::string& node_to, const TraversalContext& context) const {
+	return context.visited(index_.Find(node_to));
 }
 
 bool Graph::DoesPathExist(const std::string& node_from, const std::string& node_to) {
-	DFS(node_to);
-    return DoesPathExist(node_from);
+	return DoesPathExist(node_from, node_to, &context_);
+}
+
+bool Graph::DoesPathExist(const std::string& node_from, const std::string& node_to, TraversalContext* context) const {
+	const uint32_t from = StartTraversal(node_from, context);
+	const uint32_t to = index_.Find(node_to);
+	if (from == kNoVertex || to == kNoVertex) {
+		return false;
+	}
+	std::vector<uint32_t>& nodes_stack = *context->buffer();
+	context->Visit(from, from);
+	nodes_stack.push_back(from);
+	while (!nodes_stack.empty() && !context->visited(to)) {
+		const uint32_t curr_node = nodes_stack.back();
+		nodes_stack.pop_back();
+		for (const uint32_t* neighbor = adjacency_.begin(curr_node); neighbor != adjacency_.end(curr_node); neighbor++) {
+			if (!context->visited(*neighbor)) {
+				context->Visit(*neighbor, curr_node);
+				nodes_stack.push_back(*neighbor);
+			}
+		}
+	}
+	return context->visited(to);
+}
+
+std::vector<bool> Graph::DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries) {
+	return DoesPathExist(queries, &context_);
+}
+
+std::vector<bool> Graph::DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries,
+                                       TraversalContext* context) const {
+	EnsureFrozen();
+	std::vector<std::pair<uint32_t, uint32_t>> dense_queries;
+	dense_queries.reserve(queries.size());
+	for (const auto& query : queries) {
+		dense_queries.push_back({index_.Find(query.first), index_.Find(query.second)});
+	}
+	// In an undirected graph a path exists exactly between nodes of the same connected component, so label the
+	// components of the query sources with one BFS each and compare labels.
+	context->Reset(V_);
+	std::vector<uint32_t> component(V_, kNoVertex);
+	std::vector<uint32_t>& queue = *context->buffer();
+	for (const auto& query : dense_queries) {
+		const uint32_t source = query.first;
+		if (source == kNoVertex || context->visited(source)) {
+			continue;
+		}
+		context->Visit(source, source);
+		component[source] = source;
+		queue.assign(1, source);
+		for (size_t head = 0; head < queue.size(); head++) {
+			const uint32_t curr_node = queue[head];
+			for (const uint32_t* neighbor = adjacency_.begin(curr_node); neighbor != adjacency_.end(curr_node); neighbor++) {
+				if (!context->visited(*neighbor)) {
+					context->Visit(*neighbor, curr_node);
+					component[*neighbor] = source;
+					queue.push_back(*neighbor);
+				}
+			}
+		}
+	}
+	std::vector<bool> answers(dense_queries.size(), false);
+	for (size_t query = 0; query < dense_queries.size(); query++) {
+		const uint32_t source = dense_queries[query].first, target = dense_queries[query].second;
+		answers[query] = source != kNoVertex && target != kNoVertex && component[source] == component[target];
+	}
+	return answers;
 }
 
 std::vector<std::string> Graph::GetPath(const std::string& node_to) {
+	return GetPath(node_to, context_);
+}
+
+std::vector<std::string> Graph::GetPath(const std::string& node_to, const TraversalContext& context) const {
     std::vector<std::string> path;
-    if (!DoesPathExist(node_to)) {
+    if (!DoesPathExist(node_to, context)) {
     	return path;
     }
-    std::string iter_node = node_to;
-    while (iter_node != path_to_[iter_node]) {
-        path.insert(path.begin(), iter_node);
-        iter_node = path_to_[iter_node];
+    uint32_t iter_node = index_.Find(node_to);
+    while (iter_node != context.parent(iter_node)) {
+        path.push_back(index_.Id(iter_node));
+        iter_node = context.parent(iter_node);
     }
-    path.insert(path.begin(), iter_node);
+    path.push_back(index_.Id(iter_node));
+    std::reverse(path.begin(), path.end());
     return path;
 }
 
 std::vector<std::string> Graph::GetPath(const std::string& node_from, const std::string& node_to) {
-    DFS(node_from);
-    return GetPath(node_to);
+    return GetPath(node_from, node_to, &context_);
+}
+
+std::vector<std::string> Graph::GetPath(const std::string& node_from, const std::string& node_to, TraversalContext* context) const {
+    DFS(node_from, context);
+    return GetPath(node_to, *context);
+}
+
+std::vector<std::string> Graph::ShortestPath(const std::string& node_from, const std::string& node_to) {
+	return ShortestPath(node_from, node_to, &context_, &target_context_);
+}
+
+std::vector<std::string> Graph::ShortestPath(const std::string& node_from, const std::string& node_to, TraversalContext* source_context,
+                                             TraversalContext* target_context) const {
+	std::vector<std::string> path;
+	const uint32_t from = StartTraversal(node_from, source_context);
+	const uint32_t to = index_.Find(node_to);
+	std::vector<uint32_t> dense_path;
+	if (from == kNoVertex || to == kNoVertex ||
+	    !BidirectionalBFS(adjacency_, adjacency_, from, to, source_context, target_context, &dense_path)) {
+		return path;
+	}
+	path.reserve(dense_path.size());
+	for (const uint32_t node : dense_path) {
+		path.push_back(index_.Id(node));
+	}
+	return path;
+}
+
+bool Graph::WeightedShortestPaths(const std::string& node_from, PathTree* tree) const {
+	const uint32_t from = index_.Find(node_from);
+	if (from == kNoVertex) {
+		return false;
+	}
+	if (negative_weights_ > 0) {
+		std::cout << "Weighted shortest paths need non-negative edge weights" << std::endl;
+		return false;
+	}
+	EnsureFrozen();
+	IndexedHeap heap;
+	Dijkstra(adjacency_, from, kNoVertex, &heap, tree);
+	return true;
+}
+
+bool Graph::ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, int num_threads, PathTree* tree) const {
+	ThreadPool pool(num_threads);
+	return ParallelWeightedShortestPaths(node_from, delta, &pool, tree);
+}
+
+bool Graph::ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, ThreadPool* pool, PathTree* tree) const {
+	const uint32_t from = index_.Find(node_from);
+	if (from == kNoVertex) {
+		return false;
+	}
+	if (negative_weights_ > 0) {
+		std::cout << "Weighted shortest paths need non-negative edge weights" << std::endl;
+		return false;
+	}
+	EnsureFrozen();
+	DeltaStepping(adjacency_, from, delta, pool, tree);
+	return true;
+}
+
+std::vector<std::string> Graph::GetPath(const std::string& node_to, const PathTree& tree) const {
+	std::vector<std::string> path;
+	std::vector<uint32_t> dense_path;
+	if (tree.PathTo(index_.Find(node_to), &dense_path)) {
+		path.reserve(dense_path.size());
+		for (const uint32_t node : dense_path) {
+			path.push_back(index_.Id(node));
+		}
+	}
+	return path;
+}
+
+int64_t Graph::Distance(const std::string& node_to, const PathTree& tree) const {
+	const uint32_t to = index_.Find(node_to);
+	return tree.reached(to) ? tree.distance(to) : -1;
+}
+
+std::vector<std::vector<std::string>> Graph::GetPaths(const std::vector<std::string>& nodes_to, const PathTree& tree) const {
+	std::vector<uint32_t> targets;
+	targets.reserve(nodes_to.size());
+	for (const auto& node_to : nodes_to) {
+		targets.push_back(index_.Find(node_to));
+	}
+	std::vector<uint32_t> nodes;
+	std::vector<size_t> offsets;
+	tree.PathsTo(targets, &nodes, &offsets);
+	std::vector<std::vector<std::string>> paths(nodes_to.size());
+	for (size_t i = 0; i < paths.size(); i++) {
+		paths[i].reserve(offsets[i + 1] - offsets[i]);
+		for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+			paths[i].push_back(index_.Id(nodes[j]));
+		}
+	}
+	return paths;
+}
+
+std::vector<std::string> Graph::WeightedShortestPath(const std::string& node_from, const std::string& node_to, int64_t* distance) const {
+	const uint32_t from = index_.Find(node_from);
+	const uint32_t to = index_.Find(node_to);
+	PathTree tree;
+	if (from != kNoVertex && to != kNoVertex && negative_weights_ == 0) {
+		EnsureFrozen();
+		IndexedHeap heap;
+		Dijkstra(adjacency_, from, to, &heap, &tree);
+	} else if (negative_weights_ > 0) {
+		std::cout << "Weighted shortest paths need non-negative edge weights" << std::endl;
+	}
+	if (distance != nullptr) {
+		*distance = Distance(node_to, tree);
+	}
+	return GetPath(node_to, tree);
 }
 
 void Graph::PrintPath(const std::vector<std::string>& path_nodes) const {
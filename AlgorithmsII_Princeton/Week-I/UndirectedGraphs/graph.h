@@ -3,22 +3,51 @@
 
 #include "../node.h"
 #include "../edge.h"
-
+#include "../vertex_index.h"
+#include "../compressed_adjacency.h"
+#include "../edge_list_loader.h"
+#include "../graph_snapshot.h"
+#include "../indexed_heap.h"
+#include "../path_tree.h"
+#include "../traversal_context.h"
+#include "../thread_pool.h"
+#include "../vertex_order.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <utility>
-#include <unordered_set>
 #include <unordered_map>
 
 namespace graph {
 
-class Graph {
+// Frontier expansion strategy of BFS.
+enum class BFSMode {
+    // Every level scans all edges of the frontier.
+    kTopDown,
+    // Levels with a large frontier are expanded bottom-up instead: every unvisited vertex scans its edges until it
+    // finds a parent in the frontier, which is kept as a bitmap. Switches back to top-down once the frontier shrinks.
+    kDirectionOptimizing
+};
 
-  private:
-    std::unordered_map<std::string, std::string> path_to_;
+// Work done by one BFS.
+struct BFSStats {
+    // Count of adjacency entries looked at.
+    uint64_t edges_examined;
 
-    // Utility method for implementation of DFS.
-    void DFSUtil(const std::string& node_id);
+    // Count of levels expanded, and how many of them were expanded bottom-up.
+    int levels;
+    int bottom_up_levels;
+};
+
+// Undirected graph over string vertex ids. Queries that take a TraversalContext, PathTree or ThreadPool keep all their
+// state there and are const, so any number of threads can query one graph at once, each with its own context, as long
+// as no thread modifies it meanwhile. The overloads without a context share state kept in the graph and are not for
+// concurrent use.
+class Graph {
 
+  private:
     // Utility method for implementation of BFS.
     void BFSUtil(const std::string& node_id);
 
@@ -29,14 +58,48 @@ class Graph {
     // Count of edges in graph.
     int E_;
 
-    std::unordered_map<std::string, Node> vertices_;
-    std::unordered_map<std::string, std::vector<std::string>> adjacency_map_;
-    std::unordered_map<std::string, std::unordered_map<std::string, Edge>> edges_;
-    std::unordered_set<std::string> visited_;
+    // Dense integer id of every vertex.
+    VertexIndex index_;
+
+    // Endpoints of every added edge as dense ids, in insertion order, and the weight of each: the only copy of the
+    // edges, 12 bytes each, which an undirected edge shares between both directions.
+    std::vector<std::pair<uint32_t, uint32_t>> edge_list_;
+    std::vector<int> edge_weights_;
+
+    // Count of added edges with a negative weight, which rule out Dijkstra's algorithm.
+    int negative_weights_;
+
+    // Adjacency built from edge_list_ by Freeze(); only valid while frozen_ is set. Built on first use by const queries,
+    // under freeze_mutex_.
+    mutable CompressedAdjacency adjacency_;
+    mutable std::atomic<bool> frozen_;
+    mutable std::mutex freeze_mutex_;
+
+    // Traversal state used by the methods that are not given a context.
+    TraversalContext context_;
+
+    // State of the search from the target in ShortestPath when it is not given contexts.
+    TraversalContext target_context_;
+
+    // Snapshot file that index_ and adjacency_ read from after LoadMapped(); null otherwise.
+    std::shared_ptr<const MappedFile> snapshot_;
+
+    // Returns true, printing a message, if the graph was loaded with LoadMapped() and so cannot be modified.
+    bool RefuseMutation() const;
+
+    // Build the adjacency unless it is built already. Safe to call from any number of threads at once: the first one
+    // builds it and the others wait for it.
+    void EnsureFrozen() const;
+
+    // Freeze the graph and start a new traversal in context. Returns the dense id of node_id, or kNoVertex if it is not in the graph.
+    uint32_t StartTraversal(const std::string& node_id, TraversalContext* context) const;
 
   public:
+    // Edges join their endpoints both ways.
+    static const bool kDirected = false;
+
   	// Create an empty graph.
-    Graph() { V_ = E_ = 0; }
+    Graph() : negative_weights_(0), frozen_(false) { V_ = E_ = 0; }
 
     // Create an empty graph with the given set of vertices.
     Graph(const std::vector<Node>& vertices);
@@ -44,41 +107,142 @@ class Graph {
     // Create a graph with the given set of edges.
     Graph(const std::vector<Edge>& edges);
 
+    // Create a graph with the vertices and edges of base followed by the given vertices and edges, leaving base as it
+    // is. Copies the edge list of base and builds a new adjacency on first use. A base loaded with LoadMapped is
+    // shared instead, and the new graph is read-only like it.
+    Graph(const Graph& base, const std::vector<Node>& vertices, const std::vector<Edge>& edges);
+
+    virtual ~Graph() {}
+
     // Add vertex to graph.
-    bool AddVertex(const Node& n);
+    virtual bool AddVertex(const Node& n);
 
     // Add edge to graph.
-    void AddEdge(const Edge& edge);
+    virtual void AddEdge(const Edge& edge);
 
     // Get count of vertices in graph.
-    int V() { return V_; }
+    int V() const { return V_; }
 
     // Get count of edges in graph.
-    int E() { return E_; }
+    int E() const { return E_; }
+
+    // Dense ids of the vertices, and the adjacency over them as out-edges and as in-edges (the same symmetric one), for
+    // code that searches the graph in place, such as the versions of versioned_graph.h. Builds the adjacency if needed.
+    const VertexIndex& vertex_index() const { return index_; }
+    const CompressedAdjacency& out_adjacency() const { EnsureFrozen(); return adjacency_; }
+    const CompressedAdjacency& in_adjacency() const { EnsureFrozen(); return adjacency_; }
+
+    // Add the edges of the text edge list at path ("u v [w]" lines; see edge_list_loader.h), read chunk_bytes at a time
+    // and parsed on the workers of pool, then build the adjacency in bulk. Returns false if the file cannot be read.
+    // If stats is not null the work done is stored in it.
+    virtual bool LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, EdgeListStats* stats);
+    bool LoadEdgeList(const std::string& path, int num_threads);
+
+    // Build the compressed adjacency used by all traversals. Traversals freeze the graph themselves
+    // after a mutation, so calling this is only needed to pay the cost up front.
+    void Freeze();
+
+    // Renumber the dense ids in the given order (see vertex_order.h), so that traversals find the vertices they visit
+    // together close together in memory. String ids, edges and the answers of queries stay the same; only the order
+    // in which traversals meet neighbors may change. Clears the traversal state of DFS and BFS, so DoesPathExist(node_to)
+    // and GetPath(node_to) need a new traversal. Returns false if the graph was loaded with LoadMapped.
+    virtual bool Reorder(VertexOrder order);
+
+    // Write the frozen graph (ids, adjacency and weights) to path in the snapshot format of graph_snapshot.h.
+    // Returns false if the file cannot be written.
+    bool Save(const std::string& path);
+
+    // Load the snapshot written by Save() at path into this empty graph by mapping the file read-only: ids and
+    // adjacency are read in place from the page cache, shared by every process mapping the file, so loading costs
+    // no parsing or copying however large the graph. The graph cannot be modified afterwards. Returns false if the
+    // graph is not empty or the file is not a snapshot of an undirected graph.
+    virtual bool LoadMapped(const std::string& path);
 
     // Return whether the input node is visited or not.
-    bool visited(const std::string& node_id);
+    bool visited(const std::string& node_id) const;
 
     // DFS implementaion.
     void DFS(const std::string& node_id);
+    void DFS(const std::string& node_id, TraversalContext* context) const;
+
+    // DFS from node_id filling tree with the parent and depth in the DFS tree of every reachable node, like the BFS
+    // overload.
+    void DFS(const std::string& node_id, PathTree* tree);
+    void DFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const;
 
     // DFS iterative implementaion.
     void DFSIterative(const std::string& node_id);
+    void DFSIterative(const std::string& node_id, TraversalContext* context) const;
 
     // BFS implementation.
     void BFS(const std::string& node_id);
+    void BFS(const std::string& node_id, TraversalContext* context) const;
+
+    // BFS from node_id filling tree with the parent and depth (fewest edges from node_id) of every reachable node, so
+    // that one traversal serves any number of GetPath and GetPaths calls for node_id, even after other traversals
+    // ran. Leaves tree empty if node_id is not in the graph. Overwrites the traversal state of DFS and BFS.
+    void BFS(const std::string& node_id, PathTree* tree);
+    void BFS(const std::string& node_id, TraversalContext* context, PathTree* tree) const;
+
+    // BFS implementation with the input frontier expansion strategy. If stats is not null, the work done is stored in it.
+    void BFS(const std::string& node_id, BFSMode mode, TraversalContext* context, BFSStats* stats) const;
+
+    // Level-synchronous BFS expanding each level on num_threads threads, or one per hardware thread if num_threads is not positive.
+    // Leaves a BFS tree for GetPath and DoesPathExist like BFS does.
+    void ParallelBFS(const std::string& node_id, int num_threads);
+    void ParallelBFS(const std::string& node_id, ThreadPool* pool, TraversalContext* context) const;
 
     // If DFS or BFS is run already for a node, then the result for whether or not a path exists to the input node is returned.
     bool DoesPathExist(const std::string& node_to);
+    bool DoesPathExist(const std::string& node_to, const TraversalContext& context) const;
 
-    // The result for whether or not a path exists from node_from to node_to is returned.
+    // The result for whether or not a path exists from node_from to node_to is returned. The search stops as soon as node_to is reached.
     bool DoesPathExist(const std::string& node_from, const std::string& node_to);
+    bool DoesPathExist(const std::string& node_from, const std::string& node_to, TraversalContext* context) const;
+
+    // Answers whether a path exists for every (node_from, node_to) pair of queries, in order. Two nodes are connected
+    // exactly when they share a connected component, so one BFS labels the component of each distinct node_from and
+    // every pair is then a label comparison: the batch costs one pass over the components it touches plus O(1) per
+    // pair. Overwrites the traversal state of DFS and BFS.
+    std::vector<bool> DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries);
+    std::vector<bool> DoesPathExist(const std::vector<std::pair<std::string, std::string>>& queries, TraversalContext* context) const;
 
     // If DFS or BFS is run already for a node, then the path from input node is returned. A message for non-existent path is returned in case there is no path.
     std::vector<std::string> GetPath(const std::string& node_to);
+    std::vector<std::string> GetPath(const std::string& node_to, const TraversalContext& context) const;
 
     // The path from node_from to node_to is returned. A message for non-existent path is returned in case there is no path.
     std::vector<std::string> GetPath(const std::string& node_from, const std::string& node_to);
+    std::vector<std::string> GetPath(const std::string& node_from, const std::string& node_to, TraversalContext* context) const;
+
+    // Shortest path (fewest edges) from node_from to node_to found by a bidirectional BFS, which stops as soon as the
+    // searches from both ends meet and so explores far less of a large graph than a search from node_from alone.
+    // Empty if there is no path. The two contexts are left holding the partial searches from either end.
+    std::vector<std::string> ShortestPath(const std::string& node_from, const std::string& node_to);
+    std::vector<std::string> ShortestPath(const std::string& node_from, const std::string& node_to, TraversalContext* source_context,
+                                          TraversalContext* target_context) const;
+
+    // Dijkstra's algorithm from node_from over the edge weights, filling tree with the distance and parent of every
+    // reachable vertex. Returns false, leaving tree untouched, if node_from is not in the graph or an edge weight is negative.
+    bool WeightedShortestPaths(const std::string& node_from, PathTree* tree) const;
+
+    // Delta-stepping on num_threads threads (or one per hardware thread if num_threads is not positive) from node_from over
+    // the edge weights, filling tree with the same distances as WeightedShortestPaths. delta is the bucket width; if it
+    // is not positive one is picked from the weights and the average degree. Returns false like WeightedShortestPaths.
+    bool ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, int num_threads, PathTree* tree) const;
+    bool ParallelWeightedShortestPaths(const std::string& node_from, int64_t delta, ThreadPool* pool, PathTree* tree) const;
+
+    // Path from the source of tree to node_to, or empty if node_to is not reached; and its weight, or -1.
+    std::vector<std::string> GetPath(const std::string& node_to, const PathTree& tree) const;
+    int64_t Distance(const std::string& node_to, const PathTree& tree) const;
+
+    // Paths from the source of tree to every node of nodes_to, in order, each empty if the node is not reached.
+    std::vector<std::vector<std::string>> GetPaths(const std::vector<std::string>& nodes_to, const PathTree& tree) const;
+
+    // Path of least total weight from node_from to node_to, found by Dijkstra's algorithm stopping once node_to is
+    // settled. Empty if there is no path or an edge weight is negative. If distance is not null the weight of the
+    // path, or -1, is stored in it.
+    std::vector<std::string> WeightedShortestPath(const std::string& node_from, const std::string& node_to, int64_t* distance) const;
 
     // Print the input path.
     void PrintPath(const std::vector<std::string>& path_nodes) const;
@@ -0,0 +1,248 @@
+#include "graph.h"
+#include "connected_components.h"
+#include "diameter.h"
+#include "../benchmark_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <thread>
+
+namespace graph {
+
+/**
+* Time sequential BFS in both modes and parallel BFS for increasing thread counts from the same source.
+*/
+void BenchmarkBFS(Graph& graph, const std::string& source, int max_threads) {
+    TraversalContext context;
+    graph.Freeze();
+    graph.BFS(source, &context);
+
+    for (const BFSMode mode : {BFSMode::kTopDown, BFSMode::kDirectionOptimizing}) {
+        BFSStats stats;
+        benchmark::Timer timer;
+        graph.BFS(source, mode, &context, &stats);
+        const double seconds = timer.Seconds();
+        benchmark::Report(mode == BFSMode::kTopDown ? "BFS top-down" : "BFS direction optimizing", seconds, 2.0 * graph.E());
+        std::cout << "    edges examined: " << stats.edges_examined << std::endl;
+    }
+
+    for (int num_threads = 1; ; num_threads = std::min(2 * num_threads, max_threads)) {
+        ThreadPool pool(num_threads);
+        benchmark::Timer timer;
+        graph.ParallelBFS(source, &pool, &context);
+        benchmark::Report("ParallelBFS threads=" + std::to_string(num_threads), timer.Seconds(), 2.0 * graph.E());
+        if (num_threads == max_threads) break;
+    }
+}
+
+/**
+* Time num_queries random point-to-point paths with the DFS based GetPath and the bidirectional ShortestPath.
+*/
+void BenchmarkPointToPoint(Graph& graph, int num_vertices, int num_queries) {
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (int i = 0; i < num_queries; i++) {
+        queries.push_back({std::to_string(vertex(generator)), std::to_string(vertex(generator))});
+    }
+    size_t dfs_length = 0, shortest_length = 0;
+    benchmark::Timer timer;
+    for (const auto& query : queries) {
+        dfs_length += graph.GetPath(query.first, query.second).size();
+    }
+    benchmark::Report("GetPath (DFS) pairs=" + std::to_string(num_queries), timer.Seconds(), 2.0 * graph.E() * num_queries);
+    benchmark::Timer bidirectional_timer;
+    for (const auto& query : queries) {
+        shortest_length += graph.ShortestPath(query.first, query.second).size();
+    }
+    benchmark::Report("ShortestPath (bidirectional) pairs=" + std::to_string(num_queries), bidirectional_timer.Seconds(),
+                      2.0 * graph.E() * num_queries);
+    std::cout << "    total path length: DFS " << dfs_length << ", bidirectional " << shortest_length << std::endl;
+}
+
+/**
+* Time paths from one source to num_targets random targets, each with its own ShortestPath search and all read off the
+* tree of a single BFS.
+*/
+void BenchmarkPathTree(Graph& graph, const std::string& source, int num_vertices, int num_targets) {
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+    std::vector<std::string> targets;
+    for (int i = 0; i < num_targets; i++) {
+        targets.push_back(std::to_string(vertex(generator)));
+    }
+    size_t search_length = 0, tree_length = 0;
+    benchmark::Timer timer;
+    for (const auto& target : targets) {
+        search_length += graph.ShortestPath(source, target).size();
+    }
+    benchmark::Report("ShortestPath targets=" + std::to_string(num_targets), timer.Seconds(), 2.0 * graph.E() * num_targets);
+    benchmark::Timer tree_timer;
+    PathTree tree;
+    graph.BFS(source, &tree);
+    for (const auto& path : graph.GetPaths(targets, tree)) {
+        tree_length += path.size();
+    }
+    benchmark::Report("BFS tree + GetPaths targets=" + std::to_string(num_targets), tree_timer.Seconds(), 2.0 * graph.E() * num_targets);
+    std::cout << "    total path length: searches " << search_length << ", tree " << tree_length << std::endl;
+}
+
+/**
+* Time saving graph to a snapshot, mapping it back, and a first BFS over the mapped pages against one over graph.
+*/
+void BenchmarkSnapshot(Graph& graph, const std::string& source) {
+    const std::string kPath = "graph_benchmark_snapshot.bin";
+    benchmark::Timer save_timer;
+    graph.Save(kPath);
+    benchmark::Report("Save", save_timer.Seconds(), graph.E());
+    benchmark::Timer load_timer;
+    Graph mapped;
+    mapped.LoadMapped(kPath);
+    benchmark::Report("LoadMapped", load_timer.Seconds(), graph.E());
+    benchmark::Timer first_timer;
+    mapped.BFS(source);
+    benchmark::Report("BFS over mapped snapshot (first)", first_timer.Seconds(), 2.0 * graph.E());
+    benchmark::Timer timer;
+    mapped.BFS(source);
+    benchmark::Report("BFS over mapped snapshot", timer.Seconds(), 2.0 * graph.E());
+    std::remove(kPath.c_str());
+}
+
+/**
+* Time loading edges written as a text edge list with LoadEdgeList for increasing thread counts.
+*/
+void BenchmarkLoadEdgeList(const std::vector<Edge>& edges, int max_threads) {
+    const std::string kPath = "graph_benchmark_edges.txt";
+    {
+        std::ofstream out(kPath);
+        for (const Edge& edge : edges) {
+            out << edge.from() << " " << edge.to() << " " << edge.weight() << "\n";
+        }
+    }
+    for (int num_threads = 1; ; num_threads = std::min(2 * num_threads, max_threads)) {
+        ThreadPool pool(num_threads);
+        Graph graph;
+        EdgeListStats stats;
+        benchmark::Timer timer;
+        graph.LoadEdgeList(kPath, kEdgeListChunkBytes, &pool, &stats);
+        benchmark::Report("LoadEdgeList threads=" + std::to_string(num_threads), timer.Seconds(), stats.edges);
+        std::cout << "    text read and parsed: " << stats.bytes / stats.seconds / 1e6 << " MB/s" << std::endl;
+        if (num_threads == max_threads) break;
+    }
+    std::remove(kPath.c_str());
+}
+
+/**
+* Time the double sweep lower bound, the exact diameter by iFUB for increasing thread counts if exact is set, and
+* eccentricity bounds after a fixed count of passes, with the BFS passes each one needed.
+*/
+void BenchmarkDiameter(const std::vector<Edge>& edges, bool exact, int max_threads) {
+    Diameter graph(edges);
+    graph.Freeze();
+    DiameterStats stats;
+    benchmark::Timer sweep_timer;
+    const int lower_bound = graph.DiameterLowerBound(&stats);
+    std::cout << std::left << std::setw(40) << "DiameterLowerBound" << std::right << std::setw(10) << sweep_timer.Seconds()
+              << " s, " << lower_bound << " (upper " << stats.upper_bound << ") after " << stats.bfs_passes << " BFS passes"
+              << std::endl;
+
+    for (int num_threads = 1; exact; num_threads = std::min(2 * num_threads, max_threads)) {
+        ThreadPool pool(num_threads);
+        benchmark::Timer timer;
+        const int diameter = graph.GetDiameter(&pool, &stats);
+        std::cout << std::left << std::setw(40) << "GetDiameter threads=" + std::to_string(num_threads) << std::right
+                  << std::setw(10) << timer.Seconds() << " s, " << diameter << " after " << stats.bfs_passes
+                  << " BFS passes" << std::endl;
+        if (num_threads == max_threads) break;
+    }
+
+    ThreadPool pool(max_threads);
+    for (const int max_passes : {16, 64}) {
+        benchmark::Timer timer;
+        const auto bounds = graph.EccentricityBounds(max_passes, &pool, &stats);
+        const size_t exact = std::count_if(bounds.begin(), bounds.end(), [](const std::pair<const std::string, std::pair<int, int>>& node) {
+            return node.second.first == node.second.second;
+        });
+        std::cout << std::left << std::setw(40) << "EccentricityBounds passes=" + std::to_string(max_passes) << std::right
+                  << std::setw(10) << timer.Seconds() << " s, " << exact << " of " << bounds.size() << " exact" << std::endl;
+    }
+}
+
+/**
+* Time BFS from source and DFS connected components on the graph of edges as built, then after renumbering its vertices
+* in each order, along with the time each renumbering takes.
+*/
+void BenchmarkVertexOrders(const std::vector<Edge>& edges, const std::string& source) {
+    const std::vector<std::pair<std::string, VertexOrder>> orders = {
+        {"degree", VertexOrder::kDegree}, {"RCM", VertexOrder::kReverseCuthillMcKee},
+        {"BFS order", VertexOrder::kBreadthFirst}, {"Gorder", VertexOrder::kGorder}};
+    for (int i = -1; i < static_cast<int>(orders.size()); i++) {
+        const std::string name = i < 0 ? "insertion order" : orders[i].first;
+        ConnectedComponents graph(edges);
+        graph.Freeze();
+        if (i >= 0) {
+            benchmark::Timer reorder_timer;
+            graph.Reorder(orders[i].second);
+            graph.Freeze();
+            benchmark::Report("reorder " + name, reorder_timer.Seconds(), graph.E());
+        }
+        TraversalContext context;
+        graph.BFS(source, &context);
+        benchmark::Timer bfs_timer;
+        graph.BFS(source, &context);
+        benchmark::Report("BFS " + name, bfs_timer.Seconds(), graph.E());
+        benchmark::Timer components_timer;
+        graph.GetConnectedComponents(&context);
+        benchmark::Report("connected components " + name, components_timer.Seconds(), graph.E());
+    }
+}
+
+}  // namespace graph
+
+int main(int argc, char** argv) {
+    const int num_vertices = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const int num_edges = argc > 2 ? std::atoi(argv[2]) : 8 * num_vertices;
+    const int max_threads = argc > 3 ? std::atoi(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Undirected random graph: " << num_vertices << " vertices, " << num_edges << " edges" << std::endl;
+
+    const std::vector<Edge> edges = benchmark::RandomEdges(num_vertices, num_edges, 1);
+    const size_t heap_bytes = benchmark::HeapBytes();
+    benchmark::Timer timer;
+    graph::Graph graph(edges);
+    benchmark::Report("construction", timer.Seconds(), num_edges);
+    const size_t built_bytes = benchmark::HeapBytes();
+    graph.Freeze();
+    std::cout << "    bytes per edge: " << (built_bytes - heap_bytes) / num_edges << " built, "
+              << (benchmark::HeapBytes() - heap_bytes) / num_edges << " frozen" << std::endl;
+    graph::BenchmarkLoadEdgeList(edges, max_threads);
+
+    graph::BenchmarkBFS(graph, "0", max_threads);
+    graph::BenchmarkPointToPoint(graph, num_vertices, 20);
+    graph::BenchmarkPathTree(graph, "0", num_vertices, 1000);
+    graph::BenchmarkSnapshot(graph, "0");
+    graph::BenchmarkVertexOrders(edges, "0");
+    // A uniformly random graph has few, huge levels around any vertex, so iFUB would need a search from most vertices.
+    graph::BenchmarkDiameter(edges, false, max_threads);
+
+    // A square grid with about as many vertices, whose long, thin levels suit iFUB.
+    const int side = static_cast<int>(std::sqrt(num_vertices));
+    const std::vector<Edge> grid_edges = benchmark::GridEdges(side);
+    std::cout << "Undirected grid graph: " << side << " x " << side << std::endl;
+    graph::BenchmarkDiameter(grid_edges, true, max_threads);
+    // Shuffled, the grid loses the locality of its row by row ids, which the orders should win back.
+    std::vector<size_t> shuffle(grid_edges.size());
+    for (size_t i = 0; i < shuffle.size(); i++) shuffle[i] = i;
+    std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(3));
+    std::vector<Edge> shuffled_grid_edges;
+    for (const size_t i : shuffle) shuffled_grid_edges.push_back(grid_edges[i]);
+    std::cout << "Shuffled undirected grid graph: " << side << " x " << side << std::endl;
+    graph::BenchmarkVertexOrders(shuffled_grid_edges, "0");
+
+    // The same count of vertices with about one edge each: many small components and a sparse, long giant one.
+    std::cout << "Sparse undirected random graph: " << num_vertices << " edges" << std::endl;
+    graph::BenchmarkDiameter(benchmark::RandomEdges(num_vertices, num_vertices, 2), true, max_threads);
+}
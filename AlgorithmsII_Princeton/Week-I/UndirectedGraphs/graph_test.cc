@@ -1,5 +1,13 @@
 #include "graph.h"
 #include "../test_utils.h"
+#include "../versioned_graph.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <thread>
 
 namespace graph {
 
@@ -70,7 +78,7 @@ void TestPathCreationForNodesWithDFSIterative(testing::Testing& test_suite) {
     Edge e1(a.Id(), b.Id(), 1), e2(a.Id(), c.Id(), 1), e3(b.Id(), d.Id(), 1), e4(c.Id(), d.Id(), 1), e5(d.Id(), e.Id(), 1), e6(e.Id(), f.Id(), 1), e7(a.Id(), f.Id(), 3);
     Graph graph({e1, e2, e3, e4, e5, e6, e7});
     graph.DFSIterative(a.Id());
-    const std::vector<std::string> expected_path = {"A", "B", "E"};
+    const std::vector<std::string> expected_path = {"A", "B", "D", "E"};
     const std::vector<std::string> path = graph.GetPath(e.Id());
     test_suite.test(testing::ComparePaths(path, expected_path));
     graph.PrintPath(path);
@@ -97,6 +105,563 @@ void TestPathCreationForNodesWithBFS(testing::Testing& test_suite) {
     test_suite.TestResults();
 }
 
+/**
+* Test that traversals on a frozen graph pick up edges added after freezing.
+*/
+void TestTraversalAfterFreeze(testing::Testing& test_suite) {
+    test_suite.init("traversal on frozen graph after adding edges");
+    Node a("A"), b("B"), c("C"), d("D");
+    Edge e1(a.Id(), b.Id(), 1), e2(b.Id(), c.Id(), 1), e3(c.Id(), d.Id(), 1);
+    Graph graph({e1, e2});
+    graph.Freeze();
+    test_suite.test(graph.DoesPathExist(a.Id(), c.Id()));
+    test_suite.test(!graph.DoesPathExist(a.Id(), d.Id()));
+    graph.AddEdge(e3);
+    const std::vector<std::string> expected_path = {"A", "B", "C", "D"};
+    const std::vector<std::string> path = graph.GetPath(a.Id(), d.Id());
+    test_suite.test(testing::ComparePaths(path, expected_path));
+    graph.PrintPath(path);
+    test_suite.TestResults();
+}
+
+/**
+* Test traversals with caller owned contexts, reused across queries.
+*/
+void TestTraversalWithContext(testing::Testing& test_suite) {
+    test_suite.init("traversals reusing caller owned contexts");
+    Node a("A"), b("B"), c("C"), d("D"), e("E"), f("F");
+    Edge e1(a.Id(), b.Id(), 1), e2(b.Id(), c.Id(), 1), e3(d.Id(), e.Id(), 1);
+    Graph graph({e1, e2, e3});
+    graph.AddVertex(f);
+    TraversalContext context_1, context_2;
+    for (int i = 0; i < 3; i++) {
+        test_suite.test(graph.DoesPathExist(a.Id(), c.Id(), &context_1));
+        test_suite.test(!graph.DoesPathExist(a.Id(), d.Id(), &context_1));
+        test_suite.test(graph.DoesPathExist(e.Id(), d.Id(), &context_1));
+        test_suite.test(!graph.DoesPathExist(f.Id(), a.Id(), &context_1));
+    }
+    graph.BFS(a.Id(), &context_1);
+    graph.DFS(d.Id(), &context_2);
+    const std::vector<std::string> p1 = graph.GetPath(c.Id(), context_1);
+    const std::vector<std::string> p2 = graph.GetPath(e.Id(), context_2);
+    test_suite.test(testing::ComparePaths(p1, {"A", "B", "C"}));
+    test_suite.test(testing::ComparePaths(p2, {"D", "E"}));
+    test_suite.test(!graph.DoesPathExist(e.Id(), context_1));
+    test_suite.test(!graph.DoesPathExist(c.Id(), context_2));
+    graph.PrintPath(p1);
+    graph.PrintPath(p2);
+    test_suite.TestResults();
+}
+
+/**
+* Test direction optimizing BFS finds the same reachability and path lengths as top-down BFS with fewer edges examined.
+*/
+void TestDirectionOptimizingBFS(testing::Testing& test_suite) {
+    test_suite.init("direction optimizing BFS against top-down BFS");
+    // A hub joined to a clique, plus a tail hanging off the clique and an unreachable pair.
+    std::vector<Edge> edges;
+    const int kCliqueSize = 30;
+    for (int i = 0; i < kCliqueSize; i++) {
+        edges.push_back(Edge("hub", "c" + std::to_string(i), 1));
+    }
+    for (int i = 0; i < kCliqueSize; i++) {
+        for (int j = i + 1; j < kCliqueSize; j++) {
+            edges.push_back(Edge("c" + std::to_string(i), "c" + std::to_string(j), 1));
+        }
+    }
+    edges.push_back(Edge("c7", "t0", 1));
+    edges.push_back(Edge("t0", "t1", 1));
+    edges.push_back(Edge("x", "y", 1));
+    Graph graph(edges);
+    TraversalContext top_down, direction_optimizing;
+    BFSStats top_down_stats, direction_optimizing_stats;
+    graph.BFS("hub", BFSMode::kTopDown, &top_down, &top_down_stats);
+    graph.BFS("hub", BFSMode::kDirectionOptimizing, &direction_optimizing, &direction_optimizing_stats);
+    for (int i = 0; i < kCliqueSize; i++) {
+        const std::string node_id = "c" + std::to_string(i);
+        test_suite.test(graph.GetPath(node_id, direction_optimizing).size() == graph.GetPath(node_id, top_down).size());
+    }
+    test_suite.test(testing::ComparePaths(graph.GetPath("t1", direction_optimizing), {"hub", "c7", "t0", "t1"}));
+    test_suite.test(!graph.DoesPathExist("x", direction_optimizing));
+    test_suite.test(direction_optimizing_stats.bottom_up_levels > 0);
+    test_suite.test(direction_optimizing_stats.edges_examined < top_down_stats.edges_examined);
+    std::cout << "Edges examined: top-down " << top_down_stats.edges_examined << ", direction optimizing "
+              << direction_optimizing_stats.edges_examined << " (" << direction_optimizing_stats.bottom_up_levels
+              << " of " << direction_optimizing_stats.levels << " levels bottom-up)" << std::endl;
+    test_suite.TestResults();
+}
+
+/**
+* Test parallel BFS leaves a BFS tree with the same reachability and path lengths as sequential BFS.
+*/
+void TestParallelBFS(testing::Testing& test_suite) {
+    test_suite.init("parallel BFS against sequential BFS");
+    // A 30 x 30 grid plus a separate pair of nodes.
+    const int kSide = 30;
+    std::vector<Edge> edges;
+    for (int row = 0; row < kSide; row++) {
+        for (int col = 0; col < kSide; col++) {
+            const std::string node_id = std::to_string(row * kSide + col);
+            if (col + 1 < kSide) edges.push_back(Edge(node_id, std::to_string(row * kSide + col + 1), 1));
+            if (row + 1 < kSide) edges.push_back(Edge(node_id, std::to_string((row + 1) * kSide + col), 1));
+        }
+    }
+    edges.push_back(Edge("x", "y", 1));
+    Graph graph(edges);
+    TraversalContext sequential, parallel;
+    graph.BFS("0", &sequential);
+    ThreadPool pool(4);
+    graph.ParallelBFS("0", &pool, &parallel);
+    for (int node = 0; node < kSide * kSide; node++) {
+        const std::vector<std::string> path = graph.GetPath(std::to_string(node), parallel);
+        test_suite.test(path.size() == graph.GetPath(std::to_string(node), sequential).size());
+        test_suite.test(!path.empty() && path.front() == "0");
+    }
+    test_suite.test(!graph.DoesPathExist("x", parallel));
+    graph.ParallelBFS("x", 2);
+    test_suite.test(testing::ComparePaths(graph.GetPath("y"), {"x", "y"}));
+    graph.PrintPath(graph.GetPath(std::to_string(kSide + 2), parallel));
+    test_suite.TestResults();
+}
+
+/**
+* Test batch reachability on a graph with several components.
+*/
+void TestBatchPathExists(testing::Testing& test_suite) {
+    test_suite.init("batch reachability between pairs of nodes");
+    // Node i is joined to i + 5 below 100, so nodes are connected exactly when they are equal modulo 5.
+    std::vector<Edge> edges;
+    for (int node = 0; node + 5 < 100; node++) {
+        edges.push_back(Edge(std::to_string(node), std::to_string(node + 5), 1));
+    }
+    Graph graph(edges);
+    graph.AddVertex(Node("lonely"));
+    std::vector<std::pair<std::string, std::string>> queries;
+    for (int from = 0; from < 100; from++) {
+        for (int to = 0; to < 100; to += 7) {
+            queries.push_back({std::to_string(from), std::to_string(to)});
+        }
+    }
+    const std::vector<bool> answers = graph.DoesPathExist(queries);
+    bool all_correct = answers.size() == queries.size();
+    for (size_t i = 0; i < queries.size(); i++) {
+        all_correct = all_correct && answers[i] == (std::stoi(queries[i].first) % 5 == std::stoi(queries[i].second) % 5);
+    }
+    test_suite.test(all_correct);
+    // Missing nodes reach nothing; an isolated node reaches only itself.
+    const std::vector<bool> edge_cases = graph.DoesPathExist({{"3", "x"}, {"x", "3"}, {"x", "x"}, {"lonely", "lonely"}, {"lonely", "0"}});
+    test_suite.test(edge_cases == std::vector<bool>({false, false, false, true, false}));
+    test_suite.TestResults();
+}
+
+/**
+* Test bidirectional shortest paths against BFS paths on a grid with a separate component.
+*/
+void TestShortestPath(testing::Testing& test_suite) {
+    test_suite.init("bidirectional BFS shortest paths");
+    const int kSide = 20;
+    std::vector<Edge> edges;
+    for (int row = 0; row < kSide; row++) {
+        for (int col = 0; col < kSide; col++) {
+            const std::string node_id = std::to_string(row * kSide + col);
+            if (col + 1 < kSide) edges.push_back(Edge(node_id, std::to_string(row * kSide + col + 1), 1));
+            if (row + 1 < kSide) edges.push_back(Edge(node_id, std::to_string((row + 1) * kSide + col), 1));
+        }
+    }
+    edges.push_back(Edge("x", "y", 1));
+    Graph graph(edges);
+    TraversalContext bfs_context;
+    bool all_shortest = true;
+    for (int from = 0; from < kSide * kSide; from += 37) {
+        graph.BFS(std::to_string(from), &bfs_context);
+        for (int to = 0; to < kSide * kSide; to += 11) {
+            const std::vector<std::string> path = graph.ShortestPath(std::to_string(from), std::to_string(to));
+            const std::vector<std::string> bfs_path = graph.GetPath(std::to_string(to), bfs_context);
+            all_shortest = all_shortest && path.size() == bfs_path.size() && path.front() == std::to_string(from) &&
+                           path.back() == std::to_string(to);
+            for (size_t i = 0; i + 1 < path.size(); i++) {
+                const int a = std::stoi(path[i]), b = std::stoi(path[i + 1]);
+                all_shortest = all_shortest && (std::abs(a - b) == kSide || (std::abs(a - b) == 1 && a / kSide == b / kSide));
+            }
+        }
+    }
+    test_suite.test(all_shortest);
+    test_suite.test(graph.ShortestPath("0", "x").empty());
+    test_suite.test(graph.ShortestPath("0", "missing").empty());
+    test_suite.test(testing::ComparePaths(graph.ShortestPath("y", "x"), {"y", "x"}));
+    test_suite.test(testing::ComparePaths(graph.ShortestPath("5", "5"), {"5"}));
+    graph.PrintPath(graph.ShortestPath("0", std::to_string(kSide * kSide - 1)));
+    test_suite.TestResults();
+}
+
+/**
+* Test weighted shortest paths on a small graph and against Bellman-Ford relaxation on a random one.
+*/
+void TestWeightedShortestPaths(testing::Testing& test_suite) {
+    test_suite.init("weighted shortest paths with Dijkstra");
+    Graph graph({Edge("A", "B", 4), Edge("A", "C", 1), Edge("C", "B", 2), Edge("B", "D", 5), Edge("C", "D", 8), Edge("E", "F", 1)});
+    PathTree tree;
+    test_suite.test(graph.WeightedShortestPaths("A", &tree));
+    test_suite.test(graph.Distance("B", tree) == 3 && graph.Distance("D", tree) == 8 && graph.Distance("E", tree) == -1);
+    test_suite.test(testing::ComparePaths(graph.GetPath("D", tree), {"A", "C", "B", "D"}));
+    test_suite.test(graph.GetPath("F", tree).empty());
+    int64_t distance = 0;
+    test_suite.test(testing::ComparePaths(graph.WeightedShortestPath("D", "A", &distance), {"D", "B", "C", "A"}));
+    test_suite.test(distance == 8);
+    test_suite.test(graph.WeightedShortestPath("A", "F", &distance).empty() && distance == -1);
+    test_suite.test(!graph.WeightedShortestPaths("missing", &tree));
+
+    const int kNodes = 200;
+    std::vector<Edge> edges = testing::RandomEdges(kNodes, 600, 17, 19, 0);
+    edges.push_back(Edge("0", "1", 50));
+    Graph random_graph(edges);
+    std::vector<int64_t> expected(kNodes, -1);
+    expected[0] = 0;
+    for (bool relaxed = true; relaxed; ) {
+        relaxed = false;
+        for (const Edge& edge : edges) {
+            const int ends[2] = {std::stoi(edge.from()), std::stoi(edge.to())};
+            for (int side = 0; side < 2; side++) {
+                const int a = ends[side], b = ends[1 - side];
+                if (expected[a] >= 0 && (expected[b] < 0 || expected[a] + edge.weight() < expected[b])) {
+                    expected[b] = expected[a] + edge.weight();
+                    relaxed = true;
+                }
+            }
+        }
+    }
+    bool all_equal = random_graph.WeightedShortestPaths("0", &tree);
+    for (int node = 0; node < kNodes; node++) {
+        all_equal = all_equal && random_graph.Distance(std::to_string(node), tree) == expected[node];
+    }
+    test_suite.test(all_equal);
+    graph.AddEdge(Edge("A", "F", -1));
+    test_suite.test(!graph.WeightedShortestPaths("A", &tree));
+    test_suite.TestResults();
+}
+
+/**
+* Test DFS on a chain far deeper than a recursive traversal could go on a default call stack.
+*/
+void TestDeepChainDFS(testing::Testing& test_suite) {
+    test_suite.init("DFS on a chain of 300000 nodes");
+    const int kLength = 300000;
+    std::vector<Edge> edges;
+    for (int node = 0; node + 1 < kLength; node++) {
+        edges.push_back(Edge(std::to_string(node), std::to_string(node + 1), 1));
+    }
+    Graph graph(edges);
+    graph.DFS("0");
+    test_suite.test(graph.visited(std::to_string(kLength - 1)));
+    test_suite.test(graph.GetPath(std::to_string(kLength - 1)).size() == kLength);
+    graph.DFS(std::to_string(kLength / 2));
+    test_suite.test(graph.GetPath("0").size() == kLength / 2 + 1);
+    test_suite.TestResults();
+}
+
+/**
+* Test a graph saved to a snapshot and mapped back answers queries like the original, and refuses changes.
+*/
+void TestSnapshot(testing::Testing& test_suite) {
+    test_suite.init("save and load a mapped snapshot");
+    const std::string kPath = "graph_test_snapshot.bin";
+    const int kNodes = 500;
+    Graph graph(testing::RandomEdges(kNodes, 1500, 23, 29, 0));
+    graph.AddVertex(Node("lonely"));
+    test_suite.test(graph.Save(kPath));
+
+    Graph mapped;
+    test_suite.test(mapped.LoadMapped(kPath));
+    test_suite.test(mapped.V() == graph.V() && mapped.E() == graph.E());
+    PathTree expected, tree;
+    graph.WeightedShortestPaths("0", &expected);
+    bool all_equal = mapped.WeightedShortestPaths("0", &tree);
+    graph.DFS("1");
+    mapped.DFS("1");
+    for (int node = 0; node < kNodes; node++) {
+        const std::string node_id = std::to_string(node);
+        all_equal = all_equal && mapped.Distance(node_id, tree) == graph.Distance(node_id, expected);
+        all_equal = all_equal && mapped.GetPath(node_id) == graph.GetPath(node_id);
+        all_equal = all_equal && mapped.ShortestPath("2", node_id).size() == graph.ShortestPath("2", node_id).size();
+    }
+    test_suite.test(all_equal);
+    test_suite.test(mapped.DoesPathExist("lonely", "lonely") && !mapped.DoesPathExist("0", "lonely"));
+    test_suite.test(!mapped.DoesPathExist("0", "missing"));
+
+    // A mapped graph is read-only, and only an empty graph can be loaded.
+    test_suite.test(!mapped.AddVertex(Node("new")));
+    mapped.AddEdge(Edge("0", "lonely", 1));
+    test_suite.test(mapped.E() == graph.E() && !mapped.DoesPathExist("0", "lonely"));
+    test_suite.test(!graph.LoadMapped(kPath));
+
+    // Saving over a mapped file leaves the graph mapping it reading the old one.
+    Graph(std::vector<Edge>{Edge("x", "y", 1)}).Save(kPath);
+    test_suite.test(mapped.GetPath("0", "1") == graph.GetPath("0", "1"));
+
+    // Files that are not snapshots are rejected.
+    const std::string kBadPath = "graph_test_not_a_snapshot.bin";
+    {
+        std::ofstream out(kBadPath, std::ios::binary | std::ios::trunc);
+        out << "not a snapshot";
+    }
+    Graph bad;
+    test_suite.test(!bad.LoadMapped(kBadPath) && bad.V() == 0);
+    test_suite.test(!bad.LoadMapped("missing_snapshot.bin"));
+    std::remove(kPath.c_str());
+    std::remove(kBadPath.c_str());
+    test_suite.TestResults();
+}
+
+/**
+* Test an edge list loaded in small chunks on several threads builds the same graph as its edges added one by one.
+*/
+void TestLoadEdgeList(testing::Testing& test_suite) {
+    test_suite.init("load a text edge list");
+    const std::string kPath = "graph_test_edges.txt";
+    const int kNodes = 300;
+    std::vector<Edge> edges;
+    {
+        std::ofstream out(kPath);
+        out << "# SNAP style comment\n% another comment\n\np sp 300 1000\nc graph.gr\nc note 5\n";
+        const std::vector<Edge> random_edges = testing::RandomEdges(kNodes, 1000, 11, 39, 0);
+        for (int i = 0; i < 1000; i++) {
+            const Edge& edge = random_edges[i];
+            // Lines without a weight load with weight 1.
+            edges.push_back(Edge(edge.from(), edge.to(), i % 3 == 0 ? 1 : edge.weight()));
+            if (i % 3 == 0) {
+                out << edge.from() << "\t" << edge.to() << "\n";
+            } else if (i % 3 == 1) {
+                out << edge.from() << " " << edge.to() << " " << edge.weight() << "\r\n";
+            } else {
+                out << "a " << edge.from() << " " << edge.to() << "  " << edge.weight() << "\n";
+            }
+        }
+        out << "only_one_token\n1 2 not_a_weight\n1 2 3 4 5\nlast_line 0";
+    }
+    edges.push_back(Edge("last_line", "0", 1));
+    Graph expected(edges);
+
+    Graph graph;
+    ThreadPool pool(3);
+    EdgeListStats stats;
+    test_suite.test(graph.LoadEdgeList(kPath, 64, &pool, &stats));
+    test_suite.test(graph.V() == expected.V() && graph.E() == expected.E());
+    test_suite.test(stats.edges == edges.size() && stats.skipped_lines == 3 && stats.dimacs);
+    PathTree expected_tree, tree;
+    expected.WeightedShortestPaths("0", &expected_tree);
+    bool all_equal = graph.WeightedShortestPaths("0", &tree);
+    expected.DFS("5");
+    graph.DFS("5");
+    for (int node = 0; node < kNodes; node++) {
+        const std::string node_id = std::to_string(node);
+        all_equal = all_equal && graph.Distance(node_id, tree) == expected.Distance(node_id, expected_tree);
+        all_equal = all_equal && graph.GetPath(node_id) == expected.GetPath(node_id);
+    }
+    test_suite.test(all_equal);
+    test_suite.test(graph.GetPath("last_line", "0").size() == 2);
+
+    // Loading adds to the edges already in the graph.
+    Graph appended(std::vector<Edge>{Edge("x", "0", -2)});
+    test_suite.test(appended.LoadEdgeList(kPath, 1));
+    test_suite.test(appended.E() == expected.E() + 1 && appended.DoesPathExist("x", "last_line"));
+    test_suite.test(!appended.WeightedShortestPaths("x", &tree));
+    test_suite.test(!graph.LoadEdgeList("missing_edges.txt", 1));
+
+    // A plain edge list may name vertices c and p: without a DIMACS problem line or arc, their lines are edges.
+    {
+        std::ofstream out(kPath);
+        out << "# plain edge list\nc 0\np 1 4\n0 1\nc d 2\n";
+    }
+    Graph plain;
+    test_suite.test(plain.LoadEdgeList(kPath, 64, &pool, &stats));
+    test_suite.test(!stats.dimacs && stats.edges == 4 && stats.skipped_lines == 0 && plain.E() == 4);
+    test_suite.test(plain.GetPath("c", "p") == std::vector<std::string>{"c", "0", "1", "p"} && plain.DoesPathExist("d", "p"));
+    std::remove(kPath.c_str());
+    test_suite.TestResults();
+}
+
+/**
+* Test path trees of BFS and DFS hold shortest (BFS) and valid (DFS) paths and stay usable after other traversals.
+*/
+void TestTraversalPathTrees(testing::Testing& test_suite) {
+    test_suite.init("path trees of BFS and DFS");
+    const int kNodes = 400;
+    Graph graph(testing::RandomEdges(kNodes, 700, 29));
+    PathTree bfs_tree, dfs_tree;
+    graph.BFS("0", &bfs_tree);
+    graph.DFS("0", &dfs_tree);
+    // Run other traversals, which must leave both trees alone.
+    graph.BFS("1");
+    graph.ShortestPath("2", "3");
+
+    std::vector<std::string> targets;
+    for (int node = 0; node < kNodes; node++) {
+        targets.push_back(std::to_string(node));
+    }
+    targets.push_back("missing");
+    const std::vector<std::vector<std::string>> bfs_paths = graph.GetPaths(targets, bfs_tree);
+    const std::vector<std::vector<std::string>> dfs_paths = graph.GetPaths(targets, dfs_tree);
+    bool all_valid = bfs_paths.size() == targets.size() && bfs_paths.back().empty() && dfs_paths.back().empty();
+    for (int node = 0; node < kNodes; node++) {
+        const std::vector<std::string> shortest = graph.ShortestPath("0", targets[node]);
+        all_valid = all_valid && bfs_paths[node].size() == shortest.size() && bfs_paths[node] == graph.GetPath(targets[node], bfs_tree);
+        all_valid = all_valid && graph.Distance(targets[node], bfs_tree) + 1 == static_cast<int64_t>(shortest.size());
+        all_valid = all_valid && dfs_paths[node].empty() == shortest.empty();
+        all_valid = all_valid && graph.Distance(targets[node], dfs_tree) + 1 == static_cast<int64_t>(dfs_paths[node].size());
+        for (size_t i = 0; i + 1 < dfs_paths[node].size(); i++) {
+            all_valid = all_valid && graph.ShortestPath(dfs_paths[node][i], dfs_paths[node][i + 1]).size() == 2;
+        }
+    }
+    test_suite.test(all_valid);
+    graph.BFS("missing", &bfs_tree);
+    test_suite.test(bfs_tree.V() == 0 && graph.GetPath("0", bfs_tree).empty());
+    test_suite.TestResults();
+}
+
+/**
+* Test that const queries from several threads, each with its own contexts, give the sequential answers, starting on a
+* graph whose adjacency is built by the first of them.
+*/
+void TestConcurrentQueries(testing::Testing& test_suite) {
+    test_suite.init("concurrent const queries with per-thread contexts");
+    const int kNodes = 300, kThreads = 4;
+    const std::vector<Edge> edges = testing::RandomEdges(kNodes, 500, 71, 9);
+    Graph expected_graph(edges), graph(edges);
+    std::vector<size_t> expected_lengths(kNodes);
+    std::vector<int64_t> expected_distances(kNodes);
+    for (int node = 0; node < kNodes; node++) {
+        expected_lengths[node] = expected_graph.ShortestPath("0", std::to_string(node)).size();
+        expected_graph.WeightedShortestPath("0", std::to_string(node), &expected_distances[node]);
+    }
+
+    std::vector<int> all_valid(kThreads, 1);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.push_back(std::thread([&, t]() {
+            TraversalContext source_context, target_context;
+            PathTree tree;
+            const Graph& queried = graph;
+            for (int node = t; node < kNodes; node += kThreads) {
+                const std::string node_id = std::to_string(node);
+                bool valid = queried.ShortestPath("0", node_id, &source_context, &target_context).size() == expected_lengths[node];
+                valid = valid && queried.DoesPathExist("0", node_id, &source_context) == (expected_lengths[node] > 0);
+                queried.BFS(node_id, &source_context, &tree);
+                valid = valid && queried.Distance("0", tree) + 1 == static_cast<int64_t>(expected_lengths[node]);
+                int64_t distance = 0;
+                queried.WeightedShortestPath("0", node_id, &distance);
+                valid = valid && distance == expected_distances[node];
+                all_valid[t] = all_valid[t] && valid;
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    test_suite.test(std::count(all_valid.begin(), all_valid.end(), 1) == kThreads);
+    test_suite.TestResults();
+}
+
+/**
+* Test that renumbering the vertices in every order keeps ids, edges and query answers, and that reverse Cuthill-McKee
+* numbers a shuffled path consecutively.
+*/
+void TestVertexReordering(testing::Testing& test_suite) {
+    test_suite.init("vertex reordering keeps ids and answers");
+    const int kNodes = 400;
+    const std::vector<Edge> edges = testing::RandomEdges(kNodes, 700, 5, 9);
+    Graph expected_graph(edges);
+    expected_graph.AddVertex(Node("island"));
+    std::vector<size_t> expected_lengths(kNodes);
+    std::vector<int64_t> expected_distances(kNodes);
+    for (int node = 0; node < kNodes; node++) {
+        expected_lengths[node] = expected_graph.ShortestPath("0", std::to_string(node)).size();
+        expected_graph.WeightedShortestPath("0", std::to_string(node), &expected_distances[node]);
+    }
+
+    for (const VertexOrder order : {VertexOrder::kDegree, VertexOrder::kReverseCuthillMcKee, VertexOrder::kBreadthFirst, VertexOrder::kGorder}) {
+        Graph graph(edges);
+        graph.AddVertex(Node("island"));
+        // Reordering drops the traversal run before it, whose marks belong to the old ids.
+        graph.BFS("0");
+        test_suite.test(graph.Reorder(order));
+        bool none_visited = !graph.DoesPathExist("island");
+        for (int node = 0; node < kNodes; node++) {
+            none_visited = none_visited && !graph.DoesPathExist(std::to_string(node));
+        }
+        test_suite.test(none_visited);
+        test_suite.test(graph.V() == expected_graph.V() && graph.E() == expected_graph.E());
+        bool same = true;
+        for (int node = 0; node < kNodes; node++) {
+            int64_t distance = 0;
+            graph.WeightedShortestPath("0", std::to_string(node), &distance);
+            same = same && graph.ShortestPath("0", std::to_string(node)).size() == expected_lengths[node];
+            same = same && distance == expected_distances[node];
+        }
+        test_suite.test(same);
+        graph.BFS("0");
+        test_suite.test(!graph.visited("island") && graph.visited("0"));
+        graph.AddEdge(Edge("island", "0", 1));
+        test_suite.test(graph.DoesPathExist("island", std::to_string(kNodes - 1)) == (expected_lengths[kNodes - 1] > 0));
+    }
+
+    // A path inserted in shuffled order: reverse Cuthill-McKee numbers it from one end to the other.
+    const uint32_t kPathNodes = 1000;
+    std::vector<uint32_t> shuffled(kPathNodes);
+    for (uint32_t i = 0; i < kPathNodes; i++) shuffled[i] = i * 7919 % kPathNodes;
+    std::vector<std::pair<uint32_t, uint32_t>> path_edges;
+    for (uint32_t i = 0; i + 1 < kPathNodes; i++) path_edges.push_back({shuffled[i], shuffled[i + 1]});
+    CompressedAdjacency path;
+    path.Build(kPathNodes, path_edges, AdjacencyDirection::kBoth);
+    std::vector<uint32_t> order, rank(kPathNodes);
+    ReverseCuthillMcKeeOrder(path, nullptr, &order);
+    test_suite.test(order.size() == kPathNodes);
+    for (uint32_t i = 0; i < order.size(); i++) rank[order[i]] = i;
+    bool consecutive = true;
+    for (const auto& edge : path_edges) {
+        consecutive = consecutive && (rank[edge.first] + 1 == rank[edge.second] || rank[edge.second] + 1 == rank[edge.first]);
+    }
+    test_suite.test(consecutive);
+    test_suite.TestResults();
+}
+
+/**
+* Test that a versioned undirected graph answers like a graph of the same edges, whether the edges of its latest
+* version sit in the overlay, in both directions, or were compacted into its base.
+*/
+void TestVersionedGraph(testing::Testing& test_suite) {
+    test_suite.init("versioned undirected graph");
+    const int kNodes = 300;
+    const std::vector<Edge> edges = testing::RandomEdges(kNodes, 450, 37);
+    VersionedGraph<Graph> versioned(std::vector<Edge>(edges.begin(), edges.begin() + 150));
+    for (size_t i = 150; i < edges.size(); i++) {
+        versioned.AddEdge(edges[i]);
+        if (i % 100 == 0) versioned.Publish();
+    }
+    versioned.AddEdge(Edge("new", "0", 1));
+    versioned.Publish();
+    Graph expected_graph(edges);
+    expected_graph.AddEdge(Edge("new", "0", 1));
+
+    const auto same_answers = [&](const VersionedGraph<Graph>::Version& version) {
+        TraversalContext context, target_context;
+        const std::vector<std::string> neighbors = version.Neighbors("0");
+        bool same = version.V() == expected_graph.V() && version.E() == expected_graph.E() &&
+                    version.Neighbors("new") == std::vector<std::string>{"0"} &&
+                    std::count(neighbors.begin(), neighbors.end(), "new") == 1;
+        for (int node = 0; node < kNodes; node++) {
+            const std::string to = std::to_string(node);
+            same = same && version.ShortestPath("new", to, &context, &target_context).size() == expected_graph.ShortestPath("new", to).size();
+            same = same && version.DoesPathExist(to, "new", &context) == expected_graph.DoesPathExist("new", to);
+        }
+        return same;
+    };
+    const std::shared_ptr<const VersionedGraph<Graph>::Version> overlaid = versioned.Pin();
+    test_suite.test(overlaid->base().E() == 150 && same_answers(*overlaid));
+    versioned.Compact();
+    test_suite.test(versioned.Pin()->base().E() == expected_graph.E() && same_answers(*versioned.Pin()));
+    test_suite.TestResults();
+}
+
 }  // namespace graph
 
 int main () {
@@ -108,6 +673,20 @@ int main () {
   graph::TestPathCreationForNodesWithDFS(test_suite);
   graph::TestPathCreationForNodesWithDFSIterative(test_suite);
   graph::TestPathCreationForNodesWithBFS(test_suite);
+  graph::TestTraversalAfterFreeze(test_suite);
+  graph::TestTraversalWithContext(test_suite);
+  graph::TestDirectionOptimizingBFS(test_suite);
+  graph::TestParallelBFS(test_suite);
+  graph::TestBatchPathExists(test_suite);
+  graph::TestShortestPath(test_suite);
+  graph::TestWeightedShortestPaths(test_suite);
+  graph::TestDeepChainDFS(test_suite);
+  graph::TestSnapshot(test_suite);
+  graph::TestLoadEdgeList(test_suite);
+  graph::TestTraversalPathTrees(test_suite);
+  graph::TestConcurrentQueries(test_suite);
+  graph::TestVertexReordering(test_suite);
+  graph::TestVersionedGraph(test_suite);
 
   test_suite.PrintStats();
 }
\ No newline at end of file
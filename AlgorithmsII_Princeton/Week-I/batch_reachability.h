@@ -0,0 +1,91 @@
+#ifndef BATCH_REACHABILITY_H_
+#define BATCH_REACHABILITY_H_
+
+#include "compressed_adjacency.h"
+#include "strong_components.h"
+#include "traversal_context.h"
+#include "vertex_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Answer (source, target) reachability queries over dense ids, 64 distinct sources per pass. The adjacency is first
+// condensed into its strongly connected components, which Tarjan's algorithm numbers in reverse topological order.
+// Every component then carries a 64 bit mask of the sources of the batch that reach it, and one sweep from the highest
+// source component down to component 0 pushes each nonzero mask to the successors, so a pass expands every reached
+// component once for all 64 sources. Queries with an endpoint of kNoVertex are answered false. Resets context.
+inline void BatchReachability(const CompressedAdjacency& adjacency, const std::vector<std::pair<uint32_t, uint32_t>>& queries,
+                              TraversalContext* context, std::vector<bool>* answers) {
+    const uint32_t kLanes = 64;
+
+    answers->assign(queries.size(), false);
+    std::vector<size_t> by_source;
+    for (size_t query = 0; query < queries.size(); query++) {
+        if (queries[query].first != kNoVertex && queries[query].second != kNoVertex) {
+            by_source.push_back(query);
+        }
+    }
+    if (by_source.empty()) {
+        return;
+    }
+
+    std::vector<uint32_t> component;
+    const uint32_t num_components = TarjanComponents(adjacency, context, &component);
+    std::vector<std::pair<uint32_t, uint32_t>> condensed_edges;
+    for (uint32_t node = 0; node < adjacency.V(); node++) {
+        for (const uint32_t* neighbor = adjacency.begin(node); neighbor != adjacency.end(node); neighbor++) {
+            if (component[node] != component[*neighbor]) {
+                condensed_edges.push_back({component[node], component[*neighbor]});
+            }
+        }
+    }
+    CompressedAdjacency condensed;
+    condensed.Build(num_components, condensed_edges, AdjacencyDirection::kOut);
+
+    // Queries grouped by source component, so that each pass takes the next 64 distinct sources.
+    std::sort(by_source.begin(), by_source.end(), [&](size_t a, size_t b) {
+        return component[queries[a].first] < component[queries[b].first];
+    });
+    std::vector<uint64_t> reached(num_components, 0);
+    size_t batch_begin = 0;
+    while (batch_begin < by_source.size()) {
+        size_t batch_end = batch_begin;
+        uint32_t lanes = 0;
+        uint32_t highest = 0;
+        while (batch_end < by_source.size()) {
+            const uint32_t source = component[queries[by_source[batch_end]].first];
+            if (batch_end == batch_begin || source != component[queries[by_source[batch_end - 1]].first]) {
+                if (lanes == kLanes) {
+                    break;
+                }
+                reached[source] |= uint64_t(1) << lanes++;
+                highest = source;
+            }
+            batch_end++;
+        }
+
+        for (uint32_t c = highest + 1; c-- > 0; ) {
+            if (reached[c] == 0) {
+                continue;
+            }
+            for (const uint32_t* successor = condensed.begin(c); successor != condensed.end(c); successor++) {
+                reached[*successor] |= reached[c];
+            }
+        }
+
+        lanes = 0;
+        for (size_t i = batch_begin; i < batch_end; i++) {
+            const uint32_t source = component[queries[by_source[i]].first];
+            if (i > batch_begin && source != component[queries[by_source[i - 1]].first]) {
+                lanes++;
+            }
+            (*answers)[by_source[i]] = (reached[component[queries[by_source[i]].second]] >> lanes) & 1;
+        }
+        std::fill(reached.begin(), reached.begin() + highest + 1, 0);
+        batch_begin = batch_end;
+    }
+}
+
+#endif /* BATCH_REACHABILITY_H_ */
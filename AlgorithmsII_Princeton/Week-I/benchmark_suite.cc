@@ -0,0 +1,244 @@
+#include "UndirectedGraphs/connected_components.h"
+#include "DirectedGraphs/topological_sort.h"
+#include "benchmark_utils.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace suite {
+
+// Seconds of every (generator, graph, operation) of a baseline run.
+typedef std::map<std::tuple<std::string, std::string, std::string>, double> Baseline;
+
+/**
+* Writes one CSV row per timed operation to stdout, and, when a baseline is given, how the time compares to the
+* baseline's to stderr, so that stdout stays machine-readable.
+*/
+class Recorder {
+    public:
+    Recorder(const Baseline& baseline, int repeats) : baseline_(baseline), repeats_(std::max(1, repeats)) {}
+
+    static void PrintHeader() {
+        std::cout << "generator,graph,vertices,edges,operation,seconds,edges_per_second,peak_rss_bytes" << std::endl;
+    }
+
+    /**
+    * Time run, the best of repeats runs unless once is set, and write its row. edges is the count of edges the
+    * operation processes, for the rate.
+    */
+    void Time(const std::string& generator, const std::string& graph, int vertices, int edges, const std::string& operation,
+              bool once, const std::function<void()>& run) const {
+        double seconds = 0;
+        for (int repeat = 0; repeat < (once ? 1 : repeats_); repeat++) {
+            benchmark::Timer timer;
+            run();
+            seconds = repeat == 0 ? timer.Seconds() : std::min(seconds, timer.Seconds());
+        }
+        // An operation faster than the clock resolution has no meaningful rate, so its rate is left empty.
+        std::cout << generator << "," << graph << "," << vertices << "," << edges << "," << operation << ","
+                  << std::fixed << std::setprecision(6) << seconds << ",";
+        if (seconds > 0) {
+            std::cout << std::setprecision(0) << edges / seconds;
+        }
+        std::cout << "," << benchmark::PeakRssBytes() << std::endl;
+        const auto base = baseline_.find(std::make_tuple(generator, graph, operation));
+        if (base != baseline_.end() && base->second > 0 && seconds > 0) {
+            std::cerr << std::left << std::setw(44) << generator + " " + graph + " " + operation << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(8) << base->second / seconds
+                      << "x baseline speed" << std::endl;
+        }
+    }
+
+    private:
+    const Baseline& baseline_;
+    const int repeats_;
+};
+
+/**
+* Read the seconds of every row of a CSV file written by an earlier run. Returns false if the file cannot be read.
+*/
+bool ReadBaseline(const std::string& path, Baseline* baseline) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        for (std::string field; std::getline(row, field, ','); ) fields.push_back(field);
+        if (fields.size() >= 6) {
+            (*baseline)[std::make_tuple(fields[0], fields[1], fields[4])] = std::atof(fields[5].c_str());
+        }
+    }
+    return true;
+}
+
+/**
+* Count of distinct vertex ids among edges.
+*/
+int CountVertices(const std::vector<Edge>& edges) {
+    std::unordered_set<std::string> ids;
+    for (const Edge& edge : edges) {
+        ids.insert(edge.from());
+        ids.insert(edge.to());
+    }
+    return ids.size();
+}
+
+/**
+* Time construction (one AddEdge per edge), Freeze, and BFS, DFS and DFSIterative from the first vertex of edges on the
+* edges as an undirected graph, then GetConnectedComponents.
+*/
+void BenchmarkUndirected(const std::string& generator, const std::vector<Edge>& edges, const Recorder& recorder) {
+    const int vertices = CountVertices(edges);
+    const std::string& source = edges.front().from();
+    {
+        std::unique_ptr<graph::Graph> built;
+        recorder.Time(generator, "undirected", vertices, edges.size(), "construction", true, [&]() {
+            built.reset(new graph::Graph(edges));
+        });
+        recorder.Time(generator, "undirected", vertices, edges.size(), "freeze", true, [&]() { built->Freeze(); });
+        const graph::Graph& g = *built;
+        TraversalContext context;
+        recorder.Time(generator, "undirected", vertices, edges.size(), "bfs", false, [&]() { g.BFS(source, &context); });
+        recorder.Time(generator, "undirected", vertices, edges.size(), "dfs", false, [&]() { g.DFS(source, &context); });
+        recorder.Time(generator, "undirected", vertices, edges.size(), "dfs_iterative", false, [&]() {
+            g.DFSIterative(source, &context);
+        });
+    }
+    graph::ConnectedComponents components(edges);
+    components.Freeze();
+    TraversalContext context;
+    recorder.Time(generator, "undirected", vertices, edges.size(), "connected_components", false, [&]() {
+        components.GetConnectedComponents(&context);
+    });
+}
+
+/**
+* Time construction (one AddEdge per edge), Freeze, and BFS and DFS from the first vertex of edges on the edges as a
+* directed graph, then IsCyclic and TopologicallySorted if the graph is acyclic: on a cyclic graph both stop at the
+* first back edge, so their time says nothing about the graph and would only add noise to the comparisons.
+*/
+void BenchmarkDirected(const std::string& generator, const std::vector<Edge>& edges, const Recorder& recorder) {
+    const int vertices = CountVertices(edges);
+    const std::string& source = edges.front().from();
+    std::unique_ptr<directed_graph::TopologicalSort> built;
+    recorder.Time(generator, "directed", vertices, edges.size(), "construction", true, [&]() {
+        built.reset(new directed_graph::TopologicalSort(edges));
+    });
+    recorder.Time(generator, "directed", vertices, edges.size(), "freeze", true, [&]() { built->Freeze(); });
+    const directed_graph::TopologicalSort& dg = *built;
+    TraversalContext context;
+    recorder.Time(generator, "directed", vertices, edges.size(), "bfs", false, [&]() { dg.BFS(source, &context); });
+    recorder.Time(generator, "directed", vertices, edges.size(), "dfs", false, [&]() { dg.DFS(source, &context); });
+    if (dg.IsCyclic(&context)) {
+        std::cerr << generator << " is cyclic: skipping is_cyclic and topologically_sorted" << std::endl;
+        return;
+    }
+    recorder.Time(generator, "directed", vertices, edges.size(), "is_cyclic", false, [&]() { dg.IsCyclic(&context); });
+    recorder.Time(generator, "directed", vertices, edges.size(), "topologically_sorted", false, [&]() {
+        dg.TopologicallySorted(&context);
+    });
+}
+
+/**
+* Edges of the named generator for about 2^scale vertices and edge_factor edges per vertex; empty for an unknown name.
+*/
+std::vector<Edge> Generate(const std::string& generator, int scale, int edge_factor) {
+    const int num_vertices = 1 << scale;
+    if (generator == "rmat") return benchmark::RMatEdges(scale, edge_factor, 1);
+    if (generator == "er") return benchmark::RandomEdges(num_vertices, edge_factor * num_vertices, 1);
+    if (generator == "grid") return benchmark::GridEdges(1 << (scale / 2));
+    if (generator == "chain") return benchmark::ChainEdges(num_vertices);
+    if (generator == "dag") {
+        const int num_layers = 1 << (scale / 2);
+        return benchmark::LayeredDagEdges(num_layers, num_vertices / num_layers, edge_factor, 1);
+    }
+    std::cerr << "Unknown generator " << generator << std::endl;
+    return {};
+}
+
+/**
+* Generate the graph and run both benchmarks on it. Where fork is available this runs in a child process, so that the
+* peak RSS of every generator is its own rather than the largest of the generators before it.
+*/
+void RunGenerator(const std::string& generator, int scale, int edge_factor, const Recorder& recorder) {
+    const auto run = [&]() {
+        const std::vector<Edge> edges = Generate(generator, scale, edge_factor);
+        if (edges.empty()) return;
+        BenchmarkUndirected(generator, edges, recorder);
+        BenchmarkDirected(generator, edges, recorder);
+    };
+#if defined(__unix__) || defined(__APPLE__)
+    std::cout.flush();
+    std::cerr.flush();
+    const pid_t child = fork();
+    if (child == 0) {
+        run();
+        std::cout.flush();
+        std::cerr.flush();
+        _exit(0);
+    }
+    if (child > 0) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        return;
+    }
+#endif
+    run();
+}
+
+}  // namespace suite
+
+/**
+* Usage: benchmark_suite [scale] [generators] [baseline.csv] [edge factor] [repeats]
+* Generates each graph of the comma separated generators (rmat, er, grid, chain and dag; all by default) with about
+* 2^scale vertices (16 by default) and edge factor edges per vertex (8 by default), and prints one CSV row per
+* operation to stdout. Save a run to a file and pass it as the baseline of a later run to see its speed relative to
+* that run on stderr. Traversals report the best of repeats runs (3 by default).
+*/
+int main(int argc, char** argv) {
+    const int scale = argc > 1 ? std::atoi(argv[1]) : 16;
+    const std::string generators = argc > 2 ? argv[2] : "rmat,er,grid,chain,dag";
+    suite::Baseline baseline;
+    if (argc > 3 && std::string(argv[3]) != "" && std::string(argv[3]) != "-" && !suite::ReadBaseline(argv[3], &baseline)) {
+        return 1;
+    }
+    const int edge_factor = argc > 4 ? std::atoi(argv[4]) : 8;
+    const int repeats = argc > 5 ? std::atoi(argv[5]) : 3;
+    if (scale < 1 || scale > 30 || edge_factor < 1) {
+        std::cerr << "Scale must be in [1, 30] and edge factor positive" << std::endl;
+        return 1;
+    }
+    if ((static_cast<int64_t>(edge_factor) << scale) > INT_MAX) {
+        std::cerr << "Edge factor * 2^scale must not exceed " << INT_MAX << " edges" << std::endl;
+        return 1;
+    }
+
+    const suite::Recorder recorder(baseline, repeats);
+    suite::Recorder::PrintHeader();
+    std::stringstream names(generators);
+    for (std::string generator; std::getline(names, generator, ','); ) {
+        suite::RunGenerator(generator, scale, edge_factor, recorder);
+    }
+}
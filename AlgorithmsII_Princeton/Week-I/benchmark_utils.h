@@ -0,0 +1,177 @@
+#ifndef BENCHMARK_UTILS_H_
+#define BENCHMARK_UTILS_H_
+
+#include "edge.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace benchmark {
+
+class Timer {
+    public:
+    Timer() : start_(std::chrono::steady_clock::now()) {}
+
+    /**
+    * Seconds elapsed since the timer was created.
+    */
+    double Seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    private:
+    const std::chrono::steady_clock::time_point start_;
+};
+
+/**
+* Edges between num_edges uniformly random pairs of vertices with ids "0" .. "num_vertices - 1" and weights in [1, 100].
+*/
+std::vector<Edge> RandomEdges(int num_vertices, int num_edges, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+    std::uniform_int_distribution<int> weight(1, 100);
+    std::vector<Edge> edges;
+    edges.reserve(num_edges);
+    for (int i = 0; i < num_edges; i++) {
+        edges.push_back(Edge(std::to_string(vertex(generator)), std::to_string(vertex(generator)), weight(generator)));
+    }
+    return edges;
+}
+
+/**
+* Edges of an R-MAT graph (Chakrabarti et al.) with 2^scale vertices and edge_factor * 2^scale edges: each edge picks
+* its quadrant of the adjacency matrix scale times with the Graph500 probabilities a = 0.57, b = c = 0.19, d = 0.05,
+* giving the skewed degrees and communities of real networks. Vertex ids are then shuffled, as in Graph500, so that
+* the high degree vertices are not the low ids. Weights are in [1, 100].
+*/
+std::vector<Edge> RMatEdges(int scale, int edge_factor, unsigned seed) {
+    const double kA = 0.57, kB = 0.19, kC = 0.19;
+    const int num_vertices = 1 << scale;
+    const int64_t num_edges = static_cast<int64_t>(edge_factor) * num_vertices;
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> quadrant(0.0, 1.0);
+    std::uniform_int_distribution<int> weight(1, 100);
+    std::vector<int> label(num_vertices);
+    for (int v = 0; v < num_vertices; v++) label[v] = v;
+    std::shuffle(label.begin(), label.end(), generator);
+    std::vector<Edge> edges;
+    edges.reserve(num_edges);
+    for (int64_t i = 0; i < num_edges; i++) {
+        int from = 0, to = 0;
+        for (int bit = 0; bit < scale; bit++) {
+            const double p = quadrant(generator);
+            from = 2 * from + (p >= kA + kB);
+            to = 2 * to + ((p >= kA && p < kA + kB) || p >= kA + kB + kC);
+        }
+        edges.push_back(Edge(std::to_string(label[from]), std::to_string(label[to]), weight(generator)));
+    }
+    return edges;
+}
+
+/**
+* Edges of a side x side grid, each vertex row * side + column joined to its right and lower neighbors, with weight 1.
+*/
+std::vector<Edge> GridEdges(int side) {
+    std::vector<Edge> edges;
+    for (int row = 0; row < side; row++) {
+        for (int column = 0; column < side; column++) {
+            const std::string node = std::to_string(row * side + column);
+            if (column + 1 < side) edges.push_back(Edge(node, std::to_string(row * side + column + 1), 1));
+            if (row + 1 < side) edges.push_back(Edge(node, std::to_string((row + 1) * side + column), 1));
+        }
+    }
+    return edges;
+}
+
+/**
+* Edges of the path "0" -> "1" -> ... -> "num_vertices - 1", with weight 1: as deep as a graph gets.
+*/
+std::vector<Edge> ChainEdges(int num_vertices) {
+    std::vector<Edge> edges;
+    edges.reserve(num_vertices);
+    for (int v = 1; v < num_vertices; v++) {
+        edges.push_back(Edge(std::to_string(v - 1), std::to_string(v), 1));
+    }
+    return edges;
+}
+
+/**
+* Edges of a layered DAG of num_layers layers of width vertices, vertex layer * width + i: every vertex past the first
+* layer depends on edges_per_vertex random vertices of the layer before, like the stages of a build or a pipeline.
+* Weights are in [1, 100].
+*/
+std::vector<Edge> LayeredDagEdges(int num_layers, int width, int edges_per_vertex, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> column(0, width - 1);
+    std::uniform_int_distribution<int> weight(1, 100);
+    std::vector<Edge> edges;
+    edges.reserve(static_cast<size_t>(num_layers) * width * edges_per_vertex);
+    for (int layer = 1; layer < num_layers; layer++) {
+        for (int i = 0; i < width; i++) {
+            const std::string node = std::to_string(layer * width + i);
+            for (int j = 0; j < edges_per_vertex; j++) {
+                edges.push_back(Edge(std::to_string((layer - 1) * width + column(generator)), node, weight(generator)));
+            }
+        }
+    }
+    return edges;
+}
+
+/**
+* Print one result line: name, seconds, and edges processed per second.
+*/
+void Report(const std::string& name, double seconds, double edges) {
+    std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(4)
+              << std::setw(10) << seconds << " s" << std::setprecision(1) << std::setw(16) << edges / seconds / 1e6
+              << " M edges/s" << std::endl;
+}
+
+/**
+* Bytes currently allocated on the heap, including large blocks the allocator maps directly; 0 where glibc's allocator
+* statistics are not available.
+*/
+size_t HeapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+/**
+* Largest resident set size the process has had so far, in bytes; 0 where getrusage is not available.
+*/
+size_t PeakRssBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes.
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+}  // namespace benchmark
+
+#endif /* BENCHMARK_UTILS_H_ */
@@ -0,0 +1,108 @@
+#ifndef BIDIRECTIONAL_BFS_H_
+#define BIDIRECTIONAL_BFS_H_
+
+#include "compressed_adjacency.h"
+#include "traversal_context.h"
+#include "vertex_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Shortest (fewest edges) path from source to target among num_vertices dense ids, searching forward from source and
+// backward from target: for_each_neighbor(side, v, visit) calls visit(u) for every out-neighbor (side 0) or in-neighbor
+// (side 1, the same for undirected graphs) u of v, and stops early once visit returns false. Each step expands a whole
+// level of the side with the smaller frontier and the search stops at the first edge joining the two sides, so it only
+// explores about the balls of half the distance around both ends. Fills path with the vertices from source to target
+// and returns true, or returns false if target cannot be reached. Resets both contexts.
+//
+// The first joining edge found closes a shortest path: when a level at distance d of one side is expanded, every
+// vertex the other side has reached at a distance below its last level was already expanded, so any edge into it would
+// have joined the sides on an earlier step.
+template <typename ForEachNeighbor>
+inline bool BidirectionalBFS(uint32_t num_vertices, const ForEachNeighbor& for_each_neighbor, uint32_t source, uint32_t target,
+                             TraversalContext* source_context, TraversalContext* target_context, std::vector<uint32_t>* path) {
+    path->clear();
+    source_context->Reset(num_vertices);
+    target_context->Reset(num_vertices);
+    if (source == target) {
+        path->push_back(source);
+        return true;
+    }
+    // Each side keeps every vertex it visited in BFS order; its current level is queue[level_begin, queue.size()).
+    TraversalContext* contexts[2] = {source_context, target_context};
+    size_t level_begin[2] = {0, 0};
+    source_context->Visit(source, source);
+    source_context->buffer()->push_back(source);
+    target_context->Visit(target, target);
+    target_context->buffer()->push_back(target);
+
+    // Ends of the joining edge: the last vertex reached from source and the first one reached from target.
+    uint32_t source_end = kNoVertex, target_end = kNoVertex;
+    while (source_end == kNoVertex) {
+        const size_t source_level = source_context->buffer()->size() - level_begin[0];
+        const size_t target_level = target_context->buffer()->size() - level_begin[1];
+        if (source_level == 0 || target_level == 0) {
+            return false;
+        }
+        const int side = source_level <= target_level ? 0 : 1;
+        TraversalContext* context = contexts[side];
+        const TraversalContext* other = contexts[1 - side];
+        std::vector<uint32_t>& queue = *context->buffer();
+        const size_t level_end = queue.size();
+        for (size_t i = level_begin[side]; i < level_end && source_end == kNoVertex; i++) {
+            const uint32_t node = queue[i];
+            for_each_neighbor(side, node, [&](uint32_t neighbor) {
+                if (other->visited(neighbor)) {
+                    source_end = side == 0 ? node : neighbor;
+                    target_end = side == 0 ? neighbor : node;
+                    return false;
+                }
+                if (!context->visited(neighbor)) {
+                    context->Visit(neighbor, node);
+                    queue.push_back(neighbor);
+                }
+                return true;
+            });
+        }
+        level_begin[side] = level_end;
+    }
+
+    for (uint32_t node = source_end; ; node = source_context->parent(node)) {
+        path->push_back(node);
+        if (node == source) break;
+    }
+    std::reverse(path->begin(), path->end());
+    for (uint32_t node = target_end; ; node = target_context->parent(node)) {
+        path->push_back(node);
+        if (node == target) break;
+    }
+    return true;
+}
+
+namespace bidirectional_bfs {
+
+// Neighbors of a vertex in a pair of compressed adjacencies, out-edges then in-edges, for BidirectionalBFS.
+struct AdjacencyNeighbors {
+    const CompressedAdjacency* adjacencies[2];
+
+    template <typename Visit>
+    void operator()(int side, uint32_t v, Visit visit) const {
+        const CompressedAdjacency& adjacency = *adjacencies[side];
+        for (const uint32_t* neighbor = adjacency.begin(v); neighbor != adjacency.end(v); neighbor++) {
+            if (!visit(*neighbor)) return;
+        }
+    }
+};
+
+}  // namespace bidirectional_bfs
+
+// BidirectionalBFS over the out-edges forward and the in-edges backward (the same adjacency for undirected graphs).
+inline bool BidirectionalBFS(const CompressedAdjacency& forward, const CompressedAdjacency& backward, uint32_t source,
+                             uint32_t target, TraversalContext* source_context, TraversalContext* target_context,
+                             std::vector<uint32_t>* path) {
+    const bidirectional_bfs::AdjacencyNeighbors neighbors = {{&forward, &backward}};
+    return BidirectionalBFS(forward.V(), neighbors, source, target, source_context, target_context, path);
+}
+
+#endif /* BIDIRECTIONAL_BFS_H_ */
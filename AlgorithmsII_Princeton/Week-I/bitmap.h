@@ -0,0 +1,29 @@
+#ifndef BITMAP_H_
+#define BITMAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed set of bits over dense vertex ids, one bit per vertex.
+class Bitmap {
+  private:
+    std::vector<uint64_t> words_;
+
+  public:
+    // Make room for at least num_bits bits; newly added bits are cleared.
+    void Resize(uint32_t num_bits) {
+        const size_t num_words = (static_cast<size_t>(num_bits) + 63) / 64;
+        if (words_.size() < num_words) {
+            words_.resize(num_words, 0);
+        }
+    }
+
+    bool Test(uint32_t bit) const { return (words_[bit >> 6] >> (bit & 63)) & 1; }
+
+    void Set(uint32_t bit) { words_[bit >> 6] |= uint64_t(1) << (bit & 63); }
+
+    void Clear(uint32_t bit) { words_[bit >> 6] &= ~(uint64_t(1) << (bit & 63)); }
+};
+
+#endif /* BITMAP_H_ */
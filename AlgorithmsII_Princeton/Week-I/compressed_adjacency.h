@@ -0,0 +1,143 @@
+#ifndef COMPRESSED_ADJACENCY_H_
+#define COMPRESSED_ADJACENCY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Which endpoint of each (from, to) pair an adjacency is built for.
+enum class AdjacencyDirection {
+    kOut,   // from -> to
+    kIn,    // to -> from
+    kBoth   // both, for undirected graphs
+};
+
+// Compressed sparse row adjacency over dense vertex ids: the neighbors of v are
+// targets_[offsets_[v] .. offsets_[v + 1]), kept in edge insertion order, optionally with the edge weights alongside.
+// The arrays are either owned, when built, or external memory such as a mapped snapshot file, set by Map().
+class CompressedAdjacency {
+  private:
+    std::vector<uint32_t> offsets_storage_;
+    std::vector<uint32_t> targets_storage_;
+    std::vector<int> weights_storage_;
+
+    // Arrays read by the accessors: the storage vectors or external memory. weights_ is null unless the adjacency has
+    // the weight of each entry of targets_.
+    const uint32_t* offsets_;
+    const uint32_t* targets_;
+    const int* weights_;
+    uint32_t num_vertices_;
+    bool mapped_;
+
+    // Point the arrays at the storage vectors.
+    void UseStorage(bool weighted) {
+        offsets_ = offsets_storage_.data();
+        targets_ = targets_storage_.data();
+        weights_ = weighted ? weights_storage_.data() : nullptr;
+        num_vertices_ = static_cast<uint32_t>(offsets_storage_.size() - 1);
+        mapped_ = false;
+    }
+
+    // Point the arrays at the copied storage vectors, or at the external memory of other if it is mapped.
+    void CopyArrays(const CompressedAdjacency& other) {
+        if (other.mapped_) {
+            Map(other.num_vertices_, other.offsets_, other.targets_, other.weights_);
+        } else {
+            UseStorage(other.weights_ != nullptr);
+        }
+    }
+
+  public:
+    CompressedAdjacency() : offsets_storage_(1, 0) { UseStorage(false); }
+
+    // Copies share the external memory of a mapped adjacency, which must outlive them too.
+    CompressedAdjacency(const CompressedAdjacency& other)
+        : offsets_storage_(other.offsets_storage_), targets_storage_(other.targets_storage_), weights_storage_(other.weights_storage_) {
+        CopyArrays(other);
+    }
+
+    CompressedAdjacency& operator=(const CompressedAdjacency& other) {
+        offsets_storage_ = other.offsets_storage_;
+        targets_storage_ = other.targets_storage_;
+        weights_storage_ = other.weights_storage_;
+        CopyArrays(other);
+        return *this;
+    }
+
+    // Build the adjacency by counting degrees, prefix summing them into offsets and scattering the targets.
+    void Build(uint32_t num_vertices, const std::vector<std::pair<uint32_t, uint32_t>>& edges, AdjacencyDirection direction) {
+        Build(num_vertices, edges, nullptr, direction);
+    }
+
+    // Build the adjacency and keep weights[i], if weights is not null, as the weight of every entry made for edges[i].
+    void Build(uint32_t num_vertices, const std::vector<std::pair<uint32_t, uint32_t>>& edges, const std::vector<int>* weights,
+               AdjacencyDirection direction) {
+        std::vector<uint32_t>& offsets = offsets_storage_;
+        std::vector<uint32_t>& targets = targets_storage_;
+        offsets.assign(num_vertices + 1, 0);
+        for (const auto& edge : edges) {
+            if (direction != AdjacencyDirection::kIn) offsets[edge.first + 1]++;
+            if (direction != AdjacencyDirection::kOut) offsets[edge.second + 1]++;
+        }
+        for (uint32_t v = 0; v < num_vertices; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        targets.resize(offsets[num_vertices]);
+        weights_storage_.resize(weights != nullptr ? targets.size() : 0);
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < edges.size(); i++) {
+            const auto& edge = edges[i];
+            if (direction != AdjacencyDirection::kIn) {
+                if (weights != nullptr) weights_storage_[cursor[edge.first]] = (*weights)[i];
+                targets[cursor[edge.first]++] = edge.second;
+            }
+            if (direction != AdjacencyDirection::kOut) {
+                if (weights != nullptr) weights_storage_[cursor[edge.second]] = (*weights)[i];
+                targets[cursor[edge.second]++] = edge.first;
+            }
+        }
+        UseStorage(weights != nullptr);
+    }
+
+    // Read the adjacency of num_vertices vertices from external arrays laid out like the owned ones (weights may be
+    // null), which must outlive the adjacency. Drops any owned arrays.
+    void Map(uint32_t num_vertices, const uint32_t* offsets, const uint32_t* targets, const int* weights) {
+        std::vector<uint32_t>().swap(offsets_storage_);
+        std::vector<uint32_t>().swap(targets_storage_);
+        std::vector<int>().swap(weights_storage_);
+        num_vertices_ = num_vertices;
+        offsets_ = offsets;
+        targets_ = targets;
+        weights_ = weights;
+        mapped_ = true;
+    }
+
+    // Whether the arrays are external memory set by Map().
+    bool mapped() const { return mapped_; }
+
+    // Raw arrays, for writing the adjacency out: V() + 1 offsets and E() targets, and E() weights or null.
+    const uint32_t* offsets() const { return offsets_; }
+    const uint32_t* targets() const { return targets_; }
+    const int* weights() const { return weights_; }
+
+    // Get count of vertices.
+    uint32_t V() const { return num_vertices_; }
+
+    // Get count of stored (directed) adjacency entries.
+    uint32_t E() const { return offsets_[num_vertices_]; }
+
+    // Get count of neighbors of v.
+    uint32_t Degree(uint32_t v) const { return offsets_[v + 1] - offsets_[v]; }
+
+    // First neighbor of v.
+    const uint32_t* begin(uint32_t v) const { return targets_ + offsets_[v]; }
+
+    // One past the last neighbor of v.
+    const uint32_t* end(uint32_t v) const { return targets_ + offsets_[v + 1]; }
+
+    // Weights of the edges to the neighbors of v, in the same order; only valid if built with weights.
+    const int* weight_begin(uint32_t v) const { return weights_ + offsets_[v]; }
+};
+
+#endif /* COMPRESSED_ADJACENCY_H_ */
@@ -0,0 +1,243 @@
+#ifndef DELTA_STEPPING_H_
+#define DELTA_STEPPING_H_
+
+#include "compressed_adjacency.h"
+#include "path_tree.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace delta_stepping {
+
+// Tentative distances and parents shared by the workers. The parent of a vertex is written under its lock together
+// with the distance, so that it always belongs to the final distance: the lock is only taken when a relaxation
+// improves the distance, which happens a few times per vertex.
+struct State {
+    std::unique_ptr<std::atomic<int64_t>[]> distance;
+    std::unique_ptr<std::atomic_flag[]> lock;
+    std::vector<uint32_t> parent;
+
+    // Last bucket each vertex was settled in, so it is queued for its heavy edges once.
+    std::unique_ptr<std::atomic<uint64_t>[]> settled_bucket;
+};
+
+// Most buckets kept in the cyclic array of a worker, however small delta is next to the largest weight.
+const uint64_t kMaxBuckets = 4096;
+
+// Vertices queued by one worker. Bucket b of the window [first, first + cyclic.size()), which starts at the bucket being
+// processed, is cyclic[b % cyclic.size()]; vertices queued for a bucket past the window wait in overflow.
+struct Buckets {
+    std::vector<std::vector<uint32_t>> cyclic;
+    std::vector<uint32_t> overflow;
+};
+
+// Relax the edges of node that are light (weight <= delta) or heavy, queueing every improved vertex in the local
+// bucket of its new distance, or in overflow if the bucket is at window_end or past it.
+inline void Relax(const CompressedAdjacency& adjacency, uint32_t node, int64_t delta, bool light, uint64_t window_end,
+                  State* state, Buckets* buckets) {
+    const int64_t node_distance = state->distance[node].load(std::memory_order_relaxed);
+    const int* weight = adjacency.weight_begin(node);
+    for (const uint32_t* neighbor = adjacency.begin(node); neighbor != adjacency.end(node); neighbor++, weight++) {
+        if ((*weight <= delta) != light) {
+            continue;
+        }
+        const int64_t distance = node_distance + *weight;
+        if (distance >= state->distance[*neighbor].load(std::memory_order_relaxed)) {
+            continue;
+        }
+        bool improved = false;
+        while (state->lock[*neighbor].test_and_set(std::memory_order_acquire)) {
+        }
+        if (distance < state->distance[*neighbor].load(std::memory_order_relaxed)) {
+            state->distance[*neighbor].store(distance, std::memory_order_relaxed);
+            state->parent[*neighbor] = node;
+            improved = true;
+        }
+        state->lock[*neighbor].clear(std::memory_order_release);
+        if (improved) {
+            const uint64_t bucket = static_cast<uint64_t>(distance / delta);
+            if (bucket < window_end) {
+                buckets->cyclic[bucket % buckets->cyclic.size()].push_back(*neighbor);
+            } else {
+                buckets->overflow.push_back(*neighbor);
+            }
+        }
+    }
+}
+
+// Move the entries of bucket, which is in the window, from the local buckets of every worker into out.
+inline void TakeBucket(ThreadPool* pool, std::vector<Buckets>* local_buckets, uint64_t bucket, std::vector<uint32_t>* out) {
+    std::vector<std::vector<uint32_t>> parts(local_buckets->size());
+    for (size_t worker = 0; worker < local_buckets->size(); worker++) {
+        std::vector<std::vector<uint32_t>>& cyclic = (*local_buckets)[worker].cyclic;
+        parts[worker].swap(cyclic[bucket % cyclic.size()]);
+    }
+    out->clear();
+    ParallelConcatenate(pool, &parts, out);
+}
+
+// Lowest bucket past the window ending at window_end that an overflow entry is still queued for, or UINT64_MAX. Drops
+// the entries of vertices that have since been queued at a lower distance, which the window already covered.
+inline uint64_t FirstOverflowBucket(ThreadPool* pool, std::vector<Buckets>* local_buckets, int64_t delta,
+                                    uint64_t window_end, const State& state) {
+    std::vector<uint64_t> first(local_buckets->size(), UINT64_MAX);
+    pool->ParallelFor(local_buckets->size(), 1, [&](size_t begin, size_t end, int) {
+        for (size_t worker = begin; worker < end; worker++) {
+            std::vector<uint32_t>& overflow = (*local_buckets)[worker].overflow;
+            size_t kept = 0;
+            for (const uint32_t node : overflow) {
+                const uint64_t bucket = static_cast<uint64_t>(state.distance[node].load(std::memory_order_relaxed) / delta);
+                if (bucket >= window_end) {
+                    overflow[kept++] = node;
+                    first[worker] = std::min(first[worker], bucket);
+                }
+            }
+            overflow.resize(kept);
+        }
+    });
+    return *std::min_element(first.begin(), first.end());
+}
+
+// Move the overflow entries queued for a bucket before window_end into the cyclic arrays.
+inline void RefillWindow(ThreadPool* pool, std::vector<Buckets>* local_buckets, int64_t delta, uint64_t window_end,
+                         const State& state) {
+    pool->ParallelFor(local_buckets->size(), 1, [&](size_t begin, size_t end, int) {
+        for (size_t worker = begin; worker < end; worker++) {
+            Buckets& buckets = (*local_buckets)[worker];
+            size_t kept = 0;
+            for (const uint32_t node : buckets.overflow) {
+                const uint64_t bucket = static_cast<uint64_t>(state.distance[node].load(std::memory_order_relaxed) / delta);
+                if (bucket < window_end) {
+                    buckets.cyclic[bucket % buckets.cyclic.size()].push_back(node);
+                } else {
+                    buckets.overflow[kept++] = node;
+                }
+            }
+            buckets.overflow.resize(kept);
+        }
+    });
+}
+
+}  // namespace delta_stepping
+
+// Single source shortest paths over an adjacency built with non-negative weights with Delta-stepping (Meyer and
+// Sanders). Vertices are kept in buckets of width delta by tentative distance and the lowest nonempty bucket is
+// processed in parallel phases: each phase relaxes the light edges (weight <= delta) of the bucket, which may refill it,
+// and once it stays empty the heavy edges of every vertex settled in it are relaxed, which only reach later buckets.
+// A small delta approaches Dijkstra's order with little parallelism per phase; a large one approaches Bellman-Ford with
+// more redundant relaxations. If delta is not positive, the largest weight divided by the average degree is used.
+//
+// Every queued vertex lies within the largest weight of the bucket being processed, so each worker keeps its buckets in
+// a cyclic array of ceil(max weight / delta) + 1 buckets (at most kMaxBuckets, past which vertices wait in an overflow
+// list until the window reaches them), whatever the distances. Bucket numbers are 64 bits wide.
+// Fills tree with the same distances as Dijkstra's algorithm; among equally short paths the parent may differ.
+inline void DeltaStepping(const CompressedAdjacency& adjacency, uint32_t source, int64_t delta, ThreadPool* pool, PathTree* tree) {
+    const uint32_t num_vertices = adjacency.V();
+    const uint64_t kNotSettled = UINT64_MAX;
+    int max_weight = 1;
+    for (uint32_t v = 0; v < num_vertices; v++) {
+        for (const int* weight = adjacency.weight_begin(v); weight != adjacency.weight_begin(v) + adjacency.Degree(v); weight++) {
+            max_weight = std::max(max_weight, *weight);
+        }
+    }
+    if (delta <= 0) {
+        delta = std::max<int64_t>(1, static_cast<int64_t>(max_weight) * num_vertices / std::max<uint32_t>(1, adjacency.E()));
+    }
+    const uint64_t num_buckets =
+        std::min<uint64_t>(delta_stepping::kMaxBuckets, max_weight / delta + (max_weight % delta != 0) + 1);
+
+    delta_stepping::State state;
+    state.distance.reset(new std::atomic<int64_t>[num_vertices]);
+    state.lock.reset(new std::atomic_flag[num_vertices]);
+    state.parent.resize(num_vertices);
+    state.settled_bucket.reset(new std::atomic<uint64_t>[num_vertices]);
+    pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            state.distance[v].store(kUnreached, std::memory_order_relaxed);
+            state.lock[v].clear(std::memory_order_relaxed);
+            state.settled_bucket[v].store(kNotSettled, std::memory_order_relaxed);
+        }
+    });
+    state.distance[source].store(0, std::memory_order_relaxed);
+    state.parent[source] = source;
+
+    // Buckets filled by each worker; bucket is taken from all of them at once.
+    std::vector<delta_stepping::Buckets> local_buckets(pool->size());
+    for (delta_stepping::Buckets& buckets : local_buckets) {
+        buckets.cyclic.resize(num_buckets);
+    }
+    std::vector<std::vector<uint32_t>> local_settled(pool->size());
+    std::vector<uint32_t> frontier(1, source), settled;
+    // Vertices handed out per chunk; a vertex can have many edges, so chunks are kept small.
+    const size_t kGrain = 64;
+    uint64_t bucket = 0;
+    while (true) {
+        const uint64_t window_end = bucket + num_buckets;
+        while (!frontier.empty()) {
+            pool->ParallelFor(frontier.size(), kGrain, [&](size_t begin, size_t end, int worker) {
+                for (size_t i = begin; i < end; i++) {
+                    const uint32_t node = frontier[i];
+                    // Entries left behind when a vertex moved to a lower bucket are skipped.
+                    if (static_cast<uint64_t>(state.distance[node].load(std::memory_order_relaxed) / delta) != bucket) {
+                        continue;
+                    }
+                    if (state.settled_bucket[node].exchange(bucket, std::memory_order_relaxed) != bucket) {
+                        local_settled[worker].push_back(node);
+                    }
+                    delta_stepping::Relax(adjacency, node, delta, true, window_end, &state, &local_buckets[worker]);
+                }
+            });
+            delta_stepping::TakeBucket(pool, &local_buckets, bucket, &frontier);
+        }
+
+        settled.clear();
+        ParallelConcatenate(pool, &local_settled, &settled);
+        pool->ParallelFor(settled.size(), kGrain, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                delta_stepping::Relax(adjacency, settled[i], delta, false, window_end, &state, &local_buckets[worker]);
+            }
+        });
+
+        uint64_t next_bucket = UINT64_MAX;
+        for (uint64_t b = bucket + 1; b < window_end && next_bucket == UINT64_MAX; b++) {
+            for (const delta_stepping::Buckets& buckets : local_buckets) {
+                if (!buckets.cyclic[b % num_buckets].empty()) {
+                    next_bucket = b;
+                    break;
+                }
+            }
+        }
+        if (next_bucket == UINT64_MAX) {
+            // The window is empty: move it to the first bucket still queued in overflow.
+            next_bucket = delta_stepping::FirstOverflowBucket(pool, &local_buckets, delta, window_end, state);
+            if (next_bucket == UINT64_MAX) {
+                break;
+            }
+        }
+        bucket = next_bucket;
+        // The window moved on; bring in the overflow entries it now covers.
+        for (const delta_stepping::Buckets& buckets : local_buckets) {
+            if (!buckets.overflow.empty()) {
+                delta_stepping::RefillWindow(pool, &local_buckets, delta, bucket + num_buckets, state);
+                break;
+            }
+        }
+        delta_stepping::TakeBucket(pool, &local_buckets, bucket, &frontier);
+    }
+
+    tree->Reset(num_vertices, source);
+    pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            const int64_t distance = state.distance[v].load(std::memory_order_relaxed);
+            if (distance != kUnreached) {
+                tree->Reach(v, distance, state.parent[v]);
+            }
+        }
+    });
+}
+
+#endif /* DELTA_STEPPING_H_ */
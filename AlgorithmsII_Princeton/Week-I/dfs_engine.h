@@ -0,0 +1,63 @@
+#ifndef DFS_ENGINE_H_
+#define DFS_ENGINE_H_
+
+#include "compressed_adjacency.h"
+#include "traversal_context.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace dfs {
+
+// Callback that ignores its arguments and lets the traversal go on; stands in for the callbacks a caller does not need.
+struct Continue {
+    bool operator()(uint32_t) const { return true; }
+    bool operator()(uint32_t, uint32_t) const { return true; }
+};
+
+}  // namespace dfs
+
+// Depth-first search from root over adjacency with an explicit stack, visiting neighbors in adjacency order just like
+// the recursive version would, so depth is bounded by heap memory instead of the call stack. The stack lives in
+// context, which the caller resets; vertices visited before the call are not entered again, so calling this for every
+// unvisited root gives a DFS forest. Callbacks return false to stop the search, in which case false is returned:
+//   pre_visit(v, parent)     when v is first reached, after it is marked visited (a root is its own parent);
+//   non_tree_edge(from, to)  for an edge to a vertex visited already; it is a back edge, closing a cycle, if to is
+//                            not context->done() yet (for a symmetric adjacency this includes the edge back to the
+//                            parent);
+//   post_visit(v)            once all neighbors of v are explored, after v is marked finished.
+template <typename PreVisit, typename NonTreeEdge, typename PostVisit>
+bool DepthFirstSearch(const CompressedAdjacency& adjacency, uint32_t root, TraversalContext* context,
+                      PreVisit pre_visit, NonTreeEdge non_tree_edge, PostVisit post_visit) {
+    std::vector<DFSFrame>& stack = *context->frames();
+    stack.clear();
+    context->Visit(root, root);
+    if (!pre_visit(root, root)) {
+        return false;
+    }
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+        const uint32_t node = stack.back().node;
+        if (stack.back().next_neighbor < adjacency.Degree(node)) {
+            const uint32_t neighbor = adjacency.begin(node)[stack.back().next_neighbor++];
+            if (!context->visited(neighbor)) {
+                context->Visit(neighbor, node);
+                if (!pre_visit(neighbor, node)) {
+                    return false;
+                }
+                stack.push_back({neighbor, 0});
+            } else if (!non_tree_edge(node, neighbor)) {
+                return false;
+            }
+            continue;
+        }
+        stack.pop_back();
+        context->Finish(node);
+        if (!post_visit(node)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif /* DFS_ENGINE_H_ */
@@ -0,0 +1,38 @@
+#ifndef DIJKSTRA_H_
+#define DIJKSTRA_H_
+
+#include "compressed_adjacency.h"
+#include "indexed_heap.h"
+#include "path_tree.h"
+#include "vertex_index.h"
+
+#include <cstdint>
+
+// Dijkstra's algorithm from source over an adjacency built with non-negative weights, filling tree with the distance
+// and parent of every vertex reached. If target is not kNoVertex the search stops as soon as target is settled, and
+// only the distances of settled vertices are final. heap is scratch space, left empty.
+inline void Dijkstra(const CompressedAdjacency& adjacency, uint32_t source, uint32_t target, IndexedHeap* heap, PathTree* tree) {
+    tree->Reset(adjacency.V(), source);
+    heap->Resize(adjacency.V());
+    heap->Clear();
+    heap->PushOrDecrease(source, 0);
+    while (!heap->empty()) {
+        const std::pair<int64_t, uint32_t> top = heap->Pop();
+        const uint32_t node = top.second;
+        if (node == target) {
+            heap->Clear();
+            return;
+        }
+        const int* weight = adjacency.weight_begin(node);
+        for (const uint32_t* neighbor = adjacency.begin(node); neighbor != adjacency.end(node); neighbor++, weight++) {
+            const int64_t distance = top.first + *weight;
+            if (!tree->reached(*neighbor) || distance < tree->distance(*neighbor)) {
+                // A settled vertex never improves, since weights are not negative, so it is never pushed again.
+                tree->Reach(*neighbor, distance, node);
+                heap->PushOrDecrease(*neighbor, distance);
+            }
+        }
+    }
+}
+
+#endif /* DIJKSTRA_H_ */
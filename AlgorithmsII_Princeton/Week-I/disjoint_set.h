@@ -0,0 +1,85 @@
+#ifndef DISJOINT_SET_H_
+#define DISJOINT_SET_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Disjoint-set forest over dense ids 0..size()-1 with path compression and union by rank, so any sequence of
+// operations costs near-constant amortized time per operation.
+class DisjointSet {
+  private:
+    std::vector<uint32_t> parent_;
+    std::vector<uint8_t> rank_;
+
+    // Count of elements in each set, only meaningful at set roots.
+    std::vector<uint32_t> set_size_;
+
+    uint32_t count_;
+
+  public:
+    DisjointSet() : count_(0) {}
+
+    // Grow to num_elements elements; each new element is a set of its own.
+    void Resize(uint32_t num_elements) {
+        for (uint32_t x = parent_.size(); x < num_elements; x++) {
+            parent_.push_back(x);
+            rank_.push_back(0);
+            set_size_.push_back(1);
+            count_++;
+        }
+    }
+
+    // Return the root of the set containing x, pointing every element on the way directly at the root.
+    uint32_t Find(uint32_t x) {
+        uint32_t root = x;
+        while (parent_[root] != root) {
+            root = parent_[root];
+        }
+        while (parent_[x] != root) {
+            const uint32_t next = parent_[x];
+            parent_[x] = root;
+            x = next;
+        }
+        return root;
+    }
+
+    // Return the root of the set containing x without changing the forest, so any number of threads can call it while
+    // none calls Find or Union. Union by rank keeps the walk to O(log size()) steps.
+    uint32_t Root(uint32_t x) const {
+        while (parent_[x] != x) {
+            x = parent_[x];
+        }
+        return x;
+    }
+
+    // Merge the sets containing a and b. Returns false if they were the same set already.
+    bool Union(uint32_t a, uint32_t b) {
+        a = Find(a);
+        b = Find(b);
+        if (a == b) {
+            return false;
+        }
+        if (rank_[a] < rank_[b]) {
+            std::swap(a, b);
+        }
+        parent_[b] = a;
+        set_size_[a] += set_size_[b];
+        if (rank_[a] == rank_[b]) {
+            rank_[a]++;
+        }
+        count_--;
+        return true;
+    }
+
+    // Get count of elements in the set containing x.
+    uint32_t SetSize(uint32_t x) const { return set_size_[Root(x)]; }
+
+    // Get count of disjoint sets.
+    uint32_t count() const { return count_; }
+
+    // Get count of elements.
+    uint32_t size() const { return static_cast<uint32_t>(parent_.size()); }
+};
+
+#endif /* DISJOINT_SET_H_ */
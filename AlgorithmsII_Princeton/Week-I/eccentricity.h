@@ -0,0 +1,312 @@
+#ifndef ECCENTRICITY_H_
+#define ECCENTRICITY_H_
+
+#include "compressed_adjacency.h"
+#include "disjoint_set.h"
+#include "thread_pool.h"
+#include "traversal_context.h"
+#include "vertex_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// Work done by one diameter or eccentricity computation. Distances count edges; weights are ignored.
+struct DiameterStats {
+    // Count of breadth-first searches run.
+    int bfs_passes;
+
+    // Bounds on the diameter when the computation stopped; equal once it is exact.
+    uint32_t lower_bound;
+    uint32_t upper_bound;
+};
+
+namespace eccentricity {
+
+// Breadth-first search from source over the component of source. Afterwards the buffer of context lists the component
+// in order of distance and distance holds the distance of every vertex in it. Returns the eccentricity of source.
+inline uint32_t Levels(const CompressedAdjacency& adjacency, uint32_t source, TraversalContext* context,
+                       std::vector<uint32_t>* distance) {
+    context->Reset(adjacency.V());
+    distance->resize(adjacency.V());
+    std::vector<uint32_t>& queue = *context->buffer();
+    context->Visit(source, source);
+    (*distance)[source] = 0;
+    queue.push_back(source);
+    for (size_t head = 0; head < queue.size(); head++) {
+        const uint32_t node = queue[head];
+        for (const uint32_t* neighbor = adjacency.begin(node); neighbor != adjacency.end(node); neighbor++) {
+            if (!context->visited(*neighbor)) {
+                context->Visit(*neighbor, node);
+                (*distance)[*neighbor] = (*distance)[node] + 1;
+                queue.push_back(*neighbor);
+            }
+        }
+    }
+    return (*distance)[queue.back()];
+}
+
+// Scratch state of one worker running searches.
+struct Worker {
+    TraversalContext context;
+    std::vector<uint32_t> distance;
+};
+
+// Connected components of adjacency, largest first, each as its vertex of highest degree and its size. A component of
+// size n has a diameter of at most n - 1, so small components can be skipped once the bound found is large enough; a
+// search from a vertex of high degree reaches the rest of its component in few levels, which makes a good first sweep.
+inline std::vector<std::pair<uint32_t, uint32_t>> Components(const CompressedAdjacency& adjacency) {
+    DisjointSet sets;
+    sets.Resize(adjacency.V());
+    for (uint32_t node = 0; node < adjacency.V(); node++) {
+        for (const uint32_t* neighbor = adjacency.begin(node); neighbor != adjacency.end(node); neighbor++) {
+            sets.Union(node, *neighbor);
+        }
+    }
+    std::vector<uint32_t> by_degree(adjacency.V());
+    std::iota(by_degree.begin(), by_degree.end(), 0);
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&](uint32_t a, uint32_t b) { return adjacency.Degree(a) > adjacency.Degree(b); });
+    std::vector<std::pair<uint32_t, uint32_t>> components;
+    std::vector<bool> seen(adjacency.V(), false);
+    for (const uint32_t node : by_degree) {
+        const uint32_t root = sets.Find(node);
+        if (!seen[root]) {
+            seen[root] = true;
+            components.push_back({node, sets.SetSize(root)});
+        }
+    }
+    std::stable_sort(components.begin(), components.end(),
+                     [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) { return a.second > b.second; });
+    return components;
+}
+
+// Set farthest to the elementwise maximum of itself and distance over component, or to distance if first.
+inline void FoldDistances(const std::vector<uint32_t>& component, const std::vector<uint32_t>& distance, bool first,
+                          std::vector<uint32_t>* farthest) {
+    for (const uint32_t node : component) {
+        (*farthest)[node] = first ? distance[node] : std::max((*farthest)[node], distance[node]);
+    }
+}
+
+// Vertex of component with the smallest farthest distance, ties going to higher degree.
+inline uint32_t MostCentral(const CompressedAdjacency& adjacency, const std::vector<uint32_t>& component,
+                            const std::vector<uint32_t>& farthest) {
+    uint32_t best = component[0];
+    for (const uint32_t node : component) {
+        if (farthest[node] < farthest[best] || (farthest[node] == farthest[best] && adjacency.Degree(node) > adjacency.Degree(best))) {
+            best = node;
+        }
+    }
+    return best;
+}
+
+}  // namespace eccentricity
+
+// Lower bound on the diameter (the longest shortest path within a component) by a double sweep in every component
+// that could beat the bound found so far: a search from the vertex of highest degree finds a farthest vertex a, and the
+// eccentricity of a, found by a second search, is the bound. It is exact on trees and usually on real-world graphs.
+// The upper bound stored in stats is twice the largest eccentricity of a first sweep. Uses context for the searches.
+inline uint32_t DoubleSweepDiameter(const CompressedAdjacency& adjacency, TraversalContext* context, DiameterStats* stats) {
+    DiameterStats sweep_stats = {0, 0, 0};
+    std::vector<uint32_t> distance;
+    for (const auto& component : eccentricity::Components(adjacency)) {
+        if (component.second - 1 <= sweep_stats.lower_bound) {
+            break;
+        }
+        const uint32_t root_eccentricity = eccentricity::Levels(adjacency, component.first, context, &distance);
+        sweep_stats.bfs_passes++;
+        sweep_stats.upper_bound = std::max(sweep_stats.upper_bound, std::min(2 * root_eccentricity, component.second - 1));
+        // The diameter of the component is at most twice the eccentricity of any of its vertices.
+        if (2 * root_eccentricity <= sweep_stats.lower_bound) {
+            continue;
+        }
+        const uint32_t farthest = context->buffer()->back();
+        sweep_stats.lower_bound = std::max(sweep_stats.lower_bound, eccentricity::Levels(adjacency, farthest, context, &distance));
+        sweep_stats.bfs_passes++;
+    }
+    // Skipped components are no longer than the lower bound.
+    sweep_stats.upper_bound = std::max(sweep_stats.upper_bound, sweep_stats.lower_bound);
+    if (stats != nullptr) {
+        *stats = sweep_stats;
+    }
+    return sweep_stats.lower_bound;
+}
+
+// Exact diameter with iFUB (Crescenzi et al.), run in every component that could beat the diameter found so far.
+// Sweeps from the vertex of highest degree (a search from a vertex, then from the farthest vertex it found, and so on)
+// give a lower bound and a central vertex u, the one closest to all the sweep starts. Searching from u splits the component into levels by distance from u; any two vertices at most at level i are at most
+// 2i apart, so once the eccentricities of the vertices on levels above i are known and one of them exceeds 2i, nothing
+// longer is left. Levels are processed from the farthest down in batches of searches spread across the workers of
+// pool, stopping as soon as the bounds meet. Usually only a few levels are needed, but on expanders such as
+// uniformly random graphs, whose levels are huge and few, most vertices may need a search. If stats is not null the
+// work done is stored in it.
+inline uint32_t IFUBDiameter(const CompressedAdjacency& adjacency, ThreadPool* pool, DiameterStats* stats) {
+    DiameterStats diameter_stats = {0, 0, 0};
+    std::vector<eccentricity::Worker> workers(pool->size());
+    TraversalContext& context = workers[0].context;
+    std::vector<uint32_t>& distance = workers[0].distance;
+    // Vertices of the component in order of distance from u, with the start of each level.
+    std::vector<uint32_t> by_level, level_begin;
+    std::vector<uint32_t> batch_eccentricity;
+    // Largest distance of every vertex of the component to the start of a sweep.
+    std::vector<uint32_t> farthest_sweep(adjacency.V());
+    const size_t batch_size = 4 * pool->size();
+    for (const auto& component : eccentricity::Components(adjacency)) {
+        uint32_t lower = diameter_stats.lower_bound;
+        if (component.second - 1 <= lower) {
+            break;
+        }
+        const uint32_t root_eccentricity = eccentricity::Levels(adjacency, component.first, &context, &distance);
+        diameter_stats.bfs_passes++;
+        uint32_t upper = 2 * root_eccentricity;
+        if (upper <= lower) {
+            continue;
+        }
+        // Two double sweeps, the second from the most central vertex the first found, give four peripheral vertices; u
+        // is the vertex whose largest distance to them is the smallest, a good guess at a center.
+        uint32_t start = context.buffer()->back();
+        for (int sweep = 0; sweep < 4; sweep++) {
+            const uint32_t start_eccentricity = eccentricity::Levels(adjacency, start, &context, &distance);
+            diameter_stats.bfs_passes++;
+            lower = std::max(lower, start_eccentricity);
+            upper = std::min(upper, 2 * start_eccentricity);
+            eccentricity::FoldDistances(*context.buffer(), distance, sweep == 0, &farthest_sweep);
+            if (sweep == 1) {
+                start = eccentricity::MostCentral(adjacency, *context.buffer(), farthest_sweep);
+                const uint32_t center_eccentricity = eccentricity::Levels(adjacency, start, &context, &distance);
+                diameter_stats.bfs_passes++;
+                upper = std::min(upper, 2 * center_eccentricity);
+            }
+            start = context.buffer()->back();
+        }
+        const uint32_t u = eccentricity::MostCentral(adjacency, *context.buffer(), farthest_sweep);
+
+        const uint32_t u_eccentricity = eccentricity::Levels(adjacency, u, &context, &distance);
+        diameter_stats.bfs_passes++;
+        upper = std::min(upper, 2 * u_eccentricity);
+        by_level = *context.buffer();
+        level_begin.assign(u_eccentricity + 2, 0);
+        for (const uint32_t node : by_level) {
+            level_begin[distance[node] + 1]++;
+        }
+        std::partial_sum(level_begin.begin(), level_begin.end(), level_begin.begin());
+
+        for (uint32_t level = u_eccentricity; level > 0 && upper > lower; level--) {
+            // A vertex of this level is at most 2 * level from anything not on a higher level, so the level is done
+            // early only if the bound reaches that.
+            for (uint32_t begin = level_begin[level]; begin < level_begin[level + 1] && lower < upper; begin += batch_size) {
+                const size_t size = std::min<size_t>(batch_size, level_begin[level + 1] - begin);
+                batch_eccentricity.assign(size, 0);
+                pool->ParallelFor(size, 1, [&](size_t first, size_t last, int worker) {
+                    for (size_t i = first; i < last; i++) {
+                        batch_eccentricity[i] = eccentricity::Levels(adjacency, by_level[begin + i], &workers[worker].context,
+                                                                     &workers[worker].distance);
+                    }
+                });
+                diameter_stats.bfs_passes += size;
+                lower = std::max(lower, *std::max_element(batch_eccentricity.begin(), batch_eccentricity.end()));
+            }
+            // Every pair left has both ends within level - 1 of u.
+            upper = std::min(upper, std::max(lower, 2 * (level - 1)));
+        }
+        diameter_stats.lower_bound = lower;
+    }
+    diameter_stats.upper_bound = diameter_stats.lower_bound;
+    if (stats != nullptr) {
+        *stats = diameter_stats;
+    }
+    return diameter_stats.lower_bound;
+}
+
+// Lower and upper bounds on the eccentricity of every vertex within its component, tightened by searches in rounds of
+// one search per worker of pool (Takes and Kosters): a search from v with eccentricity e gives every vertex w of its
+// component max(d(v, w), e - d(v, w)) <= ecc(w) <= e + d(v, w). Each round searches from unresolved vertices with the
+// largest upper bound and with the smallest lower bound, alternately, which quickly pins down the periphery and the
+// center. Stops once every bound is exact or max_passes searches were run. Fills lower and upper, indexed by dense id.
+// If stats is not null the work done and the resulting bounds on the diameter are stored in it.
+inline void EccentricityBounds(const CompressedAdjacency& adjacency, int max_passes, ThreadPool* pool, std::vector<uint32_t>* lower,
+                               std::vector<uint32_t>* upper, DiameterStats* stats) {
+    const uint32_t num_vertices = adjacency.V();
+    const uint32_t kUnbounded = UINT32_MAX;
+    DiameterStats bounds_stats = {0, 0, 0};
+    std::vector<eccentricity::Worker> workers(pool->size());
+    std::vector<uint32_t> sources, source_eccentricity;
+    // Vertices reached by each search of a round, with their distances.
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> reached(pool->size());
+    lower->assign(num_vertices, 0);
+    upper->assign(num_vertices, kUnbounded);
+    for (uint32_t v = 0; v < num_vertices; v++) {
+        if (adjacency.Degree(v) == 0) {
+            (*upper)[v] = 0;
+        }
+    }
+    const auto unresolved = [&](uint32_t v) { return (*lower)[v] < (*upper)[v]; };
+
+    while (bounds_stats.bfs_passes < max_passes) {
+        // Pick sources: the unresolved vertex with the largest upper bound, then the one with the smallest lower
+        // bound, and so on; ties go to higher degree.
+        sources.clear();
+        const size_t round = std::min<size_t>(pool->size(), max_passes - bounds_stats.bfs_passes);
+        for (size_t i = 0; i < round; i++) {
+            uint32_t best = kNoVertex;
+            for (uint32_t v = 0; v < num_vertices; v++) {
+                if (!unresolved(v) || std::find(sources.begin(), sources.end(), v) != sources.end()) {
+                    continue;
+                }
+                if (best == kNoVertex) {
+                    best = v;
+                    continue;
+                }
+                const bool better = i % 2 == 0 ? (*upper)[v] > (*upper)[best] || ((*upper)[v] == (*upper)[best] && adjacency.Degree(v) > adjacency.Degree(best))
+                                               : (*lower)[v] < (*lower)[best] || ((*lower)[v] == (*lower)[best] && adjacency.Degree(v) > adjacency.Degree(best));
+                if (better) {
+                    best = v;
+                }
+            }
+            if (best == kNoVertex) {
+                break;
+            }
+            sources.push_back(best);
+        }
+        if (sources.empty()) {
+            break;
+        }
+
+        // One search per source, spread across the workers, each keeping the distances of its component for the
+        // updates below.
+        source_eccentricity.assign(sources.size(), 0);
+        pool->ParallelFor(sources.size(), 1, [&](size_t first, size_t last, int worker) {
+            for (size_t i = first; i < last; i++) {
+                eccentricity::Worker& scratch = workers[worker];
+                source_eccentricity[i] = eccentricity::Levels(adjacency, sources[i], &scratch.context, &scratch.distance);
+                reached[i].clear();
+                for (const uint32_t node : *scratch.context.buffer()) {
+                    reached[i].push_back({node, scratch.distance[node]});
+                }
+            }
+        });
+        bounds_stats.bfs_passes += sources.size();
+        for (size_t i = 0; i < sources.size(); i++) {
+            const uint32_t e = source_eccentricity[i];
+            pool->ParallelFor(reached[i].size(), 4096, [&](size_t first, size_t last, int) {
+                for (size_t j = first; j < last; j++) {
+                    const uint32_t w = reached[i][j].first, d = reached[i][j].second;
+                    (*lower)[w] = std::max((*lower)[w], std::max(d, e - d));
+                    (*upper)[w] = std::min((*upper)[w], e + d);
+                }
+            });
+        }
+    }
+
+    for (uint32_t v = 0; v < num_vertices; v++) {
+        bounds_stats.lower_bound = std::max(bounds_stats.lower_bound, (*lower)[v]);
+        bounds_stats.upper_bound = std::max(bounds_stats.upper_bound, (*upper)[v]);
+    }
+    if (stats != nullptr) {
+        *stats = bounds_stats;
+    }
+}
+
+#endif /* ECCENTRICITY_H_ */
@@ -10,9 +10,9 @@ class Edge {
     const int weight_;
   public:
     Edge(const std::string from, const std::string to, const int weight): from_(from), to_(to), weight_(weight) {}
-    const std::string from() const { return from_; }
-    const std::string to() const { return to_; }
-    const int weight() const { return weight_; }
+    const std::string& from() const { return from_; }
+    const std::string& to() const { return to_; }
+    int weight() const { return weight_; }
     void PrintEdge() const { std::cout << from_ << " -> " << to_ << " : (" << weight_ << ")" << std::endl; }
 };
 
@@ -0,0 +1,308 @@
+#ifndef EDGE_LIST_LOADER_H_
+#define EDGE_LIST_LOADER_H_
+
+#include "string_ref.h"
+#include "thread_pool.h"
+#include "vertex_index.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Bytes of text read and parsed at a time when no chunk size is given.
+const size_t kEdgeListChunkBytes = 16 << 20;
+
+// Work done by one LoadEdgeList call.
+struct EdgeListStats {
+    uint64_t bytes;
+    uint64_t edges;
+
+    // Lines that were neither an edge, a comment nor blank.
+    uint64_t skipped_lines;
+
+    // Whether the file was read as DIMACS, whose "c" and "p" lines are comments and the problem line.
+    bool dimacs;
+
+    double seconds;
+};
+
+namespace edge_list {
+
+// Open addressing table from the vertex ids of a piece to local ids, numbered in the order the ids first appear.
+// Each slot keeps the hash, length and first 8 bytes of its id, so most lookups (all of them for ids of up to 8 bytes)
+// touch a single slot instead of following a node and then the characters of the id.
+class LocalIds {
+  private:
+    struct Slot {
+        uint64_t hash;
+        uint64_t prefix;
+        uint32_t size;
+        uint32_t local;
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<StringRef> ids_;
+
+    static uint64_t Prefix(const StringRef& id) {
+        uint64_t prefix = 0;
+        std::memcpy(&prefix, id.data(), std::min<size_t>(id.size(), sizeof(prefix)));
+        return prefix;
+    }
+
+    // Insert slot in the table, which has a free slot for it.
+    void Place(const Slot& slot) {
+        const size_t mask = slots_.size() - 1;
+        size_t i = slot.hash & mask;
+        while (slots_[i].local != kNoVertex) i = (i + 1) & mask;
+        slots_[i] = slot;
+    }
+
+  public:
+    LocalIds() : slots_(16, Slot{0, 0, 0, kNoVertex}) {}
+
+    // Return the local id of id, numbering it if it is new. id must stay valid until Clear().
+    uint32_t Local(const StringRef& id) {
+        // Kept at most half full.
+        if (2 * (ids_.size() + 1) > slots_.size()) {
+            std::vector<Slot> old_slots(2 * slots_.size(), Slot{0, 0, 0, kNoVertex});
+            old_slots.swap(slots_);
+            for (const Slot& slot : old_slots) {
+                if (slot.local != kNoVertex) Place(slot);
+            }
+        }
+        const uint64_t hash = HashId(id.data(), id.size()), prefix = Prefix(id);
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+            Slot& slot = slots_[i];
+            if (slot.local == kNoVertex) {
+                slot = Slot{hash, prefix, static_cast<uint32_t>(id.size()), static_cast<uint32_t>(ids_.size())};
+                ids_.push_back(id);
+                return slot.local;
+            }
+            if (slot.hash == hash && slot.size == id.size() && slot.prefix == prefix &&
+                (id.size() <= sizeof(prefix) || ids_[slot.local] == id)) {
+                return slot.local;
+            }
+        }
+    }
+
+    // Vertex ids by local id.
+    const std::vector<StringRef>& ids() const { return ids_; }
+
+    // Remove every id, keeping the table size.
+    void Clear() {
+        std::fill(slots_.begin(), slots_.end(), Slot{0, 0, 0, kNoVertex});
+        ids_.clear();
+    }
+};
+
+// Edges parsed from one piece of a chunk over the local ids of its vertex ids, so that a vertex id is interned into the
+// shared index once per piece instead of once per edge end.
+struct Piece {
+    LocalIds local_ids;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    std::vector<int> weights;
+    uint64_t skipped_lines;
+
+    void Clear() {
+        local_ids.Clear();
+        edges.clear();
+        weights.clear();
+        skipped_lines = 0;
+    }
+};
+
+inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Parse token as a decimal int into value. Returns false if it is not one.
+inline bool ParseWeight(const StringRef& token, int* value) {
+    size_t i = token.size() > 0 && token.data()[0] == '-' ? 1 : 0;
+    if (i == token.size() || token.size() - i > 9) {
+        return false;
+    }
+    int magnitude = 0;
+    for (; i < token.size(); i++) {
+        if (token.data()[i] < '0' || token.data()[i] > '9') {
+            return false;
+        }
+        magnitude = magnitude * 10 + (token.data()[i] - '0');
+    }
+    *value = token.data()[0] == '-' ? -magnitude : magnitude;
+    return true;
+}
+
+const int kMaxTokens = 4;
+
+// Split the line starting at line into its first kMaxTokens blank separated tokens, store their count (all of them,
+// kept or not) in num_tokens, and return the start of the next line.
+inline const char* SplitLine(const char* line, const char* end, StringRef* tokens, int* num_tokens) {
+    *num_tokens = 0;
+    const char* c = line;
+    while (c < end && *c != '\n') {
+        while (c < end && IsBlank(*c)) c++;
+        const char* token = c;
+        while (c < end && *c != '\n' && !IsBlank(*c)) c++;
+        if (c > token) {
+            if (*num_tokens < kMaxTokens) tokens[*num_tokens] = StringRef(token, c - token);
+            (*num_tokens)++;
+        }
+    }
+    return c + 1;
+}
+
+// Whether a line is blank or a SNAP '#' or Matrix Market '%' comment.
+inline bool IsComment(const StringRef* tokens, int num_tokens) {
+    return num_tokens == 0 || tokens[0].data()[0] == '#' || tokens[0].data()[0] == '%';
+}
+
+inline bool IsUnsigned(const StringRef& token) {
+    for (size_t i = 0; i < token.size(); i++) {
+        if (token.data()[i] < '0' || token.data()[i] > '9') return false;
+    }
+    return token.size() > 0;
+}
+
+// Whether the whole lines in [begin, end), the start of a file, are DIMACS: the first line that is not a comment or a
+// "c" line is the problem line "p <type> <n> <m>" or an arc "a u v w", neither of which is a valid plain edge.
+inline bool IsDimacs(const char* begin, const char* end) {
+    StringRef tokens[kMaxTokens] = {StringRef(begin, 0), StringRef(begin, 0), StringRef(begin, 0), StringRef(begin, 0)};
+    for (const char* line = begin; line < end; ) {
+        int num_tokens = 0;
+        line = SplitLine(line, end, tokens, &num_tokens);
+        if (IsComment(tokens, num_tokens) || tokens[0] == StringRef("c", 1)) {
+            continue;
+        }
+        return num_tokens == 4 && ((tokens[0] == StringRef("p", 1) && IsUnsigned(tokens[2]) && IsUnsigned(tokens[3])) ||
+                                   tokens[0] == StringRef("a", 1));
+    }
+    return false;
+}
+
+// Parse the whole lines in [begin, end) into piece, skipping "c" and "p" lines if dimacs.
+inline void ParseLines(const char* begin, const char* end, bool dimacs, Piece* piece) {
+    StringRef tokens[kMaxTokens] = {StringRef(begin, 0), StringRef(begin, 0), StringRef(begin, 0), StringRef(begin, 0)};
+    for (const char* line = begin; line < end; ) {
+        int num_tokens = 0;
+        line = SplitLine(line, end, tokens, &num_tokens);
+        if (IsComment(tokens, num_tokens) || (dimacs && (tokens[0] == StringRef("c", 1) || tokens[0] == StringRef("p", 1)))) {
+            continue;
+        }
+        // DIMACS arcs are "a u v w"; everything else is "u v" or "u v w".
+        int first = num_tokens == 4 && tokens[0] == StringRef("a", 1) ? 1 : 0;
+        int weight = 1;
+        if (num_tokens - first < 2 || num_tokens - first > 3 || (num_tokens - first == 3 && !ParseWeight(tokens[first + 2], &weight))) {
+            piece->skipped_lines++;
+            continue;
+        }
+        const uint32_t from = piece->local_ids.Local(tokens[first]);
+        piece->edges.push_back({from, piece->local_ids.Local(tokens[first + 1])});
+        piece->weights.push_back(weight);
+    }
+}
+
+}  // namespace edge_list
+
+// Append the edges of the plain text edge list at path to edges and weights, interning their vertex ids into index.
+// Every line is "u v" or "u v w" with an int weight w (1 if missing), or a DIMACS arc "a u v w", separated by blanks;
+// blank lines and lines starting with '#' or '%' are skipped, and so are the "c" (comment) and "p" (problem) lines of
+// a DIMACS file, one whose first line that is neither of these nor a "c" line is "p <type> <n> <m>" or an arc. In any
+// other file "c" and "p" are vertex ids like any other. Other lines are skipped too, and counted as skipped. The file
+// is read chunk_bytes at a time (a chunk grows only to hold a longer line), so the text never takes more memory than a
+// chunk. Each chunk is cut at line ends into one piece per worker of pool; the pieces are parsed in parallel over local
+// ids, whose distinct vertex ids are then interned in piece order and the edges renumbered in parallel, so edges keep
+// their order in the file. Returns false if the file cannot be read. If stats is not null the work done is stored in it.
+inline bool LoadEdgeList(const std::string& path, size_t chunk_bytes, ThreadPool* pool, VertexIndex* index,
+                         std::vector<std::pair<uint32_t, uint32_t>>* edges, std::vector<int>* weights, EdgeListStats* stats) {
+    const auto start = std::chrono::steady_clock::now();
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cout << "Cannot open " << path << std::endl;
+        return false;
+    }
+    EdgeListStats load_stats = {0, 0, 0, false, 0.0};
+    std::vector<char> buffer(std::max<size_t>(chunk_bytes, 1));
+    std::vector<edge_list::Piece> pieces(pool->size());
+    std::vector<size_t> piece_begin(pieces.size() + 1), edge_offset(pieces.size() + 1);
+    std::vector<std::vector<uint32_t>> global_ids(pieces.size());
+    // Bytes of a line cut by the end of the last chunk, kept at the start of buffer.
+    size_t carried = 0;
+    bool first_chunk = true, end_of_file = false;
+    while (!end_of_file) {
+        in.read(buffer.data() + carried, buffer.size() - carried);
+        const size_t size = carried + static_cast<size_t>(in.gcount());
+        load_stats.bytes += in.gcount();
+        end_of_file = !in;
+        // The chunk ends after its last line end, or at the end of the file.
+        size_t chunk_end = size;
+        if (!end_of_file) {
+            while (chunk_end > 0 && buffer[chunk_end - 1] != '\n') chunk_end--;
+            if (chunk_end == 0) {
+                carried = size;
+                buffer.resize(2 * buffer.size());
+                continue;
+            }
+        }
+
+        // The format is told from the first chunk, which holds at least a line.
+        if (first_chunk) {
+            load_stats.dimacs = edge_list::IsDimacs(buffer.data(), buffer.data() + chunk_end);
+            first_chunk = false;
+        }
+
+        // Cut the chunk into pieces of about equal size at line ends.
+        piece_begin[0] = 0;
+        for (size_t piece = 1; piece < pieces.size(); piece++) {
+            size_t begin = std::max(piece_begin[piece - 1], chunk_end * piece / pieces.size());
+            while (begin > 0 && begin < chunk_end && buffer[begin - 1] != '\n') begin++;
+            piece_begin[piece] = begin;
+        }
+        piece_begin[pieces.size()] = chunk_end;
+        pool->ParallelFor(pieces.size(), 1, [&](size_t begin, size_t end, int) {
+            for (size_t piece = begin; piece < end; piece++) {
+                pieces[piece].Clear();
+                edge_list::ParseLines(buffer.data() + piece_begin[piece], buffer.data() + piece_begin[piece + 1], load_stats.dimacs,
+                                      &pieces[piece]);
+            }
+        });
+
+        edge_offset[0] = edges->size();
+        for (size_t piece = 0; piece < pieces.size(); piece++) {
+            const std::vector<StringRef>& local_ids = pieces[piece].local_ids.ids();
+            global_ids[piece].resize(local_ids.size());
+            for (size_t local = 0; local < local_ids.size(); local++) {
+                global_ids[piece][local] = index->Intern(local_ids[local]);
+            }
+            edge_offset[piece + 1] = edge_offset[piece] + pieces[piece].edges.size();
+            load_stats.skipped_lines += pieces[piece].skipped_lines;
+        }
+        edges->resize(edge_offset[pieces.size()]);
+        weights->resize(edge_offset[pieces.size()]);
+        pool->ParallelFor(pieces.size(), 1, [&](size_t begin, size_t end, int) {
+            for (size_t piece = begin; piece < end; piece++) {
+                const std::vector<uint32_t>& global = global_ids[piece];
+                for (size_t i = 0; i < pieces[piece].edges.size(); i++) {
+                    (*edges)[edge_offset[piece] + i] = {global[pieces[piece].edges[i].first], global[pieces[piece].edges[i].second]};
+                    (*weights)[edge_offset[piece] + i] = pieces[piece].weights[i];
+                }
+            }
+        });
+        load_stats.edges += edge_offset[pieces.size()] - edge_offset[0];
+
+        carried = size - chunk_end;
+        std::copy(buffer.begin() + chunk_end, buffer.begin() + size, buffer.begin());
+    }
+    load_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats != nullptr) {
+        *stats = load_stats;
+    }
+    return true;
+}
+
+#endif /* EDGE_LIST_LOADER_H_ */
@@ -0,0 +1,276 @@
+#ifndef GRAPH_SNAPSHOT_H_
+#define GRAPH_SNAPSHOT_H_
+
+#include "compressed_adjacency.h"
+#include "vertex_index.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// On-disk snapshot of a frozen graph, laid out so that a mapped file is queried in place: the header is followed by
+// sections of native-endian arrays, each starting at a multiple of 8 bytes from the start of the file:
+//   id_offsets       uint64[V + 1]    characters of id v are id_chars[id_offsets[v] .. id_offsets[v + 1])
+//   id_chars         char[]
+//   id_slots         uint32[capacity] open addressing table from HashId() of an id to its dense id, or kNoVertex
+//   offsets          uint32[V + 1]    adjacency as in CompressedAdjacency: out-edges, or both ends if undirected
+//   targets          uint32[entries]
+//   weights          int32[entries]
+//   reverse_offsets  uint32[V + 1]    in-edges of a directed graph; empty sections if undirected
+//   reverse_targets  uint32[reverse_entries]
+// Only the header and the section bounds are checked when a file is mapped, so snapshots are trusted input. A mapped
+// file must not be truncated or rewritten in place, which would fault the graphs reading it; replace it by renaming a
+// new file over it, as WriteSnapshot() does.
+const char kSnapshotMagic[8] = {'G', 'R', 'A', 'P', 'H', 'S', 'N', 'P'};
+const uint32_t kSnapshotVersion = 1;
+
+// Written as is, so a file from a machine of the other byte order reads back as a different value and is rejected.
+const uint32_t kSnapshotByteOrder = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t directed;
+    uint32_t num_vertices;
+    // Count of edges of the graph, and of entries in the adjacency and in the reverse adjacency.
+    uint32_t num_edges;
+    uint32_t num_entries;
+    uint32_t num_reverse_entries;
+    uint32_t slot_capacity;
+    uint32_t negative_weights;
+    uint32_t reserved;
+    uint64_t file_size;
+    // Byte offset of every section from the start of the file.
+    uint64_t id_offsets;
+    uint64_t id_chars;
+    uint64_t id_slots;
+    uint64_t offsets;
+    uint64_t targets;
+    uint64_t weights;
+    uint64_t reverse_offsets;
+    uint64_t reverse_targets;
+};
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0, "sections after the header must stay 8 byte aligned");
+
+// Read-only shared mapping of a whole file, unmapped on destruction. Pages come from the page cache, so every process
+// mapping the same file shares one copy and only the pages a query touches are read from disk.
+class MappedFile {
+  private:
+    const char* data_;
+    size_t size_;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+  public:
+    MappedFile() : data_(nullptr), size_(0) {}
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    // Map the file at path. Returns false if it cannot be opened or mapped, or is empty.
+    bool Open(const std::string& path) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat file_stat;
+        void* data = MAP_FAILED;
+        if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+            data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        // The mapping keeps the file alive once made.
+        close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const char*>(data);
+        size_ = file_stat.st_size;
+        return true;
+    }
+
+    const char* data() const { return data_; }
+
+    size_t size() const { return size_; }
+};
+
+namespace snapshot {
+
+inline uint64_t Align(uint64_t offset) { return (offset + 7) & ~static_cast<uint64_t>(7); }
+
+// Append zero bytes to out up to the next multiple of 8 after a section of size bytes.
+inline void WritePadding(std::ofstream* out, uint64_t size) {
+    static const char kPadding[8] = {0};
+    out->write(kPadding, Align(size) - size);
+}
+
+// Append size bytes at data to out, then the padding.
+inline void WriteSection(std::ofstream* out, const void* data, uint64_t size) {
+    out->write(static_cast<const char*>(data), size);
+    WritePadding(out, size);
+}
+
+// Whether the section of count elements of size bytes at offset lies inside a file of file_size bytes.
+inline bool SectionFits(uint64_t offset, uint64_t count, uint64_t size, uint64_t file_size) {
+    return offset % 8 == 0 && offset <= file_size && count <= (file_size - offset) / size;
+}
+
+}  // namespace snapshot
+
+// Write index, adjacency and, for a directed graph, reverse (null if undirected) to path in the snapshot format.
+// num_edges and negative_weights are stored for the graph to restore. Returns false if the file cannot be written.
+inline bool WriteSnapshot(const std::string& path, const VertexIndex& index, const CompressedAdjacency& adjacency,
+                          const CompressedAdjacency* reverse, uint32_t num_edges, uint32_t negative_weights) {
+    const uint32_t num_vertices = adjacency.V();
+    std::vector<uint64_t> id_offsets(num_vertices + 1, 0);
+    for (uint32_t v = 0; v < num_vertices; v++) {
+        id_offsets[v + 1] = id_offsets[v] + index.Id(v).size();
+    }
+    // At most half full, so probes stay short.
+    uint32_t slot_capacity = 2;
+    while (slot_capacity < 2 * static_cast<uint64_t>(num_vertices)) {
+        slot_capacity *= 2;
+    }
+    std::vector<uint32_t> id_slots(slot_capacity, kNoVertex);
+    for (uint32_t v = 0; v < num_vertices; v++) {
+        const StringRef id = index.Id(v);
+        uint64_t slot = HashId(id.data(), id.size());
+        while (id_slots[slot & (slot_capacity - 1)] != kNoVertex) {
+            slot++;
+        }
+        id_slots[slot & (slot_capacity - 1)] = v;
+    }
+    const std::vector<int> no_weights(adjacency.weights() == nullptr ? adjacency.E() : 0, 1);
+    const int* weights = adjacency.weights() != nullptr ? adjacency.weights() : no_weights.data();
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.byte_order = kSnapshotByteOrder;
+    header.directed = reverse != nullptr;
+    header.num_vertices = num_vertices;
+    header.num_edges = num_edges;
+    header.num_entries = adjacency.E();
+    header.num_reverse_entries = reverse != nullptr ? reverse->E() : 0;
+    header.slot_capacity = slot_capacity;
+    header.negative_weights = negative_weights;
+    header.id_offsets = sizeof(SnapshotHeader);
+    header.id_chars = header.id_offsets + snapshot::Align(sizeof(uint64_t) * id_offsets.size());
+    header.id_slots = header.id_chars + snapshot::Align(id_offsets.back());
+    header.offsets = header.id_slots + snapshot::Align(sizeof(uint32_t) * slot_capacity);
+    header.targets = header.offsets + snapshot::Align(sizeof(uint32_t) * (num_vertices + 1));
+    header.weights = header.targets + snapshot::Align(sizeof(uint32_t) * header.num_entries);
+    header.reverse_offsets = header.weights + snapshot::Align(sizeof(int) * header.num_entries);
+    header.reverse_targets = header.reverse_offsets + (reverse != nullptr ? snapshot::Align(sizeof(uint32_t) * (num_vertices + 1)) : 0);
+    header.file_size = header.reverse_targets + snapshot::Align(sizeof(uint32_t) * header.num_reverse_entries);
+
+    // Written beside path and renamed over it, so graphs still mapping an older file at path keep reading it intact.
+    const std::string temporary_path = path + ".tmp";
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cout << "Cannot open " << temporary_path << " for writing" << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    snapshot::WriteSection(&out, id_offsets.data(), sizeof(uint64_t) * id_offsets.size());
+    for (uint32_t v = 0; v < num_vertices; v++) {
+        out.write(index.Id(v).data(), index.Id(v).size());
+    }
+    snapshot::WritePadding(&out, id_offsets.back());
+    snapshot::WriteSection(&out, id_slots.data(), sizeof(uint32_t) * slot_capacity);
+    snapshot::WriteSection(&out, adjacency.offsets(), sizeof(uint32_t) * (num_vertices + 1));
+    snapshot::WriteSection(&out, adjacency.targets(), sizeof(uint32_t) * header.num_entries);
+    snapshot::WriteSection(&out, weights, sizeof(int) * header.num_entries);
+    if (reverse != nullptr) {
+        snapshot::WriteSection(&out, reverse->offsets(), sizeof(uint32_t) * (num_vertices + 1));
+        snapshot::WriteSection(&out, reverse->targets(), sizeof(uint32_t) * header.num_reverse_entries);
+    }
+    out.close();
+    if (!out || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        std::cout << "Failed writing " << path << std::endl;
+        std::remove(temporary_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Map the snapshot at path into file and point index, adjacency and, if the snapshot is directed, reverse at its
+// sections; nothing is copied or parsed. directed must match the snapshot. Returns false, leaving the outputs
+// untouched, if the file cannot be mapped or is not a valid snapshot of that kind.
+inline bool MapSnapshot(const std::string& path, bool directed, MappedFile* file, SnapshotHeader* header, VertexIndex* index,
+                        CompressedAdjacency* adjacency, CompressedAdjacency* reverse) {
+    if (!file->Open(path)) {
+        std::cout << "Cannot map " << path << std::endl;
+        return false;
+    }
+    SnapshotHeader file_header;
+    if (file->size() < sizeof(file_header)) {
+        std::cout << path << " is not a graph snapshot" << std::endl;
+        return false;
+    }
+    std::memcpy(&file_header, file->data(), sizeof(file_header));
+    if (std::memcmp(file_header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+        std::cout << path << " is not a graph snapshot" << std::endl;
+        return false;
+    }
+    if (file_header.version != kSnapshotVersion || file_header.byte_order != kSnapshotByteOrder) {
+        std::cout << path << " has snapshot version " << file_header.version << " or another byte order; expected version "
+                  << kSnapshotVersion << std::endl;
+        return false;
+    }
+    if (file_header.directed != static_cast<uint32_t>(directed)) {
+        std::cout << path << " is a snapshot of " << (file_header.directed ? "a directed" : "an undirected") << " graph" << std::endl;
+        return false;
+    }
+    const uint64_t size = file->size();
+    const uint64_t num_vertices = file_header.num_vertices;
+    const uint64_t slot_capacity = file_header.slot_capacity;
+    bool valid = file_header.file_size == size && slot_capacity > num_vertices && (slot_capacity & (slot_capacity - 1)) == 0 &&
+                 snapshot::SectionFits(file_header.id_offsets, num_vertices + 1, sizeof(uint64_t), size) &&
+                 snapshot::SectionFits(file_header.id_slots, slot_capacity, sizeof(uint32_t), size) &&
+                 snapshot::SectionFits(file_header.offsets, num_vertices + 1, sizeof(uint32_t), size) &&
+                 snapshot::SectionFits(file_header.targets, file_header.num_entries, sizeof(uint32_t), size) &&
+                 snapshot::SectionFits(file_header.weights, file_header.num_entries, sizeof(int), size);
+    if (valid && directed) {
+        valid = snapshot::SectionFits(file_header.reverse_offsets, num_vertices + 1, sizeof(uint32_t), size) &&
+                snapshot::SectionFits(file_header.reverse_targets, file_header.num_reverse_entries, sizeof(uint32_t), size);
+    }
+    const char* data = file->data();
+    if (valid) {
+        const uint64_t* id_offsets = reinterpret_cast<const uint64_t*>(data + file_header.id_offsets);
+        valid = snapshot::SectionFits(file_header.id_chars, id_offsets[num_vertices], 1, size);
+    }
+    if (!valid) {
+        std::cout << path << " is truncated or corrupt" << std::endl;
+        return false;
+    }
+
+    *header = file_header;
+    index->Map(file_header.num_vertices, reinterpret_cast<const uint64_t*>(data + file_header.id_offsets),
+               data + file_header.id_chars, reinterpret_cast<const uint32_t*>(data + file_header.id_slots), file_header.slot_capacity);
+    adjacency->Map(file_header.num_vertices, reinterpret_cast<const uint32_t*>(data + file_header.offsets),
+                   reinterpret_cast<const uint32_t*>(data + file_header.targets), reinterpret_cast<const int*>(data + file_header.weights));
+    if (directed) {
+        reverse->Map(file_header.num_vertices, reinterpret_cast<const uint32_t*>(data + file_header.reverse_offsets),
+                     reinterpret_cast<const uint32_t*>(data + file_header.reverse_targets), nullptr);
+    }
+    return true;
+}
+
+#endif /* GRAPH_SNAPSHOT_H_ */
@@ -0,0 +1,119 @@
+#ifndef INDEXED_HEAP_H_
+#define INDEXED_HEAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Slot recorded for an id that is not in an IndexedHeap.
+const uint32_t kNotInHeap = UINT32_MAX;
+
+// Min-heap of dense ids keyed by 64 bit integers with an index from each id to its slot, so that the key of an id
+// already in the heap is lowered in place instead of pushing a duplicate. Four children per node make the heap half as
+// deep as a binary one and keep the children of a slot in one cache line, which suits the many cheap decrease-key
+// operations of Dijkstra on integer weights.
+class IndexedHeap {
+  private:
+    static const size_t kArity = 4;
+
+    // Slots of the heap, each holding a key and its id.
+    std::vector<std::pair<int64_t, uint32_t>> heap_;
+
+    // Slot of every id, or kNotInHeap.
+    std::vector<uint32_t> slot_;
+
+    void Place(size_t slot, const std::pair<int64_t, uint32_t>& entry) {
+        heap_[slot] = entry;
+        slot_[entry.second] = static_cast<uint32_t>(slot);
+    }
+
+    void SiftUp(size_t slot) {
+        const std::pair<int64_t, uint32_t> entry = heap_[slot];
+        while (slot > 0) {
+            const size_t parent = (slot - 1) / kArity;
+            if (heap_[parent].first <= entry.first) {
+                break;
+            }
+            Place(slot, heap_[parent]);
+            slot = parent;
+        }
+        Place(slot, entry);
+    }
+
+    void SiftDown(size_t slot) {
+        const std::pair<int64_t, uint32_t> entry = heap_[slot];
+        while (true) {
+            const size_t first_child = slot * kArity + 1;
+            if (first_child >= heap_.size()) {
+                break;
+            }
+            const size_t last_child = std::min(first_child + kArity, heap_.size());
+            size_t smallest = first_child;
+            for (size_t child = first_child + 1; child < last_child; child++) {
+                if (heap_[child].first < heap_[smallest].first) {
+                    smallest = child;
+                }
+            }
+            if (heap_[smallest].first >= entry.first) {
+                break;
+            }
+            Place(slot, heap_[smallest]);
+            slot = smallest;
+        }
+        Place(slot, entry);
+    }
+
+  public:
+    // Make room for ids 0..num_ids-1.
+    void Resize(uint32_t num_ids) {
+        if (slot_.size() < num_ids) {
+            slot_.resize(num_ids, kNotInHeap);
+        }
+    }
+
+    bool empty() const { return heap_.empty(); }
+
+    size_t size() const { return heap_.size(); }
+
+    bool Contains(uint32_t id) const { return slot_[id] != kNotInHeap; }
+
+    // Insert id with key, or lower its key to key if it is in the heap with a larger one. Returns whether anything changed.
+    bool PushOrDecrease(uint32_t id, int64_t key) {
+        if (slot_[id] == kNotInHeap) {
+            heap_.push_back({key, id});
+            SiftUp(heap_.size() - 1);
+            return true;
+        }
+        if (heap_[slot_[id]].first <= key) {
+            return false;
+        }
+        heap_[slot_[id]].first = key;
+        SiftUp(slot_[id]);
+        return true;
+    }
+
+    // Remove and return the entry with the smallest key as (key, id).
+    std::pair<int64_t, uint32_t> Pop() {
+        const std::pair<int64_t, uint32_t> top = heap_.front();
+        slot_[top.second] = kNotInHeap;
+        if (heap_.size() > 1) {
+            heap_.front() = heap_.back();
+            heap_.pop_back();
+            SiftDown(0);
+        } else {
+            heap_.pop_back();
+        }
+        return top;
+    }
+
+    // Remove every entry, in time proportional to their count.
+    void Clear() {
+        for (const auto& entry : heap_) {
+            slot_[entry.second] = kNotInHeap;
+        }
+        heap_.clear();
+    }
+};
+
+#endif /* INDEXED_HEAP_H_ */
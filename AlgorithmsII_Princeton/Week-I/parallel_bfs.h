@@ -0,0 +1,38 @@
+#ifndef PARALLEL_BFS_H_
+#define PARALLEL_BFS_H_
+
+#include "compressed_adjacency.h"
+#include "thread_pool.h"
+#include "traversal_context.h"
+
+#include <vector>
+
+// Level-synchronous BFS from source over adjacency. Each level is split across the workers of pool, which claim
+// the vertices they discover with TryVisit(), so every reached vertex gets exactly one parent on the previous level
+// and context holds a valid BFS tree afterwards. The caller resets context before the call.
+inline void ParallelBreadthFirstSearch(const CompressedAdjacency& adjacency, uint32_t source, ThreadPool* pool, TraversalContext* context) {
+    // Frontier vertices handed out per chunk; small enough to balance skewed degrees, large enough to amortize the claim.
+    const size_t kGrain = 64;
+
+    std::vector<uint32_t>& frontier = *context->buffer();
+    std::vector<std::vector<uint32_t>> next_frontiers(pool->size());
+    context->Visit(source, source);
+    frontier.assign(1, source);
+    while (!frontier.empty()) {
+        pool->ParallelFor(frontier.size(), kGrain, [&](size_t begin, size_t end, int worker) {
+            std::vector<uint32_t>& next_frontier = next_frontiers[worker];
+            for (size_t i = begin; i < end; i++) {
+                const uint32_t node = frontier[i];
+                for (const uint32_t* neighbor = adjacency.begin(node); neighbor != adjacency.end(node); neighbor++) {
+                    if (!context->visited(*neighbor) && context->TryVisit(*neighbor, node)) {
+                        next_frontier.push_back(*neighbor);
+                    }
+                }
+            }
+        });
+        frontier.clear();
+        ParallelConcatenate(pool, &next_frontiers, &frontier);
+    }
+}
+
+#endif /* PARALLEL_BFS_H_ */
@@ -0,0 +1,131 @@
+#ifndef PARALLEL_COMPONENTS_H_
+#define PARALLEL_COMPONENTS_H_
+
+#include "compressed_adjacency.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace afforest {
+
+// Merge the trees containing u and v by pointing the higher root at the lower one with a compare-and-swap, retrying
+// from the new roots if another worker moved either tree meanwhile.
+inline void Link(uint32_t u, uint32_t v, std::atomic<uint32_t>* component) {
+    uint32_t p1 = component[u].load(std::memory_order_relaxed);
+    uint32_t p2 = component[v].load(std::memory_order_relaxed);
+    while (p1 != p2) {
+        const uint32_t high = p1 > p2 ? p1 : p2;
+        const uint32_t low = p1 + p2 - high;
+        uint32_t p_high = component[high].load(std::memory_order_relaxed);
+        if (p_high == low) {
+            return;
+        }
+        if (p_high == high && component[high].compare_exchange_strong(p_high, low, std::memory_order_relaxed)) {
+            return;
+        }
+        p1 = component[component[high].load(std::memory_order_relaxed)].load(std::memory_order_relaxed);
+        p2 = component[low].load(std::memory_order_relaxed);
+    }
+}
+
+// Point every vertex directly at the root of its tree.
+inline void Compress(uint32_t num_vertices, std::atomic<uint32_t>* component, ThreadPool* pool) {
+    pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            uint32_t parent = component[v].load(std::memory_order_relaxed);
+            uint32_t grandparent = component[parent].load(std::memory_order_relaxed);
+            while (parent != grandparent) {
+                component[v].store(grandparent, std::memory_order_relaxed);
+                parent = grandparent;
+                grandparent = component[parent].load(std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+}  // namespace afforest
+
+// Connected components of an undirected (symmetric) adjacency with the Afforest algorithm (Sutton et al.): link every
+// vertex to its first few neighbors, compress, sample the largest intermediate component, then link the remaining
+// edges of the vertices outside it only. Fills labels with dense component ids 0..count-1, numbered in order of the
+// lowest vertex of each component, and returns count.
+inline uint32_t AfforestComponents(const CompressedAdjacency& adjacency, ThreadPool* pool, std::vector<uint32_t>* labels) {
+    // Neighbors linked per vertex before sampling, and vertices sampled to find the largest component.
+    const uint32_t kNeighborRounds = 2;
+    const int kSamples = 1024;
+
+    const uint32_t num_vertices = adjacency.V();
+    std::unique_ptr<std::atomic<uint32_t>[]> component(new std::atomic<uint32_t>[num_vertices]);
+    pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            component[v].store(static_cast<uint32_t>(v), std::memory_order_relaxed);
+        }
+    });
+
+    for (uint32_t round = 0; round < kNeighborRounds; round++) {
+        pool->ParallelFor(num_vertices, 1024, [&](size_t begin, size_t end, int) {
+            for (size_t v = begin; v < end; v++) {
+                if (adjacency.Degree(v) > round) {
+                    afforest::Link(v, adjacency.begin(v)[round], component.get());
+                }
+            }
+        });
+        afforest::Compress(num_vertices, component.get(), pool);
+    }
+
+    uint32_t largest = num_vertices;
+    if (num_vertices > 0) {
+        std::mt19937 generator(27491095);
+        std::uniform_int_distribution<uint32_t> vertex(0, num_vertices - 1);
+        std::unordered_map<uint32_t, int> sample_counts;
+        int largest_count = 0;
+        for (int i = 0; i < kSamples; i++) {
+            const uint32_t root = component[vertex(generator)].load(std::memory_order_relaxed);
+            if (++sample_counts[root] > largest_count) {
+                largest_count = sample_counts[root];
+                largest = root;
+            }
+        }
+    }
+
+    // Every remaining edge with an endpoint outside the largest component is seen from that endpoint, since the
+    // adjacency is symmetric, so edges inside the largest component can be skipped.
+    pool->ParallelFor(num_vertices, 256, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            if (component[v].load(std::memory_order_relaxed) == largest) {
+                continue;
+            }
+            const uint32_t* first_unlinked = adjacency.begin(v) + std::min(kNeighborRounds, adjacency.Degree(v));
+            for (const uint32_t* neighbor = first_unlinked; neighbor != adjacency.end(v); neighbor++) {
+                afforest::Link(v, *neighbor, component.get());
+            }
+        }
+    });
+    afforest::Compress(num_vertices, component.get(), pool);
+
+    // Number the roots in vertex order; every root is the lowest vertex of its component.
+    std::vector<uint32_t>& label = *labels;
+    label.resize(num_vertices);
+    uint32_t count = 0;
+    for (uint32_t v = 0; v < num_vertices; v++) {
+        if (component[v].load(std::memory_order_relaxed) == v) {
+            label[v] = count++;
+        }
+    }
+    pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            const uint32_t root = component[v].load(std::memory_order_relaxed);
+            if (root != v) {
+                label[v] = label[root];
+            }
+        }
+    });
+    return count;
+}
+
+#endif /* PARALLEL_COMPONENTS_H_ */
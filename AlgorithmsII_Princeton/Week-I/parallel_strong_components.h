@@ -0,0 +1,249 @@
+#ifndef PARALLEL_STRONG_COMPONENTS_H_
+#define PARALLEL_STRONG_COMPONENTS_H_
+
+#include "compressed_adjacency.h"
+#include "thread_pool.h"
+#include "vertex_index.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace forward_backward {
+
+// Component ids shared by the workers, kNoVertex until a vertex is labeled. A label is only stored once the whole
+// component of the vertex is known, so the unlabeled vertices always form a union of components.
+typedef std::unique_ptr<std::atomic<uint32_t>[]> Labels;
+
+inline bool Unlabeled(const Labels& label, uint32_t v) {
+    return label[v].load(std::memory_order_relaxed) == kNoVertex;
+}
+
+// Whether some edge of adjacency joins v to another unlabeled vertex.
+inline bool HasUnlabeledNeighbor(const CompressedAdjacency& adjacency, uint32_t v, const Labels& label) {
+    for (const uint32_t* neighbor = adjacency.begin(v); neighbor != adjacency.end(v); neighbor++) {
+        if (*neighbor != v && Unlabeled(label, *neighbor)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reset the queued flag of every vertex of frontier, so that a round can queue them again.
+inline void ClearQueued(const std::vector<uint32_t>& frontier, ThreadPool* pool, std::atomic<uint8_t>* queued) {
+    pool->ParallelFor(frontier.size(), 4096, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; i++) {
+            queued[frontier[i]].store(0, std::memory_order_relaxed);
+        }
+    });
+}
+
+// Queue v for the next round unless it is queued already.
+inline void Enqueue(uint32_t v, std::atomic<uint8_t>* queued, std::vector<uint32_t>* next) {
+    if (queued[v].load(std::memory_order_relaxed) == 0 && queued[v].exchange(1, std::memory_order_relaxed) == 0) {
+        next->push_back(v);
+    }
+}
+
+// Label every vertex of remaining without an unlabeled in-neighbor or out-neighbor as a component of its own, which
+// it is since no cycle through other unlabeled vertices can pass it, until no such vertex is left. Only the neighbors
+// of the vertices labeled in a round are checked in the next one, so peeling a long chain costs O(V + E) in all.
+// remaining is left holding the vertices still unlabeled.
+inline void Trim(const CompressedAdjacency& forward, const CompressedAdjacency& backward, ThreadPool* pool, Labels* label,
+                 std::atomic<uint32_t>* count, std::atomic<uint8_t>* queued, std::vector<uint32_t>* remaining,
+                 std::vector<std::vector<uint32_t>>* local) {
+    std::vector<uint32_t> frontier(*remaining);
+    while (!frontier.empty()) {
+        ClearQueued(frontier, pool, queued);
+        pool->ParallelFor(frontier.size(), 1024, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                const uint32_t v = frontier[i];
+                if (!Unlabeled(*label, v) ||
+                    (HasUnlabeledNeighbor(forward, v, *label) && HasUnlabeledNeighbor(backward, v, *label))) {
+                    continue;
+                }
+                (*label)[v].store(count->fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+                for (const CompressedAdjacency* adjacency : {&forward, &backward}) {
+                    for (const uint32_t* neighbor = adjacency->begin(v); neighbor != adjacency->end(v); neighbor++) {
+                        if (Unlabeled(*label, *neighbor)) {
+                            Enqueue(*neighbor, queued, &(*local)[worker]);
+                        }
+                    }
+                }
+            }
+        });
+        frontier.clear();
+        ParallelConcatenate(pool, local, &frontier);
+    }
+    pool->ParallelFor(remaining->size(), 4096, [&](size_t begin, size_t end, int worker) {
+        for (size_t i = begin; i < end; i++) {
+            if (Unlabeled(*label, (*remaining)[i])) {
+                (*local)[worker].push_back((*remaining)[i]);
+            }
+        }
+    });
+    remaining->clear();
+    ParallelConcatenate(pool, local, remaining);
+}
+
+// Level-synchronous BFS from source along adjacency through unlabeled vertices, setting mark[v] for every vertex
+// reached. Each vertex is claimed by the worker whose exchange sets its mark.
+inline void Reach(const CompressedAdjacency& adjacency, uint32_t source, const Labels& label, ThreadPool* pool,
+                  std::atomic<uint8_t>* mark, std::vector<std::vector<uint32_t>>* local) {
+    std::vector<uint32_t> frontier(1, source);
+    mark[source].store(1, std::memory_order_relaxed);
+    while (!frontier.empty()) {
+        pool->ParallelFor(frontier.size(), 64, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                const uint32_t v = frontier[i];
+                for (const uint32_t* neighbor = adjacency.begin(v); neighbor != adjacency.end(v); neighbor++) {
+                    if (mark[*neighbor].load(std::memory_order_relaxed) == 0 && Unlabeled(label, *neighbor) &&
+                        mark[*neighbor].exchange(1, std::memory_order_relaxed) == 0) {
+                        (*local)[worker].push_back(*neighbor);
+                    }
+                }
+            }
+        });
+        frontier.clear();
+        ParallelConcatenate(pool, local, &frontier);
+    }
+}
+
+}  // namespace forward_backward
+
+// Strongly connected components of a directed graph given by its forward adjacency and the reverse (in-edge) adjacency,
+// with the multistep algorithm of Slota et al. for graphs with a giant component:
+// - Trim: vertices without in-edges or out-edges among the unlabeled vertices are components of their own.
+// - Forward-backward: the vertices both reachable from and reaching a pivot, the unlabeled vertex of largest in-degree
+//   times out-degree, form its component; one pair of parallel BFS usually labels the giant component.
+// - Coloring: every unlabeled vertex takes the largest vertex that reaches it as its color, propagated in parallel
+//   rounds from the vertices whose color changed; a vertex r keeping its own color reaches every vertex of color r, so
+//   its component is the vertices of color r that reach r, found by a BFS along the in-edges per color, all colors at
+//   once. Trimmed and repeated until every vertex is labeled.
+// Fills labels with component ids 0..count-1 and returns count. Unlike TarjanComponents, the ids follow no order.
+inline uint32_t ParallelStrongComponents(const CompressedAdjacency& forward, const CompressedAdjacency& backward,
+                                         ThreadPool* pool, std::vector<uint32_t>* labels) {
+    const uint32_t num_vertices = forward.V();
+    forward_backward::Labels label(new std::atomic<uint32_t>[num_vertices]);
+    std::unique_ptr<std::atomic<uint8_t>[]> reached_forward(new std::atomic<uint8_t>[num_vertices]);
+    std::unique_ptr<std::atomic<uint8_t>[]> reached_backward(new std::atomic<uint8_t>[num_vertices]);
+    std::unique_ptr<std::atomic<uint8_t>[]> queued(new std::atomic<uint8_t>[num_vertices]);
+    std::vector<uint32_t> remaining(num_vertices);
+    pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            label[v].store(kNoVertex, std::memory_order_relaxed);
+            reached_forward[v].store(0, std::memory_order_relaxed);
+            reached_backward[v].store(0, std::memory_order_relaxed);
+            remaining[v] = static_cast<uint32_t>(v);
+        }
+    });
+    std::atomic<uint32_t> count(0);
+    std::vector<std::vector<uint32_t>> local(pool->size());
+
+    forward_backward::Trim(forward, backward, pool, &label, &count, queued.get(), &remaining, &local);
+    if (!remaining.empty()) {
+        uint32_t pivot = remaining[0];
+        uint64_t pivot_degree = 0;
+        for (const uint32_t v : remaining) {
+            const uint64_t degree = static_cast<uint64_t>(forward.Degree(v)) * backward.Degree(v);
+            if (degree > pivot_degree) {
+                pivot = v;
+                pivot_degree = degree;
+            }
+        }
+        forward_backward::Reach(forward, pivot, label, pool, reached_forward.get(), &local);
+        forward_backward::Reach(backward, pivot, label, pool, reached_backward.get(), &local);
+        const uint32_t pivot_component = count.fetch_add(1, std::memory_order_relaxed);
+        pool->ParallelFor(remaining.size(), 4096, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                const uint32_t v = remaining[i];
+                if (reached_forward[v].load(std::memory_order_relaxed) && reached_backward[v].load(std::memory_order_relaxed)) {
+                    label[v].store(pivot_component, std::memory_order_relaxed);
+                } else {
+                    local[worker].push_back(v);
+                }
+            }
+        });
+        remaining.clear();
+        ParallelConcatenate(pool, &local, &remaining);
+        forward_backward::Trim(forward, backward, pool, &label, &count, queued.get(), &remaining, &local);
+    }
+
+    std::unique_ptr<std::atomic<uint32_t>[]> color(new std::atomic<uint32_t>[num_vertices]);
+    std::vector<uint32_t> frontier, roots;
+    // Per worker BFS queue of the component searches.
+    std::vector<std::vector<uint32_t>> queues(pool->size());
+    while (!remaining.empty()) {
+        pool->ParallelFor(remaining.size(), 4096, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; i++) {
+                color[remaining[i]].store(remaining[i], std::memory_order_relaxed);
+            }
+        });
+        // Colors only grow; a round pushes the colors of the vertices whose color grew in the last one.
+        frontier = remaining;
+        while (!frontier.empty()) {
+            forward_backward::ClearQueued(frontier, pool, queued.get());
+            pool->ParallelFor(frontier.size(), 256, [&](size_t begin, size_t end, int worker) {
+                for (size_t i = begin; i < end; i++) {
+                    const uint32_t v = frontier[i];
+                    const uint32_t v_color = color[v].load(std::memory_order_relaxed);
+                    for (const uint32_t* neighbor = forward.begin(v); neighbor != forward.end(v); neighbor++) {
+                        if (!forward_backward::Unlabeled(label, *neighbor)) {
+                            continue;
+                        }
+                        uint32_t neighbor_color = color[*neighbor].load(std::memory_order_relaxed);
+                        while (neighbor_color < v_color &&
+                               !color[*neighbor].compare_exchange_weak(neighbor_color, v_color, std::memory_order_relaxed)) {
+                        }
+                        if (neighbor_color < v_color) {
+                            forward_backward::Enqueue(*neighbor, queued.get(), &local[worker]);
+                        }
+                    }
+                }
+            });
+            frontier.clear();
+            ParallelConcatenate(pool, &local, &frontier);
+        }
+
+        pool->ParallelFor(remaining.size(), 4096, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                if (color[remaining[i]].load(std::memory_order_relaxed) == remaining[i]) {
+                    local[worker].push_back(remaining[i]);
+                }
+            }
+        });
+        roots.clear();
+        ParallelConcatenate(pool, &local, &roots);
+        // The searches of different colors touch disjoint vertices, so each labels its own without synchronization.
+        pool->ParallelFor(roots.size(), 1, [&](size_t begin, size_t end, int worker) {
+            std::vector<uint32_t>& queue = queues[worker];
+            for (size_t i = begin; i < end; i++) {
+                const uint32_t root = roots[i];
+                const uint32_t component = count.fetch_add(1, std::memory_order_relaxed);
+                queue.assign(1, root);
+                label[root].store(component, std::memory_order_relaxed);
+                for (size_t head = 0; head < queue.size(); head++) {
+                    const uint32_t v = queue[head];
+                    for (const uint32_t* neighbor = backward.begin(v); neighbor != backward.end(v); neighbor++) {
+                        if (forward_backward::Unlabeled(label, *neighbor) && color[*neighbor].load(std::memory_order_relaxed) == root) {
+                            label[*neighbor].store(component, std::memory_order_relaxed);
+                            queue.push_back(*neighbor);
+                        }
+                    }
+                }
+            }
+        });
+        forward_backward::Trim(forward, backward, pool, &label, &count, queued.get(), &remaining, &local);
+    }
+
+    labels->resize(num_vertices);
+    pool->ParallelFor(num_vertices, 4096, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++) {
+            (*labels)[v] = label[v].load(std::memory_order_relaxed);
+        }
+    });
+    return count.load(std::memory_order_relaxed);
+}
+
+#endif /* PARALLEL_STRONG_COMPONENTS_H_ */
@@ -0,0 +1,92 @@
+#ifndef PATH_TREE_H_
+#define PATH_TREE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Distance recorded for a vertex a PathTree does not reach.
+const int64_t kUnreached = INT64_MAX;
+
+// Shortest path tree from one source over dense ids: the distance of every reached vertex and the vertex it is reached
+// from on a shortest path. The source is its own parent. Trees of unweighted traversals (BFS, DFS) hold the depth of
+// every vertex, its count of edges from the source, as its distance. A tree is a plain value owned by its caller, so
+// it stays valid however many traversals run after the one that filled it.
+class PathTree {
+  private:
+    std::vector<int64_t> distance_;
+    std::vector<uint32_t> parent_;
+    uint32_t source_;
+
+  public:
+    PathTree() : source_(0) {}
+
+    // Start a tree from source over num_vertices vertices, with only the source reached.
+    void Reset(uint32_t num_vertices, uint32_t source) {
+        distance_.assign(num_vertices, kUnreached);
+        parent_.resize(num_vertices);
+        source_ = source;
+        distance_[source] = 0;
+        parent_[source] = source;
+    }
+
+    // Drop every vertex, so that none is reached.
+    void Clear() {
+        distance_.clear();
+        parent_.clear();
+        source_ = 0;
+    }
+
+    // Get count of vertices covered by the tree.
+    uint32_t V() const { return static_cast<uint32_t>(distance_.size()); }
+
+    uint32_t source() const { return source_; }
+
+    bool reached(uint32_t v) const { return v < distance_.size() && distance_[v] != kUnreached; }
+
+    // Distance of v from the source; only meaningful if v is reached.
+    int64_t distance(uint32_t v) const { return distance_[v]; }
+
+    uint32_t parent(uint32_t v) const { return parent_[v]; }
+
+    // Record that v is reached at distance from parent.
+    void Reach(uint32_t v, int64_t distance, uint32_t parent) {
+        distance_[v] = distance;
+        parent_[v] = parent;
+    }
+
+    // Fill path with the vertices from the source to v and return true, or return false if v is not reached.
+    bool PathTo(uint32_t v, std::vector<uint32_t>* path) const {
+        path->clear();
+        if (!reached(v)) {
+            return false;
+        }
+        for (uint32_t node = v; ; node = parent_[node]) {
+            path->push_back(node);
+            if (node == source_) break;
+        }
+        std::reverse(path->begin(), path->end());
+        return true;
+    }
+
+    // Paths from the source to every vertex of targets, one after the other in nodes: the path to targets[i] is
+    // nodes[offsets[i] .. offsets[i + 1]), empty if targets[i] is not reached. Takes time linear in the total length.
+    void PathsTo(const std::vector<uint32_t>& targets, std::vector<uint32_t>* nodes, std::vector<size_t>* offsets) const {
+        nodes->clear();
+        offsets->assign(1, 0);
+        offsets->reserve(targets.size() + 1);
+        for (const uint32_t target : targets) {
+            if (reached(target)) {
+                const size_t begin = nodes->size();
+                for (uint32_t node = target; ; node = parent_[node]) {
+                    nodes->push_back(node);
+                    if (node == source_) break;
+                }
+                std::reverse(nodes->begin() + begin, nodes->end());
+            }
+            offsets->push_back(nodes->size());
+        }
+    }
+};
+
+#endif /* PATH_TREE_H_ */
@@ -0,0 +1,173 @@
+#ifndef REACHABILITY_INDEX_H_
+#define REACHABILITY_INDEX_H_
+
+#include "compressed_adjacency.h"
+#include "dfs_engine.h"
+#include "strong_components.h"
+#include "traversal_context.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Reachability labels over the condensation (DAG of strongly connected components) of an adjacency, after GRAIL
+// (Yildirim et al.). Every component gets a topological rank, a level (longest path from a component without
+// in-edges) and one interval [low, rank] per labeling, where rank is a post-order number and low the lowest rank among
+// its descendants. If from reaches to, the interval of to lies inside the one of from in every labeling and to comes
+// later in topological order and on a deeper level, so a query failing any of these checks is answered false in O(1).
+// Queries passing all of them fall back to a DFS over the condensation that only enters components passing them too.
+class ReachabilityIndex {
+  private:
+    std::vector<uint32_t> component_;
+    CompressedAdjacency condensed_;
+    std::vector<uint32_t> level_;
+
+    // Intervals of the labelings; those of component c are at c * num_labelings_ .. (c + 1) * num_labelings_ - 1.
+    int num_labelings_;
+    std::vector<uint32_t> low_;
+    std::vector<uint32_t> rank_;
+
+    // Scratch state of the fallback search for Reaches(from, to), and counters of queries and of the ones that needed
+    // it, counted by concurrent queries too.
+    TraversalContext context_;
+    mutable std::atomic<uint64_t> queries_;
+    mutable std::atomic<uint64_t> searches_;
+
+    // Return whether every check allows a path from component from to component to.
+    bool MayReach(uint32_t from, uint32_t to) const {
+        // Tarjan numbers components in reverse topological order: edges go from higher to lower ids.
+        if (from < to || level_[from] >= level_[to]) {
+            return false;
+        }
+        for (int i = 0; i < num_labelings_; i++) {
+            const size_t f = static_cast<size_t>(from) * num_labelings_ + i, t = static_cast<size_t>(to) * num_labelings_ + i;
+            if (low_[t] < low_[f] || rank_[t] > rank_[f]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  public:
+    ReachabilityIndex() : num_labelings_(0), queries_(0), searches_(0) {}
+
+    // Build the labels for adjacency with num_labelings intervals per component (2 to 5 is typical: more labelings
+    // answer more negative queries in O(1) at 8 bytes per component each). Uses context for the traversals.
+    void Build(const CompressedAdjacency& adjacency, int num_labelings, TraversalContext* context) {
+        num_labelings_ = std::max(1, num_labelings);
+        const uint32_t num_components = TarjanComponents(adjacency, context, &component_);
+        std::vector<std::pair<uint32_t, uint32_t>> condensed_edges;
+        for (uint32_t node = 0; node < adjacency.V(); node++) {
+            for (const uint32_t* neighbor = adjacency.begin(node); neighbor != adjacency.end(node); neighbor++) {
+                if (component_[node] != component_[*neighbor]) {
+                    condensed_edges.push_back({component_[node], component_[*neighbor]});
+                }
+            }
+        }
+        std::sort(condensed_edges.begin(), condensed_edges.end());
+        condensed_edges.erase(std::unique(condensed_edges.begin(), condensed_edges.end()), condensed_edges.end());
+        condensed_.Build(num_components, condensed_edges, AdjacencyDirection::kOut);
+
+        level_.assign(num_components, 0);
+        for (uint32_t c = num_components; c-- > 0; ) {
+            for (const uint32_t* successor = condensed_.begin(c); successor != condensed_.end(c); successor++) {
+                level_[*successor] = std::max(level_[*successor], level_[c] + 1);
+            }
+        }
+
+        // The first labeling ranks components by their Tarjan number, itself a post-order; the others by the post-order
+        // of a DFS over the condensation from the roots in random order.
+        low_.assign(static_cast<size_t>(num_components) * num_labelings_, 0);
+        rank_.assign(static_cast<size_t>(num_components) * num_labelings_, 0);
+        std::vector<uint32_t> roots(num_components);
+        std::iota(roots.begin(), roots.end(), 0);
+        std::mt19937 generator(46649);
+        for (int i = 0; i < num_labelings_; i++) {
+            uint32_t post_order = 0;
+            if (i == 0) {
+                for (uint32_t c = 0; c < num_components; c++) {
+                    rank_[static_cast<size_t>(c) * num_labelings_] = c;
+                }
+            } else {
+                std::shuffle(roots.begin(), roots.end(), generator);
+                context->Reset(num_components);
+                const auto post_visit = [&](uint32_t c) {
+                    rank_[static_cast<size_t>(c) * num_labelings_ + i] = post_order++;
+                    return true;
+                };
+                for (const uint32_t root : roots) {
+                    if (!context->visited(root)) {
+                        DepthFirstSearch(condensed_, root, context, dfs::Continue(), dfs::Continue(), post_visit);
+                    }
+                }
+            }
+            // Successors have lower ids, so ascending ids see every successor before its predecessors.
+            for (uint32_t c = 0; c < num_components; c++) {
+                const size_t label = static_cast<size_t>(c) * num_labelings_ + i;
+                low_[label] = rank_[label];
+                for (const uint32_t* successor = condensed_.begin(c); successor != condensed_.end(c); successor++) {
+                    low_[label] = std::min(low_[label], low_[static_cast<size_t>(*successor) * num_labelings_ + i]);
+                }
+            }
+        }
+        queries_ = searches_ = 0;
+    }
+
+    // Return whether there is a path from vertex from to vertex to.
+    bool Reaches(uint32_t from, uint32_t to) { return Reaches(from, to, &context_); }
+
+    // Same, with context as the scratch state of the fallback search, so threads with their own contexts can query at
+    // once.
+    bool Reaches(uint32_t from, uint32_t to, TraversalContext* context) const {
+        queries_.fetch_add(1, std::memory_order_relaxed);
+        const uint32_t source = component_[from], target = component_[to];
+        if (source == target) {
+            return true;
+        }
+        if (!MayReach(source, target)) {
+            return false;
+        }
+        searches_.fetch_add(1, std::memory_order_relaxed);
+        context->Reset(condensed_.V());
+        std::vector<uint32_t>& components_stack = *context->buffer();
+        context->Visit(source);
+        components_stack.push_back(source);
+        while (!components_stack.empty()) {
+            const uint32_t c = components_stack.back();
+            components_stack.pop_back();
+            for (const uint32_t* successor = condensed_.begin(c); successor != condensed_.end(c); successor++) {
+                if (*successor == target) {
+                    return true;
+                }
+                if (!context->visited(*successor) && MayReach(*successor, target)) {
+                    context->Visit(*successor);
+                    components_stack.push_back(*successor);
+                }
+            }
+        }
+        return false;
+    }
+
+    // Get count of vertices covered by the index.
+    uint32_t V() const { return static_cast<uint32_t>(component_.size()); }
+
+    // Get count of components and of edges between them.
+    uint32_t components() const { return condensed_.V(); }
+    uint32_t condensed_edges() const { return condensed_.E(); }
+
+    // Count of queries since Build, and of those that needed the fallback search.
+    uint64_t queries() const { return queries_.load(std::memory_order_relaxed); }
+    uint64_t searches() const { return searches_.load(std::memory_order_relaxed); }
+
+    // Bytes held by the labels and the condensation, not counting the scratch state of the fallback search.
+    size_t MemoryBytes() const {
+        return sizeof(uint32_t) * (component_.size() + (condensed_.V() + 1) + condensed_.E() + level_.size() +
+                                   low_.size() + rank_.size());
+    }
+};
+
+#endif /* REACHABILITY_INDEX_H_ */
@@ -0,0 +1,40 @@
+#ifndef STRING_REF_H_
+#define STRING_REF_H_
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+// Non-owning view of a run of characters, standing in for std::string_view (C++17) so that ids can be read straight
+// out of memory the graph does not own, such as a mapped snapshot file. Converts implicitly to std::string.
+class StringRef {
+  private:
+    const char* data_;
+    size_t size_;
+
+  public:
+    StringRef(const char* data, size_t size) : data_(data), size_(size) {}
+
+    StringRef(const std::string& s) : data_(s.data()), size_(s.size()) {}
+
+    const char* data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    std::string str() const { return std::string(data_, size_); }
+
+    operator std::string() const { return str(); }
+
+    bool operator==(const StringRef& other) const {
+        return size_ == other.size_ && std::memcmp(data_, other.data_, size_) == 0;
+    }
+
+    bool operator!=(const StringRef& other) const { return !(*this == other); }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const StringRef& s) {
+    return out.write(s.data(), s.size());
+}
+
+#endif /* STRING_REF_H_ */
@@ -0,0 +1,65 @@
+#ifndef STRONG_COMPONENTS_H_
+#define STRONG_COMPONENTS_H_
+
+#include "compressed_adjacency.h"
+#include "dfs_engine.h"
+#include "traversal_context.h"
+#include "vertex_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Strongly connected components of adjacency with Tarjan's algorithm, run on the explicit-stack DFS engine so deep
+// graphs do not overflow the call stack. Fills labels with component ids 0..count-1 and returns count. Components are
+// numbered in reverse topological order of the condensation: every edge between two components goes from a higher id
+// to a lower one. Resets context.
+inline uint32_t TarjanComponents(const CompressedAdjacency& adjacency, TraversalContext* context, std::vector<uint32_t>* labels) {
+    const uint32_t num_vertices = adjacency.V();
+    // Preorder number of each vertex and the lowest preorder number reachable from its DFS subtree through at most one
+    // non-tree edge into a vertex still on the component stack.
+    std::vector<uint32_t> preorder(num_vertices), low(num_vertices);
+    std::vector<uint32_t> component_stack;
+    std::vector<uint32_t>& label = *labels;
+    label.assign(num_vertices, kNoVertex);
+    uint32_t counter = 0, count = 0;
+
+    const auto pre_visit = [&](uint32_t node, uint32_t) {
+        preorder[node] = low[node] = counter++;
+        component_stack.push_back(node);
+        return true;
+    };
+    // A vertex is on the component stack until its component is labeled.
+    const auto non_tree_edge = [&](uint32_t from, uint32_t to) {
+        if (label[to] == kNoVertex) {
+            low[from] = std::min(low[from], preorder[to]);
+        }
+        return true;
+    };
+    const auto post_visit = [&](uint32_t node) {
+        if (low[node] == preorder[node]) {
+            uint32_t member;
+            do {
+                member = component_stack.back();
+                component_stack.pop_back();
+                label[member] = count;
+            } while (member != node);
+            count++;
+        }
+        const uint32_t parent = context->parent(node);
+        if (parent != node) {
+            low[parent] = std::min(low[parent], low[node]);
+        }
+        return true;
+    };
+
+    context->Reset(num_vertices);
+    for (uint32_t node = 0; node < num_vertices; node++) {
+        if (!context->visited(node)) {
+            DepthFirstSearch(adjacency, node, context, pre_visit, non_tree_edge, post_visit);
+        }
+    }
+    return count;
+}
+
+#endif /* STRONG_COMPONENTS_H_ */
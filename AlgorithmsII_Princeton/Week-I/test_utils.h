@@ -1,7 +1,12 @@
 #ifndef TEST_UTILS_H_
 #define TEST_UTILS_H_
 
+#include "edge.h"
+
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace testing {
 
@@ -103,6 +108,24 @@ bool ComparePaths(const std::vector<std::string>& path_1, const std::vector<std:
     return true;
 }
 
+/**
+* Util function for num_edges random edges between the nodes "0" to num_nodes - 1, self loops and parallel edges
+* included, with weights in [min_weight, max_weight]. The same seed gives the same edges.
+*/
+std::vector<Edge> RandomEdges(int num_nodes, int num_edges, unsigned seed, int max_weight = 1, int min_weight = 1) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> node(0, num_nodes - 1);
+    std::uniform_int_distribution<int> weight(min_weight, max_weight);
+    std::vector<Edge> edges;
+    edges.reserve(num_edges);
+    for (int i = 0; i < num_edges; i++) {
+        const int from = node(generator);
+        const int to = node(generator);
+        edges.push_back(Edge(std::to_string(from), std::to_string(to), weight(generator)));
+    }
+    return edges;
+}
+
 }  // namespace testing
 
 #endif /* TEST_UTILS_H_ */
@@ -0,0 +1,152 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running parallel loops. The calling thread takes part as worker 0.
+class ThreadPool {
+  private:
+    // Range of loop indices first handed to one worker. Other workers steal chunks from it once their own share is done.
+    struct Share {
+        std::atomic<size_t> next;
+        size_t end;
+        char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    };
+
+    std::vector<std::thread> threads_;
+    std::unique_ptr<Share[]> shares_;
+    const int num_workers_;
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_;
+    int pending_workers_;
+    bool stop_;
+
+    // Loop body and chunk size of the loop being run.
+    const std::function<void(size_t, size_t, int)>* body_;
+    size_t grain_;
+
+    // Claim chunks from the share of victim until it is exhausted.
+    void RunShare(int victim, int worker) {
+        Share& share = shares_[victim];
+        while (true) {
+            const size_t begin = share.next.fetch_add(grain_, std::memory_order_relaxed);
+            if (begin >= share.end) {
+                return;
+            }
+            (*body_)(begin, std::min(begin + grain_, share.end), worker);
+        }
+    }
+
+    // Run the own share of worker, then steal from the other workers in round robin order.
+    void Run(int worker) {
+        for (int i = 0; i < num_workers_; i++) {
+            RunShare((worker + i) % num_workers_, worker);
+        }
+    }
+
+    void WorkerLoop(int worker) {
+        uint64_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+                if (stop_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+            Run(worker);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_workers_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+
+  public:
+    // Create a pool of num_threads workers, or one per hardware thread if num_threads is not positive.
+    explicit ThreadPool(int num_threads)
+        : num_workers_(num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency())),
+          generation_(0), pending_workers_(0), stop_(false), body_(nullptr), grain_(1) {
+        shares_.reset(new Share[num_workers_]);
+        for (int worker = 1; worker < num_workers_; worker++) {
+            threads_.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    // Get count of workers, including the calling thread.
+    int size() const { return num_workers_; }
+
+    // Call body(begin, end, worker) on chunks of at most grain indices covering [0, n), and return once all are done.
+    // Each worker starts on its own contiguous share of the range and then steals chunks from the shares of the
+    // others, so uneven chunks still keep every worker busy. Not reentrant: body must not call ParallelFor.
+    void ParallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t, int)>& body) {
+        if (n == 0) {
+            return;
+        }
+        if (num_workers_ == 1 || n <= grain) {
+            body(0, n, 0);
+            return;
+        }
+        const size_t share_size = (n + num_workers_ - 1) / num_workers_;
+        for (int worker = 0; worker < num_workers_; worker++) {
+            const size_t begin = std::min(n, worker * share_size);
+            shares_[worker].next.store(begin, std::memory_order_relaxed);
+            shares_[worker].end = std::min(n, begin + share_size);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            body_ = &body;
+            grain_ = std::max<size_t>(1, grain);
+            pending_workers_ = num_workers_ - 1;
+            generation_++;
+        }
+        start_cv_.notify_all();
+        Run(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [&] { return pending_workers_ == 0; });
+    }
+};
+
+// Append the per worker buffers of parts to out, in worker order, with each worker copying one buffer. The buffers are
+// left empty for reuse. A few elements are copied by the calling thread alone, which is cheaper than waking the workers.
+template <typename T>
+void ParallelConcatenate(ThreadPool* pool, std::vector<std::vector<T>>* parts, std::vector<T>* out) {
+    const size_t kSerialElements = 4096;
+    std::vector<size_t> offsets(parts->size() + 1, out->size());
+    for (size_t part = 0; part < parts->size(); part++) {
+        offsets[part + 1] = offsets[part] + (*parts)[part].size();
+    }
+    out->resize(offsets.back());
+    const size_t grain = offsets.back() - offsets.front() < kSerialElements ? parts->size() : 1;
+    pool->ParallelFor(parts->size(), grain, [&](size_t begin, size_t end, int) {
+        for (size_t part = begin; part < end; part++) {
+            std::copy((*parts)[part].begin(), (*parts)[part].end(), out->begin() + offsets[part]);
+            (*parts)[part].clear();
+        }
+    });
+}
+
+#endif /* THREAD_POOL_H_ */
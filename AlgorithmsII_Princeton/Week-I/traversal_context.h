@@ -0,0 +1,114 @@
+#ifndef TRAVERSAL_CONTEXT_H_
+#define TRAVERSAL_CONTEXT_H_
+
+#include "bitmap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Frame of an explicit-stack depth-first traversal: a vertex and the index of its next neighbor to explore.
+struct DFSFrame {
+    uint32_t node;
+    uint32_t next_neighbor;
+};
+
+// Visited marks, parents and scratch space of a traversal over dense vertex ids. Marks are stamped with
+// the epoch of the traversal that set them, so starting a new traversal only bumps the epoch and the
+// arrays are allocated once per context instead of once per traversal. Visited marks are atomic so that
+// parallel traversals can claim vertices with TryVisit(); sequential traversals only pay relaxed loads and stores.
+class TraversalContext {
+  private:
+    // Epoch of the traversal that visited / finished each vertex.
+    std::unique_ptr<std::atomic<uint32_t>[]> visited_stamp_;
+    std::vector<uint32_t> done_stamp_;
+
+    // Parent of each vertex; only meaningful for vertices visited in the current epoch.
+    std::vector<uint32_t> parent_;
+
+    // Scratch stack or queue of the current traversal.
+    std::vector<uint32_t> buffer_;
+
+    // Explicit stack of depth-first traversals.
+    std::vector<DFSFrame> frames_;
+
+    // Scratch set of vertices, left cleared by the traversals that use it.
+    Bitmap bitmap_;
+
+    uint32_t epoch_;
+
+  public:
+    TraversalContext() : epoch_(0) {}
+
+    // Start a new traversal over num_vertices vertices. Costs O(1) unless the graph grew since the last
+    // traversal or the epoch counter wrapped around.
+    void Reset(uint32_t num_vertices) {
+        if (done_stamp_.size() < num_vertices) {
+            std::unique_ptr<std::atomic<uint32_t>[]> visited_stamp(new std::atomic<uint32_t>[num_vertices]);
+            for (uint32_t v = 0; v < num_vertices; v++) {
+                visited_stamp[v].store(v < done_stamp_.size() ? visited_stamp_[v].load(std::memory_order_relaxed) : 0,
+                                       std::memory_order_relaxed);
+            }
+            visited_stamp_ = std::move(visited_stamp);
+            done_stamp_.resize(num_vertices, 0);
+            parent_.resize(num_vertices);
+        }
+        if (++epoch_ == 0) {
+            for (uint32_t v = 0; v < done_stamp_.size(); v++) {
+                visited_stamp_[v].store(0, std::memory_order_relaxed);
+            }
+            std::fill(done_stamp_.begin(), done_stamp_.end(), 0);
+            epoch_ = 1;
+        }
+        buffer_.clear();
+    }
+
+    // Return whether v was visited in the current traversal.
+    bool visited(uint32_t v) const {
+        return v < done_stamp_.size() && visited_stamp_[v].load(std::memory_order_relaxed) == epoch_;
+    }
+
+    // Mark v as visited.
+    void Visit(uint32_t v) { visited_stamp_[v].store(epoch_, std::memory_order_relaxed); }
+
+    // Mark v as visited and record the vertex it was reached from.
+    void Visit(uint32_t v, uint32_t parent) {
+        visited_stamp_[v].store(epoch_, std::memory_order_relaxed);
+        parent_[v] = parent;
+    }
+
+    // Mark v as visited from parent unless it is visited already. Safe to call concurrently: exactly one caller
+    // claims v and gets true, and only that caller writes the parent of v.
+    bool TryVisit(uint32_t v, uint32_t parent) {
+        uint32_t stamp = visited_stamp_[v].load(std::memory_order_relaxed);
+        if (stamp == epoch_ || !visited_stamp_[v].compare_exchange_strong(stamp, epoch_, std::memory_order_relaxed)) {
+            return false;
+        }
+        parent_[v] = parent;
+        return true;
+    }
+
+    // Return whether v was finished (all its descendants explored) in the current traversal.
+    bool done(uint32_t v) const { return v < done_stamp_.size() && done_stamp_[v] == epoch_; }
+
+    // Mark v as finished.
+    void Finish(uint32_t v) { done_stamp_[v] = epoch_; }
+
+    // Vertex v was reached from; a traversal root is its own parent.
+    uint32_t parent(uint32_t v) const { return parent_[v]; }
+
+    void set_parent(uint32_t v, uint32_t parent) { parent_[v] = parent; }
+
+    // Scratch buffer for the stack or queue of a traversal; emptied by Reset().
+    std::vector<uint32_t>* buffer() { return &buffer_; }
+
+    // Scratch stack of depth-first traversals; kept across traversals so deep searches allocate it only once.
+    std::vector<DFSFrame>* frames() { return &frames_; }
+
+    // Scratch bitmap; traversals clear the bits they set before returning.
+    Bitmap* bitmap() { return &bitmap_; }
+};
+
+#endif /* TRAVERSAL_CONTEXT_H_ */
@@ -0,0 +1,518 @@
+#ifndef VERSIONED_GRAPH_H_
+#define VERSIONED_GRAPH_H_
+
+#include "bidirectional_bfs.h"
+#include "compressed_adjacency.h"
+#include "edge.h"
+#include "node.h"
+#include "traversal_context.h"
+#include "vertex_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace versioned_graph {
+
+const uint32_t kNoArc = UINT32_MAX;
+
+// An edge of the overlay over dense ids, kept to fold the overlay into a new base.
+struct OverlayEdge {
+    uint32_t from;
+    uint32_t to;
+    int weight;
+};
+
+// An arc of the overlay: its head and the arc added before it out of the same vertex, or kNoArc.
+struct Arc {
+    uint32_t to;
+    uint32_t next;
+};
+
+// Vertices and edges published on top of a base graph, appended in place by the single writer while readers search
+// it. Every array is allocated once at its capacity, so nothing a reader holds ever moves, and an entry is written in
+// full before the atomic store that links it in. A version sees only the first num_vertices vertices and num_edges
+// edges, and skips anything appended after it was published. Overlay vertex i has dense id base_vertices + i.
+//
+// Edge e has arcs 2e (from -> to) and 2e + 1 (to -> from); each vertex heads a list of its arcs, newest first, in
+// heads_[0] for out-arcs and heads_[1] for in-arcs, or both in heads_[0] for an undirected graph.
+class Overlay {
+  private:
+    const uint32_t base_vertices_;
+    const bool directed_;
+    const uint32_t vertex_capacity_;
+    const uint32_t edge_capacity_;
+
+    // String id of every overlay vertex, and an open addressing table of overlay vertex numbers (kNoVertex if free),
+    // probed linearly from HashId() of the id.
+    std::unique_ptr<std::string[]> ids_;
+    const uint64_t slot_mask_;
+    std::unique_ptr<std::atomic<uint32_t>[]> slots_;
+
+    std::unique_ptr<std::atomic<uint32_t>[]> heads_[2];
+    std::unique_ptr<Arc[]> arcs_;
+    std::unique_ptr<OverlayEdge[]> edges_;
+
+    // Counts appended so far; only read and written by the writer.
+    uint32_t num_vertices_;
+    uint32_t num_edges_;
+
+    static uint64_t SlotCount(uint32_t vertex_capacity) {
+        uint64_t count = 1;
+        while (count < 2 * static_cast<uint64_t>(vertex_capacity)) count *= 2;
+        return count;
+    }
+
+    void Link(int side, uint32_t from, uint32_t to, uint32_t arc) {
+        arcs_[arc] = {to, heads_[side][from].load(std::memory_order_relaxed)};
+        heads_[side][from].store(arc, std::memory_order_release);
+    }
+
+  public:
+    Overlay(uint32_t base_vertices, bool directed, uint32_t vertex_capacity, uint32_t edge_capacity)
+        : base_vertices_(base_vertices), directed_(directed), vertex_capacity_(vertex_capacity), edge_capacity_(edge_capacity),
+          ids_(new std::string[vertex_capacity]), slot_mask_(SlotCount(vertex_capacity) - 1),
+          slots_(new std::atomic<uint32_t>[slot_mask_ + 1]), arcs_(new Arc[2 * static_cast<size_t>(edge_capacity)]),
+          edges_(new OverlayEdge[edge_capacity]), num_vertices_(0), num_edges_(0) {
+        for (uint64_t slot = 0; slot <= slot_mask_; slot++) {
+            slots_[slot].store(kNoVertex, std::memory_order_relaxed);
+        }
+        const uint32_t num_heads = base_vertices + vertex_capacity;
+        for (int side = 0; side < (directed ? 2 : 1); side++) {
+            heads_[side].reset(new std::atomic<uint32_t>[num_heads]);
+            for (uint32_t v = 0; v < num_heads; v++) {
+                heads_[side][v].store(kNoArc, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    uint32_t base_vertices() const { return base_vertices_; }
+    uint32_t num_vertices() const { return num_vertices_; }
+    uint32_t num_edges() const { return num_edges_; }
+
+    // Whether vertices more vertices and edges more edges can still be appended.
+    bool Fits(size_t vertices, size_t edges) const {
+        return num_vertices_ + vertices <= vertex_capacity_ && num_edges_ + edges <= edge_capacity_;
+    }
+
+    // Whether half the room is used, the point at which the overlay should be folded into a new base.
+    bool HalfFull() const { return 2 * num_vertices_ >= vertex_capacity_ || 2 * num_edges_ >= edge_capacity_; }
+
+    // Dense id of id among the first num_vertices overlay vertices, or kNoVertex.
+    uint32_t Find(const std::string& id, uint32_t num_vertices) const {
+        for (uint64_t slot = HashId(id.data(), id.size()) & slot_mask_; ; slot = (slot + 1) & slot_mask_) {
+            const uint32_t v = slots_[slot].load(std::memory_order_acquire);
+            if (v == kNoVertex) return kNoVertex;
+            if (v < num_vertices && ids_[v] == id) return base_vertices_ + v;
+        }
+    }
+
+    // String id of the overlay vertex with dense id v.
+    const std::string& Id(uint32_t v) const { return ids_[v - base_vertices_]; }
+
+    const OverlayEdge& edge(uint32_t e) const { return edges_[e]; }
+
+    // Call visit(u) for the heads u of the out-arcs (side 0) or in-arcs (side 1) of dense id v among the first
+    // num_edges edges, newest first, until visit returns false. Returns false if visit did.
+    template <typename Visit>
+    bool ForEachArc(int side, uint32_t v, uint32_t num_edges, Visit visit) const {
+        const uint32_t end = 2 * num_edges;
+        for (uint32_t arc = heads_[directed_ ? side : 0][v].load(std::memory_order_acquire); arc != kNoArc; arc = arcs_[arc].next) {
+            if (arc < end && !visit(arcs_[arc].to)) return false;
+        }
+        return true;
+    }
+
+    // Append a vertex whose id is in neither the base nor the overlay, and return its dense id. Writer only.
+    uint32_t AddVertex(const std::string& id) {
+        const uint32_t v = num_vertices_++;
+        ids_[v] = id;
+        uint64_t slot = HashId(id.data(), id.size()) & slot_mask_;
+        while (slots_[slot].load(std::memory_order_relaxed) != kNoVertex) slot = (slot + 1) & slot_mask_;
+        slots_[slot].store(v, std::memory_order_release);
+        return base_vertices_ + v;
+    }
+
+    // Append an edge between dense ids. Writer only.
+    void AddEdge(uint32_t from, uint32_t to, int weight) {
+        const uint32_t e = num_edges_++;
+        edges_[e] = {from, to, weight};
+        Link(0, from, to, 2 * e);
+        Link(directed_ ? 1 : 0, to, from, 2 * e + 1);
+    }
+};
+
+}  // namespace versioned_graph
+
+// A graph updated by a writer while readers query it, in the style of read-copy-update. Writers buffer vertices and
+// edges as a delta; Publish() appends the delta to an overlay on top of an immutable base graph and swaps in a new
+// version with one atomic pointer store. Every version shares the base, its adjacency and its id index, so a Publish()
+// costs O(delta) however large the graph. Readers Pin() the latest version and query it with their own contexts for as
+// long as they like: a version never changes once published, and a pin keeps its base and overlay alive, so readers
+// never wait for the writer; they only share the short lock the standard library takes around loading and storing the
+// pointer. An old version is freed by the last reader that releases it.
+//
+// Once the overlay holds half as many edges or vertices as it has room for (a quarter of the base's, or 4096), a
+// background thread folds it into a new base graph and carries over whatever was published meanwhile. That costs
+// O(V + E) off the writer's and the readers' paths, once per growth of the graph by a quarter. A delta too large for the
+// room left is folded in by Publish() itself.
+//
+// GraphType is graph::Graph or directed_graph::DirectedGraph, or anything with their kDirected, their constructors from
+// edges and from a base graph plus vertices and edges, and their vertex_index(), out_adjacency() and in_adjacency().
+template <typename GraphType>
+class VersionedGraph {
+  public:
+    // A published graph: the base plus the first vertices and edges of the overlay. Queries search the base adjacency
+    // and the overlay arcs of every vertex they expand, and keep all their state in the contexts they are given.
+    class Version {
+      private:
+        const uint64_t number_;
+        const std::shared_ptr<const GraphType> base_;
+        const std::shared_ptr<const versioned_graph::Overlay> overlay_;
+        const uint32_t num_vertices_;
+        const uint32_t num_edges_;
+        const VertexIndex& index_;
+        const CompressedAdjacency* adjacencies_[2];
+
+        uint32_t num_dense() const { return index_.size() + num_vertices_; }
+
+        // Dense id of node_id, or kNoVertex.
+        uint32_t Find(const std::string& node_id) const {
+            const uint32_t v = index_.Find(node_id);
+            return v != kNoVertex ? v : overlay_->Find(node_id, num_vertices_);
+        }
+
+        std::string Id(uint32_t v) const { return v < index_.size() ? index_.Id(v).str() : overlay_->Id(v); }
+
+        // Neighbors of a vertex in the base, then in the overlay, for BidirectionalBFS.
+        struct MergedNeighbors {
+            const Version* version;
+
+            template <typename Visit>
+            void operator()(int side, uint32_t v, Visit visit) const {
+                if (v < version->index_.size()) {
+                    const CompressedAdjacency& adjacency = *version->adjacencies_[side];
+                    for (const uint32_t* neighbor = adjacency.begin(v); neighbor != adjacency.end(v); neighbor++) {
+                        if (!visit(*neighbor)) return;
+                    }
+                }
+                version->overlay_->ForEachArc(side, v, version->num_edges_, visit);
+            }
+        };
+
+        friend class VersionedGraph;
+
+      public:
+        Version(uint64_t number, const std::shared_ptr<const GraphType>& base,
+                const std::shared_ptr<const versioned_graph::Overlay>& overlay, uint32_t num_vertices, uint32_t num_edges)
+            : number_(number), base_(base), overlay_(overlay), num_vertices_(num_vertices), num_edges_(num_edges),
+              index_(base->vertex_index()), adjacencies_{&base->out_adjacency(), &base->in_adjacency()} {}
+
+        uint64_t number() const { return number_; }
+
+        int V() const { return base_->V() + num_vertices_; }
+
+        int E() const { return base_->E() + num_edges_; }
+
+        // The base graph, which holds this version up to the last compaction, with the whole query API of GraphType.
+        const GraphType& base() const { return *base_; }
+
+        bool HasVertex(const std::string& node_id) const { return Find(node_id) != kNoVertex; }
+
+        // Heads of the edges out of node_id (its neighbors for an undirected graph), base edges first.
+        std::vector<std::string> Neighbors(const std::string& node_id) const {
+            std::vector<std::string> neighbors;
+            const uint32_t v = Find(node_id);
+            if (v != kNoVertex) {
+                const MergedNeighbors for_each_neighbor = {this};
+                for_each_neighbor(0, v, [&](uint32_t neighbor) {
+                    neighbors.push_back(Id(neighbor));
+                    return true;
+                });
+            }
+            return neighbors;
+        }
+
+        // Whether a path leads from node_from to node_to; the search stops as soon as node_to is reached.
+        bool DoesPathExist(const std::string& node_from, const std::string& node_to, TraversalContext* context) const {
+            const uint32_t from = Find(node_from);
+            const uint32_t to = Find(node_to);
+            if (from == kNoVertex || to == kNoVertex) return false;
+            context->Reset(num_dense());
+            std::vector<uint32_t>& nodes_stack = *context->buffer();
+            nodes_stack.push_back(from);
+            context->Visit(from, from);
+            const MergedNeighbors for_each_neighbor = {this};
+            while (!nodes_stack.empty() && !context->visited(to)) {
+                const uint32_t curr_node = nodes_stack.back();
+                nodes_stack.pop_back();
+                for_each_neighbor(0, curr_node, [&](uint32_t neighbor) {
+                    if (!context->visited(neighbor)) {
+                        context->Visit(neighbor, curr_node);
+                        nodes_stack.push_back(neighbor);
+                    }
+                    return true;
+                });
+            }
+            return context->visited(to);
+        }
+
+        // Shortest path (fewest edges) from node_from to node_to found by a bidirectional BFS, like GraphType's
+        // ShortestPath. Empty if there is no path.
+        std::vector<std::string> ShortestPath(const std::string& node_from, const std::string& node_to,
+                                              TraversalContext* source_context, TraversalContext* target_context) const {
+            std::vector<std::string> path;
+            const uint32_t from = Find(node_from);
+            const uint32_t to = Find(node_to);
+            std::vector<uint32_t> dense_path;
+            const MergedNeighbors for_each_neighbor = {this};
+            if (from == kNoVertex || to == kNoVertex ||
+                !BidirectionalBFS(num_dense(), for_each_neighbor, from, to, source_context, target_context, &dense_path)) {
+                return path;
+            }
+            path.reserve(dense_path.size());
+            for (const uint32_t node : dense_path) {
+                path.push_back(Id(node));
+            }
+            return path;
+        }
+    };
+
+  private:
+    // Latest version, only loaded and stored with std::atomic_load and std::atomic_store.
+    std::shared_ptr<const Version> latest_;
+
+    // The overlay of the latest version, which Publish() appends to. Guarded by publish_mutex_.
+    std::shared_ptr<versioned_graph::Overlay> overlay_;
+
+    // Delta of the next version, guarded by delta_mutex_.
+    std::vector<Node> pending_vertices_;
+    std::vector<Edge> pending_edges_;
+    mutable std::mutex delta_mutex_;
+
+    // Serializes Publish() calls, and the swap of a compacted base, so that each builds on the latest version.
+    std::mutex publish_mutex_;
+
+    // Serializes compactions; taken before publish_mutex_, never after.
+    std::mutex compaction_mutex_;
+    std::atomic<uint64_t> compactions_;
+
+    // Wakes the background compaction thread when the overlay is half full or the graph is destroyed.
+    std::mutex compactor_mutex_;
+    std::condition_variable compactor_wakeup_;
+    bool compaction_requested_;
+    bool stopping_;
+    std::thread compactor_;
+
+    // An empty overlay on top of base, with room for a quarter of its vertices and edges, or 4096 of each.
+    static std::shared_ptr<versioned_graph::Overlay> NewOverlay(const GraphType& base) {
+        const uint32_t kMinRoom = 4096;
+        const bool directed = GraphType::kDirected;
+        return std::make_shared<versioned_graph::Overlay>(base.vertex_index().size(), directed,
+                                                          std::max<uint32_t>(kMinRoom, base.V() / 4),
+                                                          std::max<uint32_t>(kMinRoom, base.E() / 4));
+    }
+
+    // A new base graph holding version followed by the given vertices and edges, with its adjacency built.
+    static std::shared_ptr<const GraphType> Rebuild(const Version& version, const std::vector<Node>& vertices,
+                                                    const std::vector<Edge>& edges) {
+        std::vector<Node> all_vertices;
+        all_vertices.reserve(version.num_vertices_ + vertices.size());
+        const uint32_t base_vertices = version.index_.size();
+        for (uint32_t v = 0; v < version.num_vertices_; v++) {
+            all_vertices.push_back(Node(version.Id(base_vertices + v)));
+        }
+        for (const Node& vertex : vertices) {
+            all_vertices.push_back(vertex);
+        }
+        std::vector<Edge> all_edges;
+        all_edges.reserve(version.num_edges_ + edges.size());
+        for (uint32_t e = 0; e < version.num_edges_; e++) {
+            const versioned_graph::OverlayEdge& edge = version.overlay_->edge(e);
+            all_edges.push_back(Edge(version.Id(edge.from), version.Id(edge.to), edge.weight));
+        }
+        for (const Edge& edge : edges) {
+            all_edges.push_back(edge);
+        }
+        const std::shared_ptr<GraphType> base = std::make_shared<GraphType>(*version.base_, all_vertices, all_edges);
+        base->Freeze();
+        return base;
+    }
+
+    // Dense id of node_id in the latest base or among everything appended to overlay_, adding it to overlay_ if missing.
+    uint32_t Intern(const Version& latest, const std::string& node_id) {
+        uint32_t v = latest.index_.Find(node_id);
+        if (v == kNoVertex) v = overlay_->Find(node_id, overlay_->num_vertices());
+        return v != kNoVertex ? v : overlay_->AddVertex(node_id);
+    }
+
+    void RequestCompaction() {
+        {
+            std::lock_guard<std::mutex> lock(compactor_mutex_);
+            compaction_requested_ = true;
+        }
+        compactor_wakeup_.notify_one();
+    }
+
+    void RunCompactor() {
+        std::unique_lock<std::mutex> lock(compactor_mutex_);
+        while (true) {
+            compactor_wakeup_.wait(lock, [&]() { return compaction_requested_ || stopping_; });
+            if (stopping_) return;
+            compaction_requested_ = false;
+            lock.unlock();
+            Compact();
+            lock.lock();
+        }
+    }
+
+    void Start(const std::shared_ptr<const GraphType>& base) {
+        overlay_ = NewOverlay(*base);
+        latest_ = std::make_shared<const Version>(0, base, overlay_, 0, 0);
+        compactor_ = std::thread(&VersionedGraph::RunCompactor, this);
+    }
+
+  public:
+    // Start at version 0, an empty graph.
+    VersionedGraph() : compactions_(0), compaction_requested_(false), stopping_(false) {
+        const std::shared_ptr<GraphType> base = std::make_shared<GraphType>();
+        base->Freeze();
+        Start(base);
+    }
+
+    // Start at version 0 with the given edges.
+    VersionedGraph(const std::vector<Edge>& edges) : compactions_(0), compaction_requested_(false), stopping_(false) {
+        const std::shared_ptr<GraphType> base = std::make_shared<GraphType>(edges);
+        base->Freeze();
+        Start(base);
+    }
+
+    ~VersionedGraph() {
+        {
+            std::lock_guard<std::mutex> lock(compactor_mutex_);
+            stopping_ = true;
+        }
+        compactor_wakeup_.notify_one();
+        compactor_.join();
+    }
+
+    VersionedGraph(const VersionedGraph&) = delete;
+    VersionedGraph& operator=(const VersionedGraph&) = delete;
+
+    // Return the latest version, which stays alive and unchanged while the returned pointer or a copy of it is held.
+    // If version is not null the version number is stored in it.
+    std::shared_ptr<const Version> Pin(uint64_t* version = nullptr) const {
+        const std::shared_ptr<const Version> latest = std::atomic_load(&latest_);
+        if (version != nullptr) {
+            *version = latest->number();
+        }
+        return latest;
+    }
+
+    // Number of the latest version.
+    uint64_t version() const { return std::atomic_load(&latest_)->number(); }
+
+    // Count of compactions of the overlay into a new base so far.
+    uint64_t compactions() const { return compactions_.load(); }
+
+    // Buffer a vertex or an edge for the next version. Not visible to readers until Publish().
+    void AddVertex(const Node& n) {
+        std::lock_guard<std::mutex> lock(delta_mutex_);
+        pending_vertices_.push_back(n);
+    }
+
+    void AddEdge(const Edge& edge) {
+        std::lock_guard<std::mutex> lock(delta_mutex_);
+        pending_edges_.push_back(edge);
+    }
+
+    // Count of buffered vertices and edges.
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(delta_mutex_);
+        return pending_vertices_.size() + pending_edges_.size();
+    }
+
+    // Append the buffered delta to the overlay and make the version it completes the latest. Writers may keep
+    // buffering meanwhile; what they buffer goes into the next version. Returns the number of the latest version,
+    // unchanged if nothing was buffered.
+    uint64_t Publish() {
+        std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+        std::vector<Node> vertices;
+        std::vector<Edge> edges;
+        {
+            std::lock_guard<std::mutex> lock(delta_mutex_);
+            vertices.swap(pending_vertices_);
+            edges.swap(pending_edges_);
+        }
+        const std::shared_ptr<const Version> latest = std::atomic_load(&latest_);
+        if (vertices.empty() && edges.empty()) {
+            return latest->number();
+        }
+        std::shared_ptr<const Version> next;
+        if (!overlay_->Fits(vertices.size() + 2 * edges.size(), edges.size())) {
+            const std::shared_ptr<const GraphType> base = Rebuild(*latest, vertices, edges);
+            overlay_ = NewOverlay(*base);
+            next = std::make_shared<const Version>(latest->number() + 1, base, overlay_, 0, 0);
+        } else {
+            for (const Node& vertex : vertices) {
+                if (latest->index_.Find(vertex.Id()) == kNoVertex &&
+                    overlay_->Find(vertex.Id(), overlay_->num_vertices()) == kNoVertex) {
+                    overlay_->AddVertex(vertex.Id());
+                }
+            }
+            for (const Edge& edge : edges) {
+                const uint32_t from = Intern(*latest, edge.from());
+                overlay_->AddEdge(from, Intern(*latest, edge.to()), edge.weight());
+            }
+            next = std::make_shared<const Version>(latest->number() + 1, latest->base_, overlay_,
+                                                   overlay_->num_vertices(), overlay_->num_edges());
+        }
+        std::atomic_store(&latest_, next);
+        if (overlay_->HalfFull()) {
+            RequestCompaction();
+        }
+        return next->number();
+    }
+
+    // Fold the overlay of the latest version into a new base graph, then swap in a version with the same number on
+    // top of it, carrying over what was published while the base was built. Readers see the same graph before and
+    // after. Runs on the background thread when the overlay is half full; callable from any thread.
+    void Compact() {
+        std::lock_guard<std::mutex> compaction_lock(compaction_mutex_);
+        const std::shared_ptr<const Version> compacted = std::atomic_load(&latest_);
+        if (compacted->num_vertices_ == 0 && compacted->num_edges_ == 0) {
+            return;
+        }
+        const std::shared_ptr<const GraphType> base = Rebuild(*compacted, {}, {});
+
+        std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+        const std::shared_ptr<const Version> latest = std::atomic_load(&latest_);
+        if (latest->base_ != compacted->base_) {
+            // Publish() folded a large delta into a new base meanwhile.
+            return;
+        }
+        overlay_ = NewOverlay(*base);
+        const std::shared_ptr<const Version> rebased = std::make_shared<const Version>(latest->number(), base, overlay_, 0, 0);
+        const uint32_t base_vertices = latest->index_.size();
+        for (uint32_t v = compacted->num_vertices_; v < latest->num_vertices_; v++) {
+            overlay_->AddVertex(latest->Id(base_vertices + v));
+        }
+        for (uint32_t e = compacted->num_edges_; e < latest->num_edges_; e++) {
+            const versioned_graph::OverlayEdge& edge = latest->overlay_->edge(e);
+            const uint32_t from = Intern(*rebased, latest->Id(edge.from));
+            overlay_->AddEdge(from, Intern(*rebased, latest->Id(edge.to)), edge.weight);
+        }
+        std::atomic_store(&latest_, std::make_shared<const Version>(latest->number(), base, overlay_,
+                                                                    overlay_->num_vertices(), overlay_->num_edges()));
+        compactions_++;
+    }
+};
+
+#endif /* VERSIONED_GRAPH_H_ */
@@ -0,0 +1,107 @@
+#ifndef VERTEX_INDEX_H_
+#define VERTEX_INDEX_H_
+
+#include "string_ref.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Dense id returned for a string id that is not present in the index.
+const uint32_t kNoVertex = UINT32_MAX;
+
+// FNV-1a hash of the bytes of an id; fixed here rather than left to std::hash so that hash tables written to disk can
+// be probed by any build.
+inline uint64_t HashId(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Interns string vertex ids into dense integer ids 0..size()-1, assigned in insertion order. An index can instead be
+// mapped onto id tables laid out in external memory (see Map()), which is then read in place and cannot grow.
+class VertexIndex {
+  private:
+    std::unordered_map<std::string, uint32_t> index_;
+    std::vector<std::string> ids_;
+
+    // External tables of a mapped index: the characters of id v are chars[offsets[v] .. offsets[v + 1]), and slots is an
+    // open addressing table of capacity entries (a power of two) holding dense ids or kNoVertex, probed linearly from
+    // HashId() of an id.
+    const uint64_t* mapped_offsets_;
+    const char* mapped_chars_;
+    const uint32_t* mapped_slots_;
+    uint32_t mapped_capacity_;
+    uint32_t mapped_size_;
+
+  public:
+    VertexIndex()
+        : mapped_offsets_(nullptr), mapped_chars_(nullptr), mapped_slots_(nullptr), mapped_capacity_(0), mapped_size_(0) {}
+
+    // Return the dense id for the input id, assigning the next free id if the input id is new. Not for mapped indexes.
+    uint32_t Intern(const std::string& id) {
+        auto inserted = index_.insert({id, static_cast<uint32_t>(ids_.size())});
+        if (inserted.second) {
+            ids_.push_back(id);
+        }
+        return inserted.first->second;
+    }
+
+    // Return the dense id for the input id, or kNoVertex if the id was never interned.
+    uint32_t Find(const std::string& id) const {
+        if (mapped()) {
+            for (uint64_t slot = HashId(id.data(), id.size()); ; slot++) {
+                const uint32_t v = mapped_slots_[slot & (mapped_capacity_ - 1)];
+                if (v == kNoVertex || Id(v) == StringRef(id)) {
+                    return v;
+                }
+            }
+        }
+        auto it = index_.find(id);
+        return it == index_.end() ? kNoVertex : it->second;
+    }
+
+    // Return the string id for the input dense id.
+    StringRef Id(uint32_t v) const {
+        if (mapped()) {
+            return StringRef(mapped_chars_ + mapped_offsets_[v], mapped_offsets_[v + 1] - mapped_offsets_[v]);
+        }
+        return StringRef(ids_[v]);
+    }
+
+    // Renumber the interned ids so that dense id i goes to the id that had dense id order[i], given rank, the inverse of
+    // order. Updates the ids in place without hashing any of them. Not for mapped indexes.
+    void Renumber(const std::vector<uint32_t>& order, const std::vector<uint32_t>& rank) {
+        for (auto& entry : index_) {
+            entry.second = rank[entry.second];
+        }
+        std::vector<std::string> ids(ids_.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            ids[i].swap(ids_[order[i]]);
+        }
+        ids_.swap(ids);
+    }
+
+    // Get count of interned ids.
+    uint32_t size() const { return mapped() ? mapped_size_ : static_cast<uint32_t>(ids_.size()); }
+
+    // Whether the index reads external tables set by Map().
+    bool mapped() const { return mapped_slots_ != nullptr; }
+
+    // Read num_ids ids from external tables laid out as described at mapped_offsets_, which must outlive the index.
+    // Drops any interned ids.
+    void Map(uint32_t num_ids, const uint64_t* offsets, const char* chars, const uint32_t* slots, uint32_t capacity) {
+        index_.clear();
+        ids_.clear();
+        mapped_size_ = num_ids;
+        mapped_offsets_ = offsets;
+        mapped_chars_ = chars;
+        mapped_slots_ = slots;
+        mapped_capacity_ = capacity;
+    }
+};
+
+#endif /* VERTEX_INDEX_H_ */
@@ -0,0 +1,292 @@
+#ifndef VERTEX_ORDER_H_
+#define VERTEX_ORDER_H_
+
+#include "compressed_adjacency.h"
+#include "vertex_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Orders for renumbering the dense ids of a graph, so that vertices visited close together in time sit close together
+// in the adjacency and in the per vertex arrays of traversals.
+enum class VertexOrder {
+    kDegree,                // highest degree first, so the hubs most traversals touch share a few cache lines
+    kReverseCuthillMcKee,   // reverse Cuthill-McKee: BFS from a peripheral vertex, lowest degree neighbors first
+    kBreadthFirst,          // the order a BFS from each unvisited vertex in turn first reaches them
+    kGorder                 // greedy Gorder: each next vertex shares the most neighbors with the last few placed
+};
+
+namespace vertex_order {
+
+// Call visit(u) for every neighbor u of v: its entries in out, and in in unless in is null, as for a symmetric
+// adjacency. Orders treat a directed graph as undirected, since locality does not care about edge direction.
+template <typename Visit>
+inline void ForEachNeighbor(const CompressedAdjacency& out, const CompressedAdjacency* in, uint32_t v, Visit visit) {
+    for (const uint32_t* neighbor = out.begin(v); neighbor != out.end(v); neighbor++) {
+        visit(*neighbor);
+    }
+    if (in != nullptr) {
+        for (const uint32_t* neighbor = in->begin(v); neighbor != in->end(v); neighbor++) {
+            visit(*neighbor);
+        }
+    }
+}
+
+inline uint32_t Degree(const CompressedAdjacency& out, const CompressedAdjacency* in, uint32_t v) {
+    return out.Degree(v) + (in != nullptr ? in->Degree(v) : 0);
+}
+
+// Max-priority queue of dense ids whose keys only move by small steps, as in Gorder: one doubly linked list per key,
+// so that changing a key and popping the largest cost O(1) plus the distance the top falls.
+class UnitHeap {
+  private:
+    std::vector<uint32_t> key_;
+    std::vector<uint32_t> prev_;
+    std::vector<uint32_t> next_;
+
+    // First id of each key's list, or kNoVertex.
+    std::vector<uint32_t> head_;
+
+    // No key above top_ has a nonempty list.
+    uint32_t top_;
+
+    void Unlink(uint32_t v) {
+        if (prev_[v] != kNoVertex) next_[prev_[v]] = next_[v];
+        else head_[key_[v]] = next_[v];
+        if (next_[v] != kNoVertex) prev_[next_[v]] = prev_[v];
+    }
+
+    void Link(uint32_t v) {
+        if (head_.size() <= key_[v]) {
+            head_.resize(key_[v] + 1, kNoVertex);
+        }
+        prev_[v] = kNoVertex;
+        next_[v] = head_[key_[v]];
+        if (next_[v] != kNoVertex) prev_[next_[v]] = v;
+        head_[key_[v]] = v;
+        top_ = std::max(top_, key_[v]);
+    }
+
+  public:
+    // Hold ids 0..num_vertices-1, all with key 0, the lowest id first.
+    explicit UnitHeap(uint32_t num_vertices)
+        : key_(num_vertices, 0), prev_(num_vertices), next_(num_vertices), head_(1, num_vertices > 0 ? 0 : kNoVertex), top_(0) {
+        for (uint32_t v = 0; v < num_vertices; v++) {
+            prev_[v] = v > 0 ? v - 1 : kNoVertex;
+            next_[v] = v + 1 < num_vertices ? v + 1 : kNoVertex;
+        }
+    }
+
+    // Raise the key of v, which is in the heap, by one, or lower it by one.
+    void Increment(uint32_t v) {
+        Unlink(v);
+        key_[v]++;
+        Link(v);
+    }
+
+    void Decrement(uint32_t v) {
+        Unlink(v);
+        key_[v]--;
+        Link(v);
+    }
+
+    // Remove v, which is in the heap.
+    void Remove(uint32_t v) { Unlink(v); }
+
+    // Remove and return an id with the largest key; the heap must not be empty.
+    uint32_t PopMax() {
+        while (head_[top_] == kNoVertex) top_--;
+        const uint32_t v = head_[top_];
+        Unlink(v);
+        return v;
+    }
+};
+
+}  // namespace vertex_order
+
+// Fill order with every vertex of the adjacency out (plus in for a directed graph, or null if out is symmetric) from
+// the highest degree to the lowest, ties in id order.
+inline void DegreeOrder(const CompressedAdjacency& out, const CompressedAdjacency* in, std::vector<uint32_t>* order) {
+    order->resize(out.V());
+    for (uint32_t v = 0; v < out.V(); v++) (*order)[v] = v;
+    std::stable_sort(order->begin(), order->end(), [&](uint32_t a, uint32_t b) {
+        return vertex_order::Degree(out, in, a) > vertex_order::Degree(out, in, b);
+    });
+}
+
+// Fill order with every vertex in the order a BFS first reaches it, started from each vertex not reached yet, in id
+// order.
+inline void BreadthFirstOrder(const CompressedAdjacency& out, const CompressedAdjacency* in, std::vector<uint32_t>* order) {
+    const uint32_t num_vertices = out.V();
+    std::vector<bool> reached(num_vertices, false);
+    order->clear();
+    order->reserve(num_vertices);
+    for (uint32_t start = 0; start < num_vertices; start++) {
+        if (reached[start]) {
+            continue;
+        }
+        reached[start] = true;
+        order->push_back(start);
+        // order doubles as the queue of the BFS.
+        for (size_t head = order->size() - 1; head < order->size(); head++) {
+            vertex_order::ForEachNeighbor(out, in, (*order)[head], [&](uint32_t neighbor) {
+                if (!reached[neighbor]) {
+                    reached[neighbor] = true;
+                    order->push_back(neighbor);
+                }
+            });
+        }
+    }
+}
+
+// Fill order with the reverse Cuthill-McKee order: every component is searched breadth first from a pseudo-peripheral
+// vertex (the lowest degree vertex of the last level of a BFS from its lowest degree vertex), the unreached neighbors
+// of each vertex queued from the lowest degree up, and the whole order is reversed. Keeps edges between vertices whose
+// ids are close, which bounds how far apart in memory the neighbors of a vertex are.
+inline void ReverseCuthillMcKeeOrder(const CompressedAdjacency& out, const CompressedAdjacency* in, std::vector<uint32_t>* order) {
+    const uint32_t num_vertices = out.V();
+    std::vector<uint32_t> by_degree;
+    DegreeOrder(out, in, &by_degree);
+    std::reverse(by_degree.begin(), by_degree.end());
+    // Start of the BFS that last reached each vertex while looking for a peripheral vertex, or kNoVertex.
+    std::vector<uint32_t> swept(num_vertices, kNoVertex);
+    std::vector<uint32_t> queue, neighbors;
+    std::vector<bool> placed(num_vertices, false);
+    order->clear();
+    order->reserve(num_vertices);
+    for (const uint32_t lowest : by_degree) {
+        if (placed[lowest]) {
+            continue;
+        }
+        // Sweep the component level by level, keeping the lowest degree vertex of the last level.
+        uint32_t start = lowest;
+        queue.assign(1, lowest);
+        swept[lowest] = lowest;
+        for (size_t level_begin = 0; level_begin < queue.size(); ) {
+            const size_t level_end = queue.size();
+            start = queue[level_begin];
+            for (size_t i = level_begin; i < level_end; i++) {
+                if (vertex_order::Degree(out, in, queue[i]) < vertex_order::Degree(out, in, start)) {
+                    start = queue[i];
+                }
+                vertex_order::ForEachNeighbor(out, in, queue[i], [&](uint32_t neighbor) {
+                    if (swept[neighbor] != lowest) {
+                        swept[neighbor] = lowest;
+                        queue.push_back(neighbor);
+                    }
+                });
+            }
+            level_begin = level_end;
+        }
+
+        placed[start] = true;
+        order->push_back(start);
+        for (size_t head = order->size() - 1; head < order->size(); head++) {
+            neighbors.clear();
+            vertex_order::ForEachNeighbor(out, in, (*order)[head], [&](uint32_t neighbor) {
+                if (!placed[neighbor]) {
+                    placed[neighbor] = true;
+                    neighbors.push_back(neighbor);
+                }
+            });
+            std::stable_sort(neighbors.begin(), neighbors.end(), [&](uint32_t a, uint32_t b) {
+                return vertex_order::Degree(out, in, a) < vertex_order::Degree(out, in, b);
+            });
+            order->insert(order->end(), neighbors.begin(), neighbors.end());
+        }
+    }
+    std::reverse(order->begin(), order->end());
+}
+
+// Fill order with the greedy order of Gorder (Wei et al.): starting from the vertex with the most in-edges, each next
+// vertex is the unplaced one with the highest score against the last window placed vertices, where a pair scores one
+// per edge between them and one per common in-neighbor. Scores are kept in a UnitHeap and updated as vertices enter
+// and leave the window; common in-neighbors with more than about sqrt(V) out-edges are skipped, since a hub relates
+// too many vertices to say anything about any pair of them. Costs O(sum of the squared degrees of the non-hubs).
+inline void GorderOrder(const CompressedAdjacency& out, const CompressedAdjacency* in, int window, std::vector<uint32_t>* order) {
+    const uint32_t num_vertices = out.V();
+    order->clear();
+    if (num_vertices == 0) {
+        return;
+    }
+    order->reserve(num_vertices);
+    const CompressedAdjacency& reverse = in != nullptr ? *in : out;
+    const uint32_t hub_degree = std::max<uint32_t>(16, static_cast<uint32_t>(std::sqrt(static_cast<double>(num_vertices))));
+    vertex_order::UnitHeap heap(num_vertices);
+    std::vector<bool> placed(num_vertices, false);
+
+    // Add one, or take one away, from the score of every unplaced vertex related to v.
+    const auto update = [&](uint32_t v, bool enter) {
+        const auto bump = [&](uint32_t u) {
+            if (placed[u]) return;
+            if (enter) heap.Increment(u);
+            else heap.Decrement(u);
+        };
+        for (const uint32_t* neighbor = out.begin(v); neighbor != out.end(v); neighbor++) {
+            bump(*neighbor);
+        }
+        for (const uint32_t* parent = reverse.begin(v); parent != reverse.end(v); parent++) {
+            if (in != nullptr) {
+                bump(*parent);
+            }
+            if (out.Degree(*parent) > hub_degree) {
+                continue;
+            }
+            for (const uint32_t* sibling = out.begin(*parent); sibling != out.end(*parent); sibling++) {
+                if (*sibling != v) {
+                    bump(*sibling);
+                }
+            }
+        }
+    };
+
+    uint32_t start = 0;
+    for (uint32_t v = 1; v < num_vertices; v++) {
+        if (reverse.Degree(v) > reverse.Degree(start)) start = v;
+    }
+    heap.Remove(start);
+    placed[start] = true;
+    order->push_back(start);
+    update(start, true);
+    const size_t window_size = static_cast<size_t>(std::max(1, window));
+    while (order->size() < num_vertices) {
+        if (order->size() > window_size) {
+            update((*order)[order->size() - 1 - window_size], false);
+        }
+        const uint32_t next = heap.PopMax();
+        placed[next] = true;
+        order->push_back(next);
+        update(next, true);
+    }
+}
+
+// Fill order with the vertices of the adjacency in the given order; see VertexOrder.
+inline void OrderVertices(VertexOrder order_kind, const CompressedAdjacency& out, const CompressedAdjacency* in,
+                          std::vector<uint32_t>* order) {
+    // Placed vertices whose neighbors still raise the scores of Gorder, the window size suggested by its authors.
+    const int kGorderWindow = 5;
+    switch (order_kind) {
+        case VertexOrder::kDegree: DegreeOrder(out, in, order); break;
+        case VertexOrder::kReverseCuthillMcKee: ReverseCuthillMcKeeOrder(out, in, order); break;
+        case VertexOrder::kBreadthFirst: BreadthFirstOrder(out, in, order); break;
+        case VertexOrder::kGorder: GorderOrder(out, in, kGorderWindow, order); break;
+    }
+}
+
+// Renumber the vertices of index, and the endpoints of edges, so that dense id i goes to the vertex order[i]: the
+// string ids stay the same, only the dense id behind each changes. order must hold every dense id of index once.
+inline void RenumberVertices(const std::vector<uint32_t>& order, VertexIndex* index, std::vector<std::pair<uint32_t, uint32_t>>* edges) {
+    std::vector<uint32_t> rank(order.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        rank[order[i]] = i;
+    }
+    index->Renumber(order, rank);
+    for (auto& edge : *edges) {
+        edge = {rank[edge.first], rank[edge.second]};
+    }
+}
+
+#endif /* VERTEX_ORDER_H_ */